@@ -0,0 +1,859 @@
+/*
+ * bench_main.c (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Mide los caminos criticos del OS y emite los resultados por semihosting, una
+ *  linea por medicion con el formato:
+ *
+ *    bench,<nombre>,<parametro>,<muestras>,<min>,<promedio>,<max>
+ *
+ *  Los tiempos estan expresados en ciclos del reloj del sistema (25 MHz en el
+ *  mps2-an386, comun a CPU, SysTick y timers). Las mediciones son:
+ *
+ *  - yield:           os_CpuYield entre dos tareas de igual prioridad (scheduler + PendSV)
+ *  - delay1_latencia: desde la interrupcion de SysTick hasta que corre la tarea que
+ *                     hizo os_Delay(1)
+ *  - sem_pingpong:    ida y vuelta entre dos tareas con os_SemaforoGive/Take (2 cambios)
+ *  - cola_elemento:   costo por elemento de os_ColaWrite + os_ColaRead, parametro =
+ *                     tamaño del elemento en bytes
+ *  - irq_a_tarea:     desde que se pone pendiente una IRQ hasta que corre la tarea
+ *                     liberada por su handler a traves de os_IRQHandler
+ *  - os_init:         duracion de os_Init, parametro = cantidad de tareas definidas
+ *  - tick_demoradas:  duracion del SysTick hasta tickHook, parametro = cantidad de tareas
+ *                     de carga que siguen demoradas en ese tick
+ *  - rwlock_lectura:  os_RWLockLeer + os_RWLockLiberarLectura sin contencion
+ *  - lectura_semaforo, lectura_rwlock: ciclos por lectura de una tabla compartida por dos
+ *                     tareas lectoras de igual prioridad, protegida con un semaforo binario
+ *                     o con un osRWLock, parametro = cantidad de lectoras. Cada lectora
+ *                     cede el CPU en medio de la lectura, como si se le terminara el
+ *                     quantum: con el semaforo la otra se bloquea, con el lock entra
+ *  - rafaga_cola, rafaga_notificacion: ciclos por evento de N_RAFAGAS rafagas de
+ *                     TAM_RAFAGA interrupciones seguidas, parametro = TAM_RAFAGA. Cada
+ *                     handler escribe un dato en una cola; la tarea que los procesa espera
+ *                     en la cola (un despertar y dos cambios de contexto por evento) o en
+ *                     un osNotificacion con umbral TAM_RAFAGA (uno por rafaga)
+ *
+ *  Compilando con -DOS_LATENCIA_IRQ=1 se agrega la prueba de latencia de interrupciones:
+ *  TIMER1 interrumpe cada PERIODO_LATENCIA ciclos mientras las tareas ayudantes cargan el
+ *  OS con semaforos y colas, y os_IRQHandler mide cada atencion contra la cuenta del
+ *  timer desde que vencio:
+ *
+ *  - irq_latencia:      desde que vence TIMER1 hasta que corre su funcion de usuario
+ *  - irq_latencia_hist: histograma de la anterior, parametro = posicion, muestras =
+ *                       atenciones, min y max = limites de la posicion en ciclos
+ *  - irq_duracion:      duracion maxima de la funcion de usuario (solo max)
+ *  - seccion_critica:   seccion critica mas larga del OS durante la prueba (solo max)
+ *
+ *  Compilando con -DBENCH_FORMATO=1 y un STACK_SIZE que alcance (por ejemplo
+ *  -DSTACK_SIZE=1024) se agrega la medicion del stack que usan las tareas que formatean
+ *  texto. Cada una corre en una tarea propia que solo hace ese trabajo, y se reporta
+ *  STACK_SIZE - os_getStackLibre, parametro = STACK_SIZE:
+ *
+ *  - pila_shell:        una respuesta del shell de diagnostico (el vsnprintf de responder
+ *                       en MSE_OS_Shell.c con la linea del comando tareas)
+ *  - pila_log:          os_LogVaciar de MSE_OS_Log.c formateando registros, como en
+ *                       os_LogTarea (requiere compilar tambien src/MSE_OS_Log.c)
+ *
+ *  Todas las tareas se registran antes de os_Init y esperan en un semaforo propio.
+ *  La tarea de control (minima prioridad) las libera de a una por medicion.
+ *
+ *  El resto de las tareas hasta MAX_TASK_COUNT son tareas de carga repartidas entre las
+ *  prioridades intermedias. Cada una hace un unico os_Delay de distinta duracion y luego
+ *  queda bloqueada para siempre, lo que permite medir como escalan el tick y el scheduler
+ *  compilando con distintos MAX_TASK_COUNT y MIN_PRIORITY. escalado.sh recorre varias
+ *  combinaciones y junta los resultados.
+ */
+
+#include "board.h"
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_IRQ.h"
+#include "semihosting.h"
+
+#ifndef BENCH_FORMATO
+#define BENCH_FORMATO		0		//1: mide el stack de las tareas que formatean texto
+#endif
+
+#if BENCH_FORMATO
+#include <stdio.h>
+#include <stdarg.h>
+#include "MSE_OS_Log.h"
+#endif
+
+
+/*==================[macros and definitions]=================================*/
+
+#define MILISEC				1000
+#define N_MUESTRAS			1000
+#define N_ELEMENTOS_COLA	2000
+#define MAX_SIZE_ELEMENTO	16
+#define N_LECTURAS			1000		//lecturas de cada tarea lectora
+#define TAM_TABLA			32			//palabras de la tabla compartida
+#define CANT_LECTORAS		2
+#define TAM_RAFAGA			32			//interrupciones por rafaga, entran en la cola de 1 byte
+#define N_RAFAGAS			100
+
+#define PRIORIDAD_0		0
+#define PRIORIDAD_1		1
+#define PRIORIDAD_CARGA	2
+#define PRIORIDAD_CONTROL	MIN_PRIORITY
+
+#if MIN_PRIORITY < 3
+#error "El benchmark necesita al menos cuatro prioridades"
+#endif
+
+#if BENCH_FORMATO
+#define BENCH_TAREAS_FORMATO	2
+#define TAM_LINEA_SHELL			80		//OS_SHELL_TAM_SALIDA
+
+#if STACK_SIZE < 1024
+#error "BENCH_FORMATO necesita STACK_SIZE de al menos 1024 bytes"
+#endif
+#else
+#define BENCH_TAREAS_FORMATO	0
+#endif
+
+#define BENCH_CANT_CARGA	(MAX_TASK_COUNT - 6 - BENCH_TAREAS_FORMATO)	//tareas de carga para llegar a MAX_TASK_COUNT
+#define PASO_CARGA			2						//ticks entre vencimientos de tareas de carga
+
+#define IRQ_BENCH		TIMER0_IRQn		//solo se dispara por software
+#define IRQ_RAFAGA		TIMER2_IRQn		//solo se dispara por software
+
+#if OS_LATENCIA_IRQ
+#define IRQ_LATENCIA		USB1_IRQn		//TIMER1 en el mps2-an386 (IRQ 9)
+#define PERIODO_LATENCIA	2503			//ciclos, no multiplo del SysTick
+#define N_MUESTRAS_LATENCIA	4000
+#endif
+
+
+/*==================[definicion de datos]=================================*/
+
+struct _medicion  {
+	uint32_t muestras;
+	uint32_t minimo;
+	uint32_t maximo;
+	uint64_t suma;
+};
+
+typedef struct _medicion medicion;
+
+
+tarea g_sPingPong, g_sIrq, g_sDelay;		//prioridad 0
+tarea g_sAyudante1, g_sAyudante2;			//prioridad 1
+tarea g_sControl;							//prioridad MIN_PRIORITY
+tarea g_sCarga[BENCH_CANT_CARGA];			//prioridades 2 a MIN_PRIORITY-1
+#if BENCH_FORMATO
+tarea g_sFormatoShell, g_sFormatoLog;		//prioridad 1
+#endif
+
+osSemaforo semPingPong, semIrq, semDelay, semAyudante1, semAyudante2;
+osSemaforo semRespuesta, semFin, semCarga, semNunca;
+osCola colaBench;
+osSemaforo semTabla;
+osRWLock lockTabla;
+osNotificacion notifRafaga;
+#if BENCH_FORMATO
+osSemaforo semFormatoShell, semFormatoLog;
+#endif
+
+static medicion resultado;
+static void (* volatile trabajoAyudante1)(void);
+static void (* volatile trabajoAyudante2)(void);
+static volatile uint32_t marcaTiempo;
+static volatile uint32_t finCola;
+static uint8_t elementoEscritura[MAX_SIZE_ELEMENTO];
+static uint8_t elementoLectura[MAX_SIZE_ELEMENTO];
+static volatile uint32_t tabla[TAM_TABLA];
+static volatile uint32_t lectorasTerminadas;
+static volatile uint32_t finLecturas;
+static volatile bool rafagaNotifica;
+static volatile uint32_t finRafagas;
+
+static medicion medicionTick[BENCH_CANT_CARGA + 1];
+static volatile bool midiendoTick;
+static volatile uint32_t cargaDemoradas = BENCH_CANT_CARGA;
+static uint32_t ciclosInit;
+
+#if OS_LATENCIA_IRQ
+static volatile bool cargaLatencia;
+static volatile uint32_t atencionesLatencia;
+#endif
+
+
+/*==================[funciones de medicion]=================================*/
+
+static inline uint32_t ciclos(void)  {
+	return ~CMSDK_TIMER0->VALUE;
+}
+
+
+static void medicionReset(medicion* m)  {
+	m->muestras = 0;
+	m->minimo = UINT32_MAX;
+	m->maximo = 0;
+	m->suma = 0;
+}
+
+
+/*
+ * Dos tareas de igual prioridad pueden registrar sobre la misma medicion, por lo que la
+ * actualizacion se protege del round-robin del SysTick
+ */
+static void medicionRegistrar(medicion* m, uint32_t valor)  {
+	os_enter_critical();
+	m->muestras++;
+	m->suma += valor;
+	if (valor < m->minimo)
+		m->minimo = valor;
+	if (valor > m->maximo)
+		m->maximo = valor;
+	os_exit_critical();
+}
+
+
+static void medicionReportar(const char* nombre, uint32_t parametro, medicion* m)  {
+	sh_Escribir("bench,");
+	sh_Escribir(nombre);
+	sh_Escribir(",");
+	sh_EscribirUint(parametro);
+	sh_Escribir(",");
+	sh_EscribirUint(m->muestras);
+	sh_Escribir(",");
+	sh_EscribirUint(m->minimo);
+	sh_Escribir(",");
+	sh_EscribirUint(m->muestras ? (uint32_t) (m->suma / m->muestras) : 0);
+	sh_Escribir(",");
+	sh_EscribirUint(m->maximo);
+	sh_Escribir("\n");
+}
+
+
+/*==================[trabajos de las tareas ayudantes]=================================*/
+
+/*
+ * Ambas tareas de prioridad 1 ejecutan este trabajo a la vez. Cada una mide el tiempo
+ * desde que la otra cedio el CPU hasta que la propia retoma la ejecucion
+ */
+static void trabajoYield(void)  {
+	for (uint32_t i = 0; i < N_MUESTRAS; i++)  {
+		if (i > 0)
+			medicionRegistrar(&resultado, ciclos() - marcaTiempo);
+
+		marcaTiempo = ciclos();
+		os_CpuYield();
+	}
+}
+
+
+static void trabajoYieldFin(void)  {
+	trabajoYield();
+	os_SemaforoGive(&semFin);
+}
+
+
+static void trabajoPingPong(void)  {
+	uint32_t inicio;
+
+	for (uint32_t i = 0; i < N_MUESTRAS; i++)  {
+		inicio = ciclos();
+		os_SemaforoGive(&semPingPong);
+		os_SemaforoTake(&semRespuesta);
+		medicionRegistrar(&resultado, ciclos() - inicio);
+	}
+
+	os_SemaforoGive(&semFin);
+}
+
+
+static void trabajoProductor(void)  {
+	for (uint32_t i = 0; i < N_ELEMENTOS_COLA; i++)
+		os_ColaWrite(&colaBench, elementoEscritura);
+}
+
+
+static void trabajoConsumidor(void)  {
+	for (uint32_t i = 0; i < N_ELEMENTOS_COLA; i++)
+		os_ColaRead(&colaBench, elementoLectura);
+
+	finCola = ciclos();
+	os_SemaforoGive(&semFin);
+}
+
+
+/*
+ * Lectura de la tabla compartida. La tarea cede el CPU a la mitad, por lo que la otra
+ * lectora intenta leer mientras esta tiene la tabla
+ */
+static uint32_t leerTabla(void)  {
+	uint32_t suma = 0;
+
+	for (uint32_t i = 0; i < TAM_TABLA / 2; i++)
+		suma += tabla[i];
+
+	os_CpuYield();
+
+	for (uint32_t i = TAM_TABLA / 2; i < TAM_TABLA; i++)
+		suma += tabla[i];
+
+	return suma;
+}
+
+
+/*
+ * La ultima lectora en terminar marca el fin de la medicion
+ */
+static void terminarLectura(void)  {
+	bool ultima;
+
+	os_enter_critical();
+	ultima = (++lectorasTerminadas == CANT_LECTORAS);
+	os_exit_critical();
+
+	if (ultima)  {
+		finLecturas = ciclos();
+		os_SemaforoGive(&semFin);
+	}
+}
+
+
+static void trabajoLecturaSemaforo(void)  {
+	for (uint32_t i = 0; i < N_LECTURAS; i++)  {
+		os_SemaforoTake(&semTabla);
+		leerTabla();
+		os_SemaforoGive(&semTabla);
+	}
+
+	terminarLectura();
+}
+
+
+/*
+ * Los semaforos se inicializan tomados y un give solo los libera si hay una tarea
+ * esperando, por lo que la segunda lectora (que corre despues de que la primera se
+ * bloqueo) entrega el semaforo inicial
+ */
+static void trabajoLecturaSemaforoInicio(void)  {
+	os_SemaforoGive(&semTabla);
+	trabajoLecturaSemaforo();
+}
+
+
+static void trabajoLecturaRWLock(void)  {
+	for (uint32_t i = 0; i < N_LECTURAS; i++)  {
+		os_RWLockLeer(&lockTabla);
+		leerTabla();
+		os_RWLockLiberarLectura(&lockTabla);
+	}
+
+	terminarLectura();
+}
+
+
+/*
+ * Las dos formas de procesar las rafagas leen todos los datos de la cola; la ultima
+ * lectura marca el fin de la medicion
+ */
+static void trabajoRafagaCola(void)  {
+	for (uint32_t i = 0; i < N_RAFAGAS * TAM_RAFAGA; i++)
+		os_ColaRead(&colaBench, elementoLectura);
+
+	finRafagas = ciclos();
+	os_SemaforoGive(&semFin);
+}
+
+
+static void trabajoRafagaNotificacion(void)  {
+	uint32_t procesados = 0;
+	uint32_t eventos;
+
+	while (procesados < N_RAFAGAS * TAM_RAFAGA)  {
+		eventos = os_NotificacionEsperar(&notifRafaga);
+
+		for (uint32_t i = 0; i < eventos; i++)
+			os_ColaRead(&colaBench, elementoLectura);
+
+		procesados += eventos;
+	}
+
+	finRafagas = ciclos();
+	os_SemaforoGive(&semFin);
+}
+
+
+#if OS_LATENCIA_IRQ
+/*
+ * Carga durante la medicion de latencia: una ayudante hace ping-pong con semaforos y la
+ * otra pasa elementos por una cola, con lo que el OS entra continuamente en secciones
+ * criticas y cambios de contexto
+ */
+static void trabajoCargaSemaforos(void)  {
+	while (cargaLatencia)  {
+		os_SemaforoGive(&semPingPong);
+		os_SemaforoTake(&semRespuesta);
+	}
+}
+
+
+static void trabajoCargaCola(void)  {
+	while (cargaLatencia)  {
+		os_ColaWrite(&colaBench, elementoEscritura);
+		os_ColaRead(&colaBench, elementoLectura);
+	}
+}
+
+
+/*
+ * TIMER1 cuenta hacia abajo desde RELOAD e interrumpe al llegar a 0, por lo que
+ * RELOAD - VALUE son los ciclos transcurridos desde el evento
+ */
+static uint32_t referenciaTimer1(void)  {
+	return CMSDK_TIMER1->RELOAD - CMSDK_TIMER1->VALUE;
+}
+#endif
+
+
+#if BENCH_FORMATO
+/*
+ * Igual que responder en MSE_OS_Shell.c: la linea se arma en un buffer estatico, por lo que
+ * el stack medido es el de vsnprintf
+ */
+static void responderShell(const char* formato, ...)  {
+	static char texto[TAM_LINEA_SHELL];
+	va_list argumentos;
+
+	va_start(argumentos, formato);
+	vsnprintf(texto, sizeof(texto) - 2, formato, argumentos);
+	va_end(argumentos);
+}
+
+
+/*
+ * Salida del log que descarta las lineas, solo interesa el stack del formato
+ */
+static void salidaLogNula(const void* datos, uint16_t cantidad)  {
+	(void) datos;
+	(void) cantidad;
+}
+#endif
+
+
+/*==================[Definicion de tareas para el OS]==========================*/
+
+/*
+ * El orden de inicializacion fija el id de cada tarea de carga, que se usa para escalonar
+ * sus demoras. La ultima en vencer libera a la tarea de control
+ */
+void carga(void)  {
+	uint32_t quedan;
+
+	os_Delay(1 + os_getTareaActual()->id * PASO_CARGA);
+
+	os_enter_critical();
+	quedan = --cargaDemoradas;
+	os_exit_critical();
+
+	if (quedan == 0)
+		os_SemaforoGive(&semCarga);
+
+	while(1)
+		os_SemaforoTake(&semNunca);
+}
+
+
+
+void ayudante1(void)  {
+	while(1)  {
+		os_SemaforoTake(&semAyudante1);
+		trabajoAyudante1();
+	}
+}
+
+
+void ayudante2(void)  {
+	while(1)  {
+		os_SemaforoTake(&semAyudante2);
+		trabajoAyudante2();
+	}
+}
+
+
+void pingPong(void)  {
+	while(1)  {
+		os_SemaforoTake(&semPingPong);
+		os_SemaforoGive(&semRespuesta);
+	}
+}
+
+
+void irq(void)  {
+	while(1)  {
+		os_SemaforoTake(&semIrq);
+		medicionRegistrar(&resultado, ciclos() - marcaTiempo);
+	}
+}
+
+
+void delay(void)  {
+	while(1)  {
+		os_SemaforoTake(&semDelay);
+
+		for (uint32_t i = 0; i < N_MUESTRAS; i++)  {
+			os_Delay(1);
+			medicionRegistrar(&resultado, SysTick->LOAD - SysTick->VAL);
+		}
+
+		os_SemaforoGive(&semFin);
+	}
+}
+
+
+#if BENCH_FORMATO
+/*
+ * Linea del comando tareas del shell, con los campos de mostrarTarea
+ */
+void formatoShell(void)  {
+	os_SemaforoTake(&semFormatoShell);
+
+	responderShell("%-12s %-10s %4u %3lu.%lu %6lu %8lu", "formatoShell", "corriendo",
+			(unsigned) PRIORIDAD_1, 12UL, 3UL, (unsigned long) STACK_SIZE, 4294967295UL);
+
+	os_SemaforoGive(&semFin);
+
+	while(1)
+		os_SemaforoTake(&semNunca);
+}
+
+
+/*
+ * Mensajes con todos sus argumentos y uno con un id desconocido, que se imprime en
+ * hexadecimal con un snprintf por argumento
+ */
+void formatoLog(void)  {
+	os_SemaforoTake(&semFormatoLog);
+
+	os_LogInit(salidaLogNula);
+	os_Log2(LOG_STACK_LIBRE, os_getTareaActual()->id, STACK_SIZE);
+	os_Log2(LOG_ERROR_OS, 0xFFFFFFFF, 0xFFFFFFFF);
+	os_Log4(OS_LOG_CANT_MENSAJES, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF);
+	os_LogVaciar();
+
+	os_SemaforoGive(&semFin);
+
+	while(1)
+		os_SemaforoTake(&semNunca);
+}
+
+
+/*
+ * La tarea medida tiene mas prioridad que esta, por lo que termina su trabajo antes de
+ * volver del give
+ */
+static void medirPila(const char* nombre, osSemaforo* sem, tarea* task)  {
+	os_SemaforoGive(sem);
+	os_SemaforoTake(&semFin);
+
+	medicionReset(&resultado);
+	medicionRegistrar(&resultado, STACK_SIZE - os_getStackLibre(task));
+	medicionReportar(nombre, STACK_SIZE, &resultado);
+}
+#endif
+
+
+static void medirLecturas(const char* nombre, void (*trabajo1)(void), void (*trabajo2)(void))  {
+	uint32_t inicio;
+
+	medicionReset(&resultado);
+	lectorasTerminadas = 0;
+	trabajoAyudante1 = trabajo1;
+	trabajoAyudante2 = trabajo2;
+
+	inicio = ciclos();
+	os_SemaforoGive(&semAyudante1);
+	os_SemaforoGive(&semAyudante2);
+	os_SemaforoTake(&semFin);
+
+	resultado.muestras = CANT_LECTORAS * N_LECTURAS;
+	resultado.suma = finLecturas - inicio;
+	resultado.minimo = resultado.maximo = (finLecturas - inicio) / resultado.muestras;
+	medicionReportar(nombre, CANT_LECTORAS, &resultado);
+}
+
+
+/*
+ * La tarea ayudante1 tiene mas prioridad que esta, por lo que cada handler que la
+ * despierta la ejecuta antes de volver a esta tarea
+ */
+static void medirRafagas(const char* nombre, void (*trabajo)(void), bool notifica)  {
+	uint32_t inicio;
+
+	medicionReset(&resultado);
+	os_ColaInit(&colaBench, 1);
+	os_NotificacionInit(&notifRafaga, TAM_RAFAGA, 1);
+	rafagaNotifica = notifica;
+	trabajoAyudante1 = trabajo;
+	os_SemaforoGive(&semAyudante1);
+	os_Delay(1);
+
+	inicio = ciclos();
+	for (uint32_t r = 0; r < N_RAFAGAS; r++)  {
+		for (uint32_t i = 0; i < TAM_RAFAGA; i++)
+			NVIC_SetPendingIRQ(IRQ_RAFAGA);
+	}
+	os_SemaforoTake(&semFin);
+
+	resultado.muestras = N_RAFAGAS * TAM_RAFAGA;
+	resultado.suma = finRafagas - inicio;
+	resultado.minimo = resultado.maximo = (finRafagas - inicio) / resultado.muestras;
+	medicionReportar(nombre, TAM_RAFAGA, &resultado);
+}
+
+
+#if OS_LATENCIA_IRQ
+static void medirLatencia(void)  {
+	estadisticasIRQ est;
+
+	os_ColaInit(&colaBench, sizeof(uint32_t));
+	os_SetReferenciaIRQ(IRQ_LATENCIA, referenciaTimer1);
+	os_ReiniciarSeccionCriticaMax();
+
+	/*
+	 * Las ayudantes tienen mas prioridad que esta tarea y la de la cola nunca se bloquea,
+	 * por lo que el timer se arranca antes de liberarlas y es el handler el que termina la
+	 * carga al completar las muestras
+	 */
+	cargaLatencia = true;
+	CMSDK_TIMER1->RELOAD = PERIODO_LATENCIA;
+	CMSDK_TIMER1->VALUE = PERIODO_LATENCIA;
+	CMSDK_TIMER1->CTRL = CMSDK_TIMER_EN | CMSDK_TIMER_IRQ_EN;
+
+	trabajoAyudante1 = trabajoCargaSemaforos;
+	trabajoAyudante2 = trabajoCargaCola;
+	os_SemaforoGive(&semAyudante1);
+	os_SemaforoGive(&semAyudante2);
+	os_SemaforoTake(&semFin);
+
+	os_getEstadisticasIRQ(IRQ_LATENCIA, &est);
+
+	resultado.muestras = est.atenciones;
+	resultado.minimo = est.latencia_min;
+	resultado.maximo = est.latencia_max;
+	resultado.suma = est.latencia_suma;
+	medicionReportar("irq_latencia", 0, &resultado);
+
+	for (uint32_t i = 0; i < OS_CANT_HIST_LATENCIA; i++)  {
+		if (est.histograma[i] == 0)
+			continue;
+
+		resultado.muestras = est.histograma[i];
+		resultado.minimo = (i == 0) ? 0 : 1UL << (i - 1);
+		resultado.maximo = (i == OS_CANT_HIST_LATENCIA - 1) ? UINT32_MAX : (1UL << i) - 1;
+		resultado.suma = 0;
+		medicionReportar("irq_latencia_hist", i, &resultado);
+	}
+
+	medicionReset(&resultado);
+	medicionRegistrar(&resultado, est.duracion_max);
+	medicionReportar("irq_duracion", 0, &resultado);
+
+	medicionReset(&resultado);
+	medicionRegistrar(&resultado, os_getSeccionCriticaMax());
+	medicionReportar("seccion_critica", 0, &resultado);
+}
+#endif
+
+
+void control(void)  {
+	uint32_t inicio;
+
+	sh_Escribir("#bench,nombre,parametro,muestras,min,promedio,max\n");
+
+	/*
+	 * La medicion del tick se hace primero, mientras las tareas de carga siguen demoradas.
+	 * Si MAX_TASK_COUNT no deja lugar para tareas de carga no hay nada que esperar
+	 */
+	if (BENCH_CANT_CARGA > 0)  {
+		for (uint32_t i = 0; i <= BENCH_CANT_CARGA; i++)
+			medicionReset(&medicionTick[i]);
+
+		midiendoTick = true;
+		os_SemaforoTake(&semCarga);
+		midiendoTick = false;
+
+		for (uint32_t i = 0; i <= BENCH_CANT_CARGA; i++)  {
+			if (medicionTick[i].muestras > 0)
+				medicionReportar("tick_demoradas", i, &medicionTick[i]);
+		}
+	}
+
+	medicionReset(&resultado);
+	medicionRegistrar(&resultado, ciclosInit);
+	medicionReportar("os_init", MAX_TASK_COUNT, &resultado);
+
+	medicionReset(&resultado);
+	trabajoAyudante1 = trabajoYield;
+	trabajoAyudante2 = trabajoYieldFin;
+	os_SemaforoGive(&semAyudante1);
+	os_SemaforoGive(&semAyudante2);
+	os_SemaforoTake(&semFin);
+	medicionReportar("yield", 0, &resultado);
+
+	medicionReset(&resultado);
+	os_SemaforoGive(&semDelay);
+	os_SemaforoTake(&semFin);
+	medicionReportar("delay1_latencia", 1, &resultado);
+
+	medicionReset(&resultado);
+	trabajoAyudante1 = trabajoPingPong;
+	os_SemaforoGive(&semAyudante1);
+	os_SemaforoTake(&semFin);
+	medicionReportar("sem_pingpong", 0, &resultado);
+
+	for (uint32_t size = 1; size <= MAX_SIZE_ELEMENTO; size *= 2)  {
+		medicionReset(&resultado);
+		os_ColaInit(&colaBench, size);
+		trabajoAyudante1 = trabajoProductor;
+		trabajoAyudante2 = trabajoConsumidor;
+
+		inicio = ciclos();
+		os_SemaforoGive(&semAyudante1);
+		os_SemaforoGive(&semAyudante2);
+		os_SemaforoTake(&semFin);
+
+		resultado.muestras = N_ELEMENTOS_COLA;
+		resultado.suma = finCola - inicio;
+		resultado.minimo = resultado.maximo = (finCola - inicio) / N_ELEMENTOS_COLA;
+		medicionReportar("cola_elemento", size, &resultado);
+	}
+
+	/*
+	 * La tarea irq tiene mas prioridad que esta, por lo que al volver de NVIC_SetPendingIRQ
+	 * la interrupcion ya fue atendida y la tarea liberada ya registro su muestra
+	 */
+	medicionReset(&resultado);
+	for (uint32_t i = 0; i < N_MUESTRAS; i++)  {
+		marcaTiempo = ciclos();
+		NVIC_SetPendingIRQ(IRQ_BENCH);
+	}
+	medicionReportar("irq_a_tarea", 0, &resultado);
+
+	medicionReset(&resultado);
+	for (uint32_t i = 0; i < N_MUESTRAS; i++)  {
+		inicio = ciclos();
+		os_RWLockLeer(&lockTabla);
+		os_RWLockLiberarLectura(&lockTabla);
+		medicionRegistrar(&resultado, ciclos() - inicio);
+	}
+	medicionReportar("rwlock_lectura", 0, &resultado);
+
+	medirLecturas("lectura_semaforo", trabajoLecturaSemaforo, trabajoLecturaSemaforoInicio);
+	medirLecturas("lectura_rwlock", trabajoLecturaRWLock, trabajoLecturaRWLock);
+
+	medirRafagas("rafaga_cola", trabajoRafagaCola, false);
+	medirRafagas("rafaga_notificacion", trabajoRafagaNotificacion, true);
+
+#if BENCH_FORMATO
+	medirPila("pila_shell", &semFormatoShell, &g_sFormatoShell);
+	medirPila("pila_log", &semFormatoLog, &g_sFormatoLog);
+#endif
+
+#if OS_LATENCIA_IRQ
+	medirLatencia();
+#endif
+
+	sh_Escribir("#fin\n");
+	sh_Salir();
+
+	while(1);
+}
+
+
+void irqBench_ISR(void)  {
+	os_SemaforoGive(&semIrq);
+}
+
+
+void rafaga_ISR(void)  {
+	os_ColaWrite(&colaBench, elementoEscritura);
+
+	if (rafagaNotifica)
+		os_NotificacionDar(&notifRafaga);
+}
+
+
+#if OS_LATENCIA_IRQ
+void latencia_ISR(void)  {
+	CMSDK_TIMER1->INTSTATUS = 1;
+
+	if (++atencionesLatencia == N_MUESTRAS_LATENCIA)  {
+		CMSDK_TIMER1->CTRL = 0;
+		cargaLatencia = false;
+		os_SemaforoGive(&semFin);
+	}
+}
+#endif
+
+
+/*
+ * Se ejecuta al final de cada SysTick, luego de actualizar las demoras y decidir si hace
+ * falta un scheduling. SysTick cuenta hacia abajo desde LOAD, por lo que LOAD - VAL son
+ * los ciclos transcurridos desde la interrupcion
+ */
+void tickHook(void)  {
+	uint32_t duracion = SysTick->LOAD - SysTick->VAL;
+
+	if (midiendoTick)
+		medicionRegistrar(&medicionTick[cargaDemoradas], duracion);
+}
+
+
+/*============================================================================*/
+
+int main(void)  {
+	uint32_t inicio;
+
+	Board_Init();
+	SystemCoreClockUpdate();
+	SysTick_Config(SystemCoreClock / MILISEC);		//systick 1ms
+
+	os_InitTarea(pingPong, &g_sPingPong, PRIORIDAD_0);
+	os_InitTarea(irq, &g_sIrq, PRIORIDAD_0);
+	os_InitTarea(delay, &g_sDelay, PRIORIDAD_0);
+	os_InitTarea(ayudante1, &g_sAyudante1, PRIORIDAD_1);
+	os_InitTarea(ayudante2, &g_sAyudante2, PRIORIDAD_1);
+	os_InitTarea(control, &g_sControl, PRIORIDAD_CONTROL);
+#if BENCH_FORMATO
+	os_InitTarea(formatoShell, &g_sFormatoShell, PRIORIDAD_1);
+	os_InitTarea(formatoLog, &g_sFormatoLog, PRIORIDAD_1);
+#endif
+
+	for (uint32_t i = 0; i < BENCH_CANT_CARGA; i++)
+		os_InitTarea(carga, &g_sCarga[i], PRIORIDAD_CARGA + i % (PRIORIDAD_CONTROL - PRIORIDAD_CARGA));
+
+	os_SemaforoInit(&semPingPong);
+	os_SemaforoInit(&semIrq);
+	os_SemaforoInit(&semDelay);
+	os_SemaforoInit(&semAyudante1);
+	os_SemaforoInit(&semAyudante2);
+	os_SemaforoInit(&semRespuesta);
+	os_SemaforoInit(&semFin);
+	os_SemaforoInit(&semCarga);
+	os_SemaforoInit(&semNunca);
+	os_SemaforoInit(&semTabla);
+	os_RWLockInit(&lockTabla);
+#if BENCH_FORMATO
+	os_SemaforoInit(&semFormatoShell);
+	os_SemaforoInit(&semFormatoLog);
+#endif
+
+	os_InstalarIRQ(IRQ_BENCH, irqBench_ISR);
+	os_InstalarIRQ(IRQ_RAFAGA, rafaga_ISR);
+#if OS_LATENCIA_IRQ
+	os_InstalarIRQ(IRQ_LATENCIA, latencia_ISR);
+#endif
+
+	inicio = ciclos();
+	os_Init();
+	ciclosInit = ciclos() - inicio;
+
+	while (1) {
+	}
+}
@@ -0,0 +1,53 @@
+/*
+ * board.h (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Reemplazo de board.h para compilar el OS sin cambios sobre la maquina mps2-an386
+ *  de QEMU. Solo expone CMSIS (a traves de cmsis_43xx.h), el reloj del sistema y los
+ *  timers CMSDK: TIMER0 es el contador de ciclos de los benchmarks y TIMER1 genera la
+ *  interrupcion periodica de la medicion de latencia.
+ */
+
+#ifndef MSE_OS_BENCH_QEMU_BOARD_H_
+#define MSE_OS_BENCH_QEMU_BOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmsis_43xx.h"
+
+
+/*==================[reloj del sistema]=================================*/
+
+#define MPS2_SYSCLK			25000000		//SYSCLK del mps2-an386 (CPU, SysTick y timers APB)
+
+extern uint32_t SystemCoreClock;
+
+void SystemCoreClockUpdate(void);
+void Board_Init(void);
+
+
+/*==================[timer CMSDK APB]=================================*/
+
+struct _timerCMSDK  {
+	volatile uint32_t CTRL;
+	volatile uint32_t VALUE;
+	volatile uint32_t RELOAD;
+	volatile uint32_t INTSTATUS;
+};
+
+typedef struct _timerCMSDK timerCMSDK;
+
+#define CMSDK_TIMER0		((timerCMSDK*) 0x40000000)
+#define CMSDK_TIMER1		((timerCMSDK*) 0x40001000)
+#define CMSDK_TIMER_EN		(1UL << 0)
+#define CMSDK_TIMER_IRQ_EN	(1UL << 3)
+
+/*
+ * QEMU no emula el DWT: las mediciones de OS_LATENCIA_IRQ usan TIMER0, que corre libre
+ * desde Board_Init contando hacia abajo
+ */
+#define OS_CICLOS()			(~CMSDK_TIMER0->VALUE)
+#define OS_CICLOS_INIT()
+
+
+#endif /* MSE_OS_BENCH_QEMU_BOARD_H_ */
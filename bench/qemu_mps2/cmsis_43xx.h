@@ -0,0 +1,101 @@
+/*
+ * cmsis_43xx.h (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Cabecera de dispositivo para correr el OS sobre el Cortex-M4 de la maquina
+ *  mps2-an386 de QEMU. Se conserva la numeracion de interrupciones del LPC43xx
+ *  para que MSE_OS_IRQ.c compile sin cambios: la tabla de vectores de
+ *  startup_mps2.c ubica cada handler en la misma posicion que en el LPC43xx.
+ *  Los benchmarks solo generan interrupciones por software (NVIC_SetPendingIRQ),
+ *  por lo que no importa que periferico del mps2 este conectado a cada linea.
+ */
+
+#ifndef MSE_OS_BENCH_QEMU_CMSIS_43XX_H_
+#define MSE_OS_BENCH_QEMU_CMSIS_43XX_H_
+
+#include <stdint.h>
+
+
+/*==================[numeracion de interrupciones (igual que LPC43xx)]=================================*/
+
+typedef enum  {
+	Reset_IRQn				= -15,
+	NonMaskableInt_IRQn		= -14,
+	HardFault_IRQn			= -13,
+	MemoryManagement_IRQn	= -12,
+	BusFault_IRQn			= -11,
+	UsageFault_IRQn			= -10,
+	SVCall_IRQn				= -5,
+	DebugMonitor_IRQn		= -4,
+	PendSV_IRQn				= -2,
+	SysTick_IRQn			= -1,
+
+	DAC_IRQn				= 0,
+	M0APP_IRQn				= 1,
+	DMA_IRQn				= 2,
+	RESERVED1_IRQn			= 3,
+	RESERVED2_IRQn			= 4,
+	ETHERNET_IRQn			= 5,
+	SDIO_IRQn				= 6,
+	LCD_IRQn				= 7,
+	USB0_IRQn				= 8,
+	USB1_IRQn				= 9,
+	SCT_IRQn				= 10,
+	RITIMER_IRQn			= 11,
+	TIMER0_IRQn				= 12,
+	TIMER1_IRQn				= 13,
+	TIMER2_IRQn				= 14,
+	TIMER3_IRQn				= 15,
+	MCPWM_IRQn				= 16,
+	ADC0_IRQn				= 17,
+	I2C0_IRQn				= 18,
+	I2C1_IRQn				= 19,
+	SPI_INT_IRQn			= 20,
+	ADC1_IRQn				= 21,
+	SSP0_IRQn				= 22,
+	SSP1_IRQn				= 23,
+	USART0_IRQn				= 24,
+	UART1_IRQn				= 25,
+	USART2_IRQn				= 26,
+	USART3_IRQn				= 27,
+	I2S0_IRQn				= 28,
+	I2S1_IRQn				= 29,
+	RESERVED4_IRQn			= 30,
+	SGPIO_INT_IRQn			= 31,
+	PIN_INT0_IRQn			= 32,
+	PIN_INT1_IRQn			= 33,
+	PIN_INT2_IRQn			= 34,
+	PIN_INT3_IRQn			= 35,
+	PIN_INT4_IRQn			= 36,
+	PIN_INT5_IRQn			= 37,
+	PIN_INT6_IRQn			= 38,
+	PIN_INT7_IRQn			= 39,
+	GINT0_IRQn				= 40,
+	GINT1_IRQn				= 41,
+	EVENTROUTER_IRQn		= 42,
+	C_CAN1_IRQn				= 43,
+	RESERVED5_IRQn			= 44,
+	ADCHS_IRQn				= 45,
+	ATIMER_IRQn				= 46,
+	RTC_IRQn				= 47,
+	RESERVED6_IRQn			= 48,
+	WWDT_IRQn				= 49,
+	M0SUB_IRQn				= 50,
+	C_CAN0_IRQn				= 51,
+	QEI_IRQn				= 52
+} LPC43XX_IRQn_Type;
+
+typedef LPC43XX_IRQn_Type IRQn_Type;
+
+
+/*==================[configuracion del core para CMSIS]=================================*/
+
+#define __CM4_REV					0x0001
+#define __MPU_PRESENT				1
+#define __NVIC_PRIO_BITS			3
+#define __Vendor_SysTickConfig		0
+#define __FPU_PRESENT				1
+
+#include "core_cm4.h"
+
+
+#endif /* MSE_OS_BENCH_QEMU_CMSIS_43XX_H_ */
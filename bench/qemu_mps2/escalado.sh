@@ -0,0 +1,69 @@
+#!/bin/sh
+#
+# escalado.sh (firmware de benchmarks para QEMU mps2-an386)
+#
+#  Compila y corre el firmware de benchmarks con varias combinaciones de
+#  MAX_TASK_COUNT y cantidad de prioridades, y junta las lineas bench de todas las
+#  corridas en un unico CSV por la salida estandar, con la configuracion al
+#  principio de cada linea:
+#
+#    <tareas>,<prioridades>,bench,<nombre>,<parametro>,<muestras>,<min>,<promedio>,<max>
+#
+#  Uso, desde cualquier directorio:
+#
+#    CMSIS=<CMSIS>/Core/Include bench/qemu_mps2/escalado.sh [tareas:prioridades ...] > escalado.csv
+#
+#  Sin argumentos recorre de 8 a 128 tareas y de 4 a 32 prioridades. El firmware
+#  necesita al menos 8 tareas y 4 prioridades. El compilador, QEMU, las opciones
+#  extra y el tiempo maximo por corrida (en segundos) se cambian con las variables
+#  CC, QEMU, CFLAGS (por ejemplo CFLAGS=-DOS_EDF=1) y TIEMPO.
+#
+
+set -e
+
+: "${CMSIS:?definir CMSIS con el directorio de core_cm4.h}"
+
+CC=${CC:-arm-none-eabi-gcc}
+QEMU=${QEMU:-qemu-system-arm}
+TIEMPO=${TIEMPO:-600}
+
+RAIZ=$(cd "$(dirname "$0")/../.." && pwd)
+BENCH=$RAIZ/bench/qemu_mps2
+
+if [ $# -eq 0 ]; then
+	set -- 8:4 16:4 16:8 32:8 32:16 64:16 64:32 128:32
+fi
+
+TEMPORAL=$(mktemp -d)
+trap 'rm -rf "$TEMPORAL"' EXIT
+
+echo "#tareas,prioridades,bench,nombre,parametro,muestras,min,promedio,max"
+
+for conf in "$@"; do
+	tareas=${conf%%:*}
+	prioridades=${conf#*:}
+	elf=$TEMPORAL/bench_${tareas}_${prioridades}.elf
+	salida=$TEMPORAL/bench_${tareas}_${prioridades}.txt
+
+	echo "escalado: $tareas tareas, $prioridades prioridades" >&2
+
+	# CFLAGS se expande sin comillas para admitir varias opciones
+	"$CC" -mcpu=cortex-m4 -mthumb -mfpu=fpv4-sp-d16 -mfloat-abi=hard -O2 -nostartfiles \
+		-DMAX_TASK_COUNT="$tareas" -DMIN_PRIORITY=$((prioridades - 1)) $CFLAGS \
+		-I"$BENCH" -I"$RAIZ/inc" -I"$CMSIS" -T "$BENCH/mps2_an386.ld" \
+		"$RAIZ/src/MSE_OS_Core.c" "$RAIZ/src/MSE_OS_API.c" "$RAIZ/src/MSE_OS_IRQ.c" \
+		"$RAIZ/src/PendSV_Handler.S" "$BENCH/startup_mps2.c" "$BENCH/semihosting.c" \
+		"$BENCH/bench_main.c" -o "$elf"
+
+	# Un error del OS deja al firmware en errorHook, por lo que la corrida se corta por
+	# tiempo y le falta la linea #fin
+	timeout "$TIEMPO" "$QEMU" -M mps2-an386 -nographic -icount shift=0 \
+		-semihosting-config enable=on,target=native -kernel "$elf" > "$salida" || true
+
+	if ! grep -q '^#fin' "$salida"; then
+		echo "escalado: la corrida de $tareas tareas y $prioridades prioridades no termino" >&2
+		exit 1
+	fi
+
+	grep '^bench,' "$salida" | sed "s/^/$tareas,$prioridades,/"
+done
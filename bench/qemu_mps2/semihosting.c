@@ -0,0 +1,49 @@
+/*
+ * semihosting.c (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Llamadas de semihosting minimas: SYS_WRITE0 para imprimir y SYS_EXIT para
+ *  terminar QEMU. Se evita printf para no depender de newlib ni consumir el
+ *  stack de 256 bytes de las tareas.
+ */
+
+#include "semihosting.h"
+
+
+#define SYS_WRITE0				0x04
+#define SYS_EXIT				0x18
+#define ADP_STOPPED_APP_EXIT	0x20026
+
+
+static uint32_t llamadaSemihosting(uint32_t operacion, const void* argumento)  {
+	register uint32_t r0 __asm__("r0") = operacion;
+	register const void* r1 __asm__("r1") = argumento;
+
+	__asm volatile ("bkpt 0xAB" : "+r" (r0) : "r" (r1) : "memory");
+
+	return r0;
+}
+
+
+void sh_Escribir(const char* texto)  {
+	llamadaSemihosting(SYS_WRITE0, texto);
+}
+
+
+void sh_EscribirUint(uint32_t valor)  {
+	static char buffer[11];
+	uint8_t i = sizeof(buffer) - 1;
+
+	buffer[i] = '\0';
+
+	do  {
+		buffer[--i] = '0' + valor % 10;
+		valor /= 10;
+	} while (valor > 0);
+
+	sh_Escribir(&buffer[i]);
+}
+
+
+void sh_Salir(void)  {
+	llamadaSemihosting(SYS_EXIT, (const void*) ADP_STOPPED_APP_EXIT);
+}
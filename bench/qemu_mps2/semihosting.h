@@ -0,0 +1,19 @@
+/*
+ * semihosting.h (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Salida de resultados por semihosting ARM. Requiere correr QEMU con
+ *  -semihosting-config enable=on,target=native
+ */
+
+#ifndef MSE_OS_BENCH_QEMU_SEMIHOSTING_H_
+#define MSE_OS_BENCH_QEMU_SEMIHOSTING_H_
+
+#include <stdint.h>
+
+
+void sh_Escribir(const char* texto);
+void sh_EscribirUint(uint32_t valor);
+void sh_Salir(void);
+
+
+#endif /* MSE_OS_BENCH_QEMU_SEMIHOSTING_H_ */
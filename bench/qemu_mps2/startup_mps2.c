@@ -0,0 +1,123 @@
+/*
+ * startup_mps2.c (firmware de benchmarks para QEMU mps2-an386)
+ *
+ *  Tabla de vectores y rutina de reset. Las excepciones del core apuntan a los
+ *  handlers del OS (PendSV_Handler, SysTick_Handler) y las interrupciones
+ *  externas a los handlers de MSE_OS_IRQ.c, en el orden del LPC43xx.
+ */
+
+#include "board.h"
+
+
+/*==================[simbolos del linker script]=================================*/
+
+extern uint32_t _vStackTop;
+extern uint32_t _etext, _data, _edata, _bss, _ebss;
+
+int main(void);
+
+
+/*==================[handlers]=================================*/
+
+void Reset_Handler(void);
+void PendSV_Handler(void);
+void SysTick_Handler(void);
+
+void __attribute__((weak)) Default_Handler(void)  {
+	while(1);
+}
+
+void NMI_Handler(void)			__attribute__((weak, alias("Default_Handler")));
+void HardFault_Handler(void)	__attribute__((weak, alias("Default_Handler")));
+void MemManage_Handler(void)	__attribute__((weak, alias("Default_Handler")));
+void BusFault_Handler(void)		__attribute__((weak, alias("Default_Handler")));
+void UsageFault_Handler(void)	__attribute__((weak, alias("Default_Handler")));
+void SVC_Handler(void)			__attribute__((weak, alias("Default_Handler")));
+void DebugMon_Handler(void)		__attribute__((weak, alias("Default_Handler")));
+
+void DAC_IRQHandler(void);			void M0APP_IRQHandler(void);		void DMA_IRQHandler(void);
+void FLASH_EEPROM_IRQHandler(void);	void ETH_IRQHandler(void);			void SDIO_IRQHandler(void);
+void LCD_IRQHandler(void);			void USB0_IRQHandler(void);			void USB1_IRQHandler(void);
+void SCT_IRQHandler(void);			void RIT_IRQHandler(void);			void TIMER0_IRQHandler(void);
+void TIMER1_IRQHandler(void);		void TIMER2_IRQHandler(void);		void TIMER3_IRQHandler(void);
+void MCPWM_IRQHandler(void);		void ADC0_IRQHandler(void);			void I2C0_IRQHandler(void);
+void I2C1_IRQHandler(void);			void SPI_IRQHandler(void);			void ADC1_IRQHandler(void);
+void SSP0_IRQHandler(void);			void SSP1_IRQHandler(void);			void UART0_IRQHandler(void);
+void UART1_IRQHandler(void);		void UART2_IRQHandler(void);		void UART3_IRQHandler(void);
+void I2S0_IRQHandler(void);			void I2S1_IRQHandler(void);			void SPIFI_IRQHandler(void);
+void SGPIO_IRQHandler(void);		void GPIO0_IRQHandler(void);		void GPIO1_IRQHandler(void);
+void GPIO2_IRQHandler(void);		void GPIO3_IRQHandler(void);		void GPIO4_IRQHandler(void);
+void GPIO5_IRQHandler(void);		void GPIO6_IRQHandler(void);		void GPIO7_IRQHandler(void);
+void GINT0_IRQHandler(void);		void GINT1_IRQHandler(void);		void EVRT_IRQHandler(void);
+void CAN1_IRQHandler(void);			void ADCHS_IRQHandler(void);		void ATIMER_IRQHandler(void);
+void RTC_IRQHandler(void);			void WDT_IRQHandler(void);			void M0SUB_IRQHandler(void);
+void CAN0_IRQHandler(void);			void QEI_IRQHandler(void);
+
+
+/*==================[tabla de vectores]=================================*/
+
+__attribute__((section(".isr_vector"), used))
+void (* const tablaVectores[])(void) = {
+	(void (*)(void)) &_vStackTop,
+	Reset_Handler,		NMI_Handler,		HardFault_Handler,	MemManage_Handler,
+	BusFault_Handler,	UsageFault_Handler,	0,					0,
+	0,					0,					SVC_Handler,		DebugMon_Handler,
+	0,					PendSV_Handler,		SysTick_Handler,
+
+	DAC_IRQHandler,		M0APP_IRQHandler,	DMA_IRQHandler,		FLASH_EEPROM_IRQHandler,
+	Default_Handler,	ETH_IRQHandler,		SDIO_IRQHandler,	LCD_IRQHandler,
+	USB0_IRQHandler,	USB1_IRQHandler,	SCT_IRQHandler,		RIT_IRQHandler,
+	TIMER0_IRQHandler,	TIMER1_IRQHandler,	TIMER2_IRQHandler,	TIMER3_IRQHandler,
+	MCPWM_IRQHandler,	ADC0_IRQHandler,	I2C0_IRQHandler,	I2C1_IRQHandler,
+	SPI_IRQHandler,		ADC1_IRQHandler,	SSP0_IRQHandler,	SSP1_IRQHandler,
+	UART0_IRQHandler,	UART1_IRQHandler,	UART2_IRQHandler,	UART3_IRQHandler,
+	I2S0_IRQHandler,	I2S1_IRQHandler,	SPIFI_IRQHandler,	SGPIO_IRQHandler,
+	GPIO0_IRQHandler,	GPIO1_IRQHandler,	GPIO2_IRQHandler,	GPIO3_IRQHandler,
+	GPIO4_IRQHandler,	GPIO5_IRQHandler,	GPIO6_IRQHandler,	GPIO7_IRQHandler,
+	GINT0_IRQHandler,	GINT1_IRQHandler,	EVRT_IRQHandler,	CAN1_IRQHandler,
+	Default_Handler,	ADCHS_IRQHandler,	ATIMER_IRQHandler,	RTC_IRQHandler,
+	Default_Handler,	WDT_IRQHandler,		M0SUB_IRQHandler,	CAN0_IRQHandler,
+	QEI_IRQHandler
+};
+
+
+/*==================[reset]=================================*/
+
+uint32_t SystemCoreClock = MPS2_SYSCLK;
+
+
+void SystemCoreClockUpdate(void)  {
+	SystemCoreClock = MPS2_SYSCLK;
+}
+
+
+/*
+ * El timer CMSDK 0 queda corriendo libre desde 0xFFFFFFFF hacia abajo, sin interrupcion.
+ * Los benchmarks lo leen como contador de ciclos del reloj del sistema
+ */
+void Board_Init(void)  {
+	CMSDK_TIMER0->CTRL = 0;
+	CMSDK_TIMER0->RELOAD = 0xFFFFFFFF;
+	CMSDK_TIMER0->VALUE = 0xFFFFFFFF;
+	CMSDK_TIMER0->CTRL = CMSDK_TIMER_EN;
+}
+
+
+void Reset_Handler(void)  {
+	uint32_t *origen, *destino;
+
+	origen = &_etext;
+	for (destino = &_data; destino < &_edata; destino++)
+		*destino = *origen++;
+
+	for (destino = &_bss; destino < &_ebss; destino++)
+		*destino = 0;
+
+	SCB->CPACR |= (0xF << 20);			//CP10 y CP11 con acceso completo (FPU)
+	__DSB();
+	__ISB();
+
+	main();
+
+	while(1);
+}
@@ -12,16 +12,27 @@
 #include "MSE_OS_Core.h"
 
 
+#ifndef OS_CONJUNTO_MAX_MIEMBROS
+#define OS_CONJUNTO_MAX_MIEMBROS	8			//colas y semaforos por conjunto
+#endif
+
+
+struct _conjunto;
+
+
 /********************************************************************************
  * Definicion de la estructura para los semaforos
  *******************************************************************************/
 struct _semaforo  {
 	tarea* tarea_asociada;
 	bool tomado;
+	struct _conjunto* conjunto;					//conjunto al que pertenece, o NULL
 };
 
 typedef struct _semaforo osSemaforo;
 
+#define OS_SEMAFORO_INICIALIZADOR	{ .tarea_asociada = NULL, .tomado = true }	//equivale a os_SemaforoInit
+
 
 
 /********************************************************************************
@@ -33,20 +44,267 @@ struct _cola  {
 	uint16_t indice_head;
 	uint16_t indice_tail;
 	uint16_t size_elemento;
+	struct _conjunto* conjunto;					//conjunto al que pertenece, o NULL
 };
 
 typedef struct _cola osCola;
 
+#define OS_COLA_INICIALIZADOR(datasize)	{ .size_elemento = (datasize) }		//equivale a os_ColaInit
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para los stream buffers
+ *
+ * Buffer circular de bytes sin separacion en elementos, con la memoria provista
+ * por el usuario. La tarea lectora solo se despierta cuando hay al menos
+ * nivel_disparo bytes (o los que pidio, si son menos), y la escritora cuando se
+ * libera el espacio que necesita, con lo que un stream de bytes no produce un
+ * cambio de contexto por byte. Admite una tarea lectora y una escritora
+ * bloqueadas a la vez.
+ *******************************************************************************/
+struct _streamBuffer  {
+	uint8_t* memoria;
+	uint16_t tamanio;							//capacidad en bytes
+	uint16_t indice_head;						//proxima posicion a escribir
+	uint16_t indice_tail;						//proxima posicion a leer
+	uint16_t cantidad;							//bytes almacenados
+	uint16_t nivel_disparo;						//bytes minimos para despertar a la lectora
+	uint16_t bytes_esperados;					//bytes que espera la lectora bloqueada
+	uint16_t espacio_esperado;					//espacio que espera la escritora bloqueada
+	bool lectura_forzada;						//la lectora debe volver aunque no llegue al nivel de disparo, hasta vaciar el stream
+	tarea* tarea_lectora;
+	tarea* tarea_escritora;
+};
+
+typedef struct _streamBuffer osStreamBuffer;
+
+#define OS_STREAM_BUFFER_INICIALIZADOR(_memoria, _tamanio, _nivel_disparo)					\
+	{ .memoria = (_memoria), .tamanio = (_tamanio), .nivel_disparo = (_nivel_disparo) }	//equivale a os_StreamBufferInit
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para los conjuntos de colas y semaforos
+ *
+ * Permite que una tarea espere a la vez en varias colas y semaforos, como un
+ * select: os_ConjuntoEsperar bloquea a la tarea hasta que alguno de los
+ * miembros tenga un dato para leer (las colas) o este libre (los semaforos) y
+ * devuelve cual, que luego se lee o se toma sin bloquearse. Cada cola o
+ * semaforo pertenece a lo sumo a un conjunto, y solo una tarea puede esperar
+ * en el conjunto a la vez.
+ *******************************************************************************/
+enum _tipoMiembro  {
+	MIEMBRO_COLA,
+	MIEMBRO_SEMAFORO
+};
+
+typedef enum _tipoMiembro tipoMiembro;
+
+struct _miembroConjunto  {
+	void* objeto;
+	tipoMiembro tipo;
+};
+
+typedef struct _miembroConjunto miembroConjunto;
+
+struct _conjunto  {
+	miembroConjunto miembros[OS_CONJUNTO_MAX_MIEMBROS];
+	tarea* tarea_asociada;
+	uint8_t cantidad;
+	uint8_t siguiente;							//primer miembro a revisar, para no favorecer a ninguno
+};
+
+typedef struct _conjunto osConjunto;
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para los locks de lectura y escritura
+ *
+ * Varias tareas lectoras pueden tener el lock a la vez, y una escritora lo tiene
+ * sola. Las escritoras tienen preferencia: una lectora nueva espera si hay una
+ * escritora esperando, con lo que un flujo continuo de lecturas no posterga
+ * indefinidamente a las escrituras. Las tareas en espera se despiertan por
+ * prioridad. No debe eliminarse una tarea que tiene el lock o que lo espera
+ * (ver os_DeleteTask).
+ *******************************************************************************/
+struct _rwlock  {
+	listaEspera lectoras;						//tareas esperando para leer
+	listaEspera escritoras;						//tareas esperando para escribir
+	tarea* escritora;							//tarea que tiene el lock para escribir, o NULL
+	uint16_t lectoras_activas;					//tareas que tienen el lock para leer
+};
+
+typedef struct _rwlock osRWLock;
+
+#define OS_RWLOCK_INICIALIZADOR		{ .escritora = NULL, .lectoras_activas = 0 }	//equivale a os_RWLockInit
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para los mutex
+ *
+ * Exclusion mutua con dueño: solo la tarea que tomo el mutex puede liberarlo, y
+ * al liberarlo se lo entrega directamente a la tarea en espera de mayor
+ * prioridad, con lo que ninguna otra puede adelantarse. No es recursivo ni
+ * hereda prioridades. No debe eliminarse una tarea que tiene el mutex o que lo
+ * espera, porque puede ser la dueña sin haber llegado a correr (ver
+ * os_DeleteTask).
+ *******************************************************************************/
+struct _mutex  {
+	listaEspera esperando;						//tareas esperando para tomarlo
+	tarea* propietaria;							//tarea que lo tiene, o NULL si esta libre
+};
+
+typedef struct _mutex osMutex;
+
+#define OS_MUTEX_INICIALIZADOR		{ .propietaria = NULL }		//equivale a os_MutexInit
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para las variables de condicion
+ *
+ * Una tarea que tiene el mutex espera en la variable a que cambie el estado que
+ * el mutex protege (por ejemplo, que un buffer supere un nivel): la espera
+ * libera el mutex y bloquea a la tarea en un solo paso, y lo vuelve a tomar
+ * antes de retornar. Quien modifica el estado avisa con os_CondicionSenalar
+ * (a la tarea de mayor prioridad) u os_CondicionDifundir (a todas).
+ *******************************************************************************/
+struct _condicion  {
+	listaEspera esperando;						//tareas esperando un aviso
+	osMutex* mutex;								//mutex de la ultima espera
+};
+
+typedef struct _condicion osCondicion;
+
+#define OS_CONDICION_INICIALIZADOR	{ .mutex = NULL }			//equivale a os_CondicionInit
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para las colas con prioridad
+ *
+ * Cada mensaje lleva una prioridad (0 es la mas urgente, como en las tareas) y
+ * la lectura devuelve siempre el mensaje mas urgente, y entre los de igual
+ * prioridad el mas antiguo. Los mensajes se copian una sola vez a una posicion
+ * fija de la memoria de la cola, y lo que se ordena es un heap de entradas
+ * pequeñas que apuntan a esas posiciones, por lo que escribir y leer cuestan
+ * O(log n) sin importar el tamaño de los mensajes. Las posiciones libres se
+ * guardan en las entradas del heap que no estan en uso, sin memoria extra.
+ * Admite varias tareas esperando para leer o escribir a la vez. El orden entre
+ * mensajes de igual prioridad se mantiene mientras ninguno quede en la cola
+ * durante 32768 escrituras o mas.
+ *******************************************************************************/
+struct _mensajePrioridad  {
+	uint16_t posicion;							//posicion del mensaje en la memoria de datos
+	uint16_t secuencia;							//orden de escritura, para los de igual prioridad
+	uint8_t prioridad;
+};
+
+typedef struct _mensajePrioridad mensajePrioridad;
+
+struct _colaPrioridad  {
+	mensajePrioridad* heap;						//cantidad entradas en uso, luego las posiciones libres
+	uint8_t* datos;
+	uint16_t capacidad;							//mensajes
+	uint16_t cantidad;							//mensajes almacenados
+	uint16_t size_elemento;
+	uint16_t secuencia;							//secuencia del proximo mensaje
+	listaEspera lectoras;
+	listaEspera escritoras;
+};
+
+typedef struct _colaPrioridad osColaPrioridad;
+
+/*
+ * Memoria necesaria para una cola con prioridad: las entradas del heap y luego los datos,
+ * alineados a 4 bytes. OS_COLA_PRIORIDAD_MEMORIA declara un arreglo alineado de ese tamaño
+ */
+#define OS_COLA_PRIORIDAD_OFFSET_DATOS(capacidad)						\
+	((((capacidad) * sizeof(mensajePrioridad)) + 3) & ~3UL)
+#define OS_COLA_PRIORIDAD_TAMANIO(capacidad, tam_elemento)				\
+	(OS_COLA_PRIORIDAD_OFFSET_DATOS(capacidad) + (capacidad) * (tam_elemento))
+#define OS_COLA_PRIORIDAD_MEMORIA(nombre, capacidad, tam_elemento)		\
+	uint32_t nombre[(OS_COLA_PRIORIDAD_TAMANIO(capacidad, tam_elemento) + 3) / 4]
+
+
+
+/********************************************************************************
+ * Definicion de la estructura para las notificaciones con cuenta
+ *
+ * Un handler que dispara en rafagas (un GPIO, el fin de conversion de un ADC)
+ * avisa cada evento con os_NotificacionDar, que solo lo cuenta, y la tarea que
+ * los atiende despierta una vez por lote con os_NotificacionEsperar, que
+ * devuelve cuantos eventos se acumularon. El lote se cierra al juntar umbral
+ * eventos o, si demora no es 0, a los demora ticks de haber eventos pendientes
+ * con la tarea esperando, lo que ocurra antes. Mientras la tarea procesa un
+ * lote los avisos no la despiertan ni piden scheduling. Pensada para una sola
+ * tarea que espera.
+ *******************************************************************************/
+struct _notificacion  {
+	listaEspera esperando;						//tarea esperando el lote
+	uint32_t pendientes;						//eventos desde la ultima espera
+	uint32_t umbral;							//eventos que cierran el lote
+	uint32_t demora;							//ticks maximos de un lote incompleto, 0 sin limite
+	bool demorando;								//la tarea en espera tiene la demora cargada
+};
+
+typedef struct _notificacion osNotificacion;
+
 
 void os_Delay(uint32_t ticks);
 
 void os_SemaforoInit(osSemaforo* sem);
 void os_SemaforoTake(osSemaforo* sem);
 void os_SemaforoGive(osSemaforo* sem);
+bool os_SemaforoTakeSinEspera(osSemaforo* sem);
 
 void os_ColaInit(osCola* cola, uint16_t datasize);
 void os_ColaWrite(osCola* cola, void* dato);
 void os_ColaRead(osCola* cola, void* dato);
+bool os_ColaReadSinEspera(osCola* cola, void* dato);
+
+void os_StreamBufferInit(osStreamBuffer* sb, uint8_t* memoria, uint16_t tamanio, uint16_t nivel_disparo);
+uint16_t os_StreamBufferWrite(osStreamBuffer* sb, const void* datos, uint16_t cantidad);
+uint16_t os_StreamBufferRead(osStreamBuffer* sb, void* datos, uint16_t maximo);
+uint16_t os_StreamBufferLeerBloque(osStreamBuffer* sb, uint8_t** bloque);
+void os_StreamBufferLiberar(osStreamBuffer* sb, uint16_t cantidad);
+uint16_t os_StreamBufferReservarBloque(osStreamBuffer* sb, uint8_t** bloque);
+void os_StreamBufferConfirmar(osStreamBuffer* sb, uint16_t cantidad);
+uint16_t os_StreamBufferDisponible(osStreamBuffer* sb);
+void os_StreamBufferForzarLectura(osStreamBuffer* sb);
+void os_StreamBufferSetNivelDisparo(osStreamBuffer* sb, uint16_t nivel_disparo);
+
+void os_ConjuntoInit(osConjunto* conjunto);
+bool os_ConjuntoAgregarCola(osConjunto* conjunto, osCola* cola);
+bool os_ConjuntoAgregarSemaforo(osConjunto* conjunto, osSemaforo* sem);
+void* os_ConjuntoEsperar(osConjunto* conjunto);
+
+void os_RWLockInit(osRWLock* lock);
+void os_RWLockLeer(osRWLock* lock);
+void os_RWLockLiberarLectura(osRWLock* lock);
+void os_RWLockEscribir(osRWLock* lock);
+void os_RWLockLiberarEscritura(osRWLock* lock);
+
+void os_MutexInit(osMutex* mutex);
+void os_MutexTomar(osMutex* mutex);
+void os_MutexLiberar(osMutex* mutex);
+
+void os_CondicionInit(osCondicion* cond);
+void os_CondicionEsperar(osCondicion* cond, osMutex* mutex);
+void os_CondicionSenalar(osCondicion* cond);
+void os_CondicionDifundir(osCondicion* cond);
+
+void os_ColaPrioridadInit(osColaPrioridad* cola, void* memoria, uint16_t capacidad, uint16_t datasize);
+bool os_ColaPrioridadWrite(osColaPrioridad* cola, const void* dato, uint8_t prioridad);
+bool os_ColaPrioridadRead(osColaPrioridad* cola, void* dato, uint8_t* prioridad);
+uint16_t os_ColaPrioridadCantidad(osColaPrioridad* cola);
+
+void os_NotificacionInit(osNotificacion* notif, uint32_t umbral, uint32_t demora);
+void os_NotificacionDar(osNotificacion* notif);
+uint32_t os_NotificacionEsperar(osNotificacion* notif);
 
 
 #endif /* ISO_I_2020_MSE_OS_INC_MSE_OS_API_H_ */
@@ -0,0 +1,55 @@
+/*
+ * MSE_OS_Adc.h
+ *
+ *  Servicio de adquisicion con el ADC en modo burst y el GPDMA en ping-pong.
+ *
+ *  El GPDMA recorre una lista circular de dos descriptores, por lo que llena un bloque
+ *  mientras una tarea procesa el otro, sin interrupciones por muestra ni huecos entre
+ *  bloques. Al completar cada bloque, el handler de DMA_IRQn entrega el puntero al bloque
+ *  por una cola de punteros: los datos no se copian. La tarea debe devolver el bloque con
+ *  os_AdcLiberarBloque antes de que el DMA vuelva a escribirlo (un bloque despues); si no
+ *  llega a tiempo se cuenta un desborde.
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_ADC_H_
+#define MSE_OS_INC_MSE_OS_ADC_H_
+
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_DMA.h"
+
+
+#ifndef OS_ADC_MUESTRAS_BLOQUE
+#define OS_ADC_MUESTRAS_BLOQUE		128			//muestras por bloque, como maximo 4095
+#endif
+
+#define OS_ADC_BLOQUES				2
+
+
+/********************************************************************************
+ * Definicion de la estructura del servicio de adquisicion
+ *******************************************************************************/
+struct _adcDMA  {
+	uint32_t bloques[OS_ADC_BLOQUES][OS_ADC_MUESTRAS_BLOQUE];	//formato del registro GDR
+	DMA_TransferDescriptor_t descriptores[OS_ADC_BLOQUES];
+	osCola bloques_llenos;					//cola de punteros a bloques
+	LPC_ADC_T* adc;
+	uint8_t canal_dma;
+	uint8_t bloque_dma;						//bloque que esta llenando el DMA
+	bool en_uso[OS_ADC_BLOQUES];			//bloques entregados a la tarea y no liberados
+	uint32_t bloques_completos;
+	uint32_t desbordes;
+};
+
+typedef struct _adcDMA osAdcDMA;
+
+
+bool os_AdcInit(osAdcDMA* adc, LPC_ADC_T* periferico, uint32_t conexion_dma, ADC_CHANNEL_T canal,
+		uint32_t frecuencia);
+uint32_t* os_AdcObtenerBloque(osAdcDMA* adc);
+void os_AdcLiberarBloque(osAdcDMA* adc, uint32_t* bloque);
+void os_AdcAQ15(const uint32_t* bloque, int16_t* destino, uint16_t cantidad);
+
+
+#endif /* MSE_OS_INC_MSE_OS_ADC_H_ */
@@ -16,9 +16,51 @@
 
 /************************************************************************************
  * 			Tamaño del stack predefinido para cada tarea expresado en bytes
+ *
+ * Es el mismo para todas las tareas, por lo que debe alcanzar para la que mas
+ * usa (por ejemplo las que formatean texto con printf). Multiplo de 8
  ***********************************************************************************/
 
+#ifndef STACK_SIZE
 #define STACK_SIZE 256
+#endif
+
+//----------------------------------------------------------------------------------
+
+
+
+/************************************************************************************
+ * 			Deteccion de desborde de stack y medicion de uso (high water mark)
+ ***********************************************************************************/
+
+#define STACK_PATTERN		0xA5A5A5A5		//patron con el que se pinta el stack de cada tarea
+#define STACK_CANARY		0xDEADBEEF		//centinela en la base del stack (stack[STACK_CANARY_POS])
+
+#ifndef OS_STACK_GUARDA_MPU
+#define OS_STACK_GUARDA_MPU	0				//1: region MPU sin acceso en la base del stack
+#endif
+
+#define STACK_GUARDA_SIZE		32			//tamaño en bytes de la guarda (minimo region MPU)
+#define OS_MPU_REGION_GUARDA	7			//region del MPU reservada para la guarda
+
+/*
+ * Con la guarda del MPU el centinela va en la primera palabra por encima de ella: la
+ * guarda no admite accesos, ni siquiera la lectura del cambio de contexto
+ */
+#if OS_STACK_GUARDA_MPU
+#define STACK_CANARY_POS		(STACK_GUARDA_SIZE/4)
+#else
+#define STACK_CANARY_POS		0
+#endif
+
+/*
+ * Direccion como palabra de 32 bits, para el stack frame inicial y stack_pointer. Un port
+ * con punteros de 64 bits (el POSIX) la redefine en su board.h, ya que ahi esos valores
+ * solo identifican el stack de la tarea y nunca se ejecutan
+ */
+#ifndef OS_DIRECCION
+#define OS_DIRECCION(p)			((uint32_t) (p))
+#endif
 
 //----------------------------------------------------------------------------------
 
@@ -66,24 +108,203 @@
 #define FULL_STACKING_SIZE 			17	//16 core registers + valor previo de LR
 
 #define TASK_NAME_SIZE				10	//tamaño array correspondiente al nombre
+
+#ifndef MAX_TASK_COUNT
 #define MAX_TASK_COUNT				8	//cantidad maxima de tareas para este OS
+#endif
 
 #define MAX_PRIORITY		0			//maxima prioridad que puede tener una tarea
+
+#ifndef MIN_PRIORITY
 #define MIN_PRIORITY		3			//minima prioridad que puede tener una tarea
+#endif
+
+#define PRIORITY_COUNT		((MIN_PRIORITY-MAX_PRIORITY)+1)	//cantidad de prioridades asignables
+
+#define ID_TAREA_IDLE		0xFFFF		//id reservado para la tarea idle
+#define PRIORIDAD_IDLE		0xFF		//prioridad de la tarea idle (menor que cualquier otra)
+
+/*
+ * Las prioridades listas para ejecutar se llevan en un mapa de bits de 32 bits, y los
+ * contadores e indices de tareas son de 16 bits
+ */
+#if PRIORITY_COUNT > 32
+#error "MSE_OS soporta hasta 32 prioridades (MIN_PRIORITY <= 31)"
+#endif
 
-#define PRIORITY_COUNT		(MIN_PRIORITY-MAX_PRIORITY)+1	//cantidad de prioridades asignables
+#if MAX_TASK_COUNT >= ID_TAREA_IDLE
+#error "MAX_TASK_COUNT demasiado grande"
+#endif
 
 #define QUEUE_HEAP_SIZE		64			//cantidad de bytes reservados por cada cola definida
 
+#define OS_SIN_TIME_SLICING	0			//quantum que desactiva el round-robin en una prioridad
+
+#ifndef OS_QUANTUM_DEFAULT
+#define OS_QUANTUM_DEFAULT	1			//ticks que corre una tarea antes de ceder a otra de igual prioridad
+#endif
+
+//----------------------------------------------------------------------------------
+
+
+
+/************************************************************************************
+ * 			Scheduling Earliest Deadline First (EDF)
+ *
+ * Con OS_EDF en 1 el scheduler ejecuta siempre la tarea lista cuyo deadline absoluto
+ * vence antes. Cada tarea declara un deadline relativo con os_SetDeadline; el deadline
+ * absoluto de cada trabajo se calcula cuando la tarea pasa a READY. Las tareas sin
+ * deadline (0) corren solo cuando no hay tareas con deadline listas, y entre ellas se
+ * aplican las prioridades fijas y el time slicing habituales.
+ ***********************************************************************************/
+
+#ifndef OS_EDF
+#define OS_EDF				0
+#endif
+
+#define OS_SIN_DEADLINE		0			//deadline relativo de las tareas que no usan EDF
+
+//----------------------------------------------------------------------------------
+
+
+
+/************************************************************************************
+ * 			Presupuestos de CPU por tarea (servidor esporadico)
+ *
+ * Con OS_PRESUPUESTOS en 1 cada tarea puede recibir con os_SetPresupuesto un maximo de
+ * ticks de CPU por periodo de reposicion. El consumo se cuenta en el SysTick; el
+ * presupuesto consumido se repone completo un periodo despues del tick en que la tarea
+ * empezo a consumirlo. Al agotarlo la tarea se suspende o se degrada a
+ * OS_PRIORIDAD_DEGRADADA hasta la reposicion.
+ ***********************************************************************************/
+
+#ifndef OS_PRESUPUESTOS
+#define OS_PRESUPUESTOS		0
+#endif
+
+#ifndef OS_PRIORIDAD_DEGRADADA
+#define OS_PRIORIDAD_DEGRADADA	MIN_PRIORITY	//prioridad de las tareas degradadas por presupuesto
+#endif
+
+#define OS_SIN_PRESUPUESTO	0			//presupuesto de las tareas sin limite de CPU
+
+#if OS_PRIORIDAD_DEGRADADA > MIN_PRIORITY
+#error "OS_PRIORIDAD_DEGRADADA debe ser una prioridad asignable"
+#endif
+
+//----------------------------------------------------------------------------------
+
+
+
+/************************************************************************************
+ * 			Monitor de tareas periodicas
+ *
+ * Con OS_MONITOR_PERIODICAS en 1 una tarea puede declararse periodica con
+ * os_SetPeriodica. El SysTick libera un trabajo por periodo y la tarea indica que lo
+ * termino con os_EsperarPeriodo. El OS registra el tiempo de respuesta de cada trabajo
+ * (desde su liberacion hasta su fin, en ticks) y cuenta los deadlines perdidos. El
+ * histograma es logaritmico: la posicion 0 cuenta respuestas de 0 ticks y la posicion
+ * n las de 2^(n-1) a 2^n - 1 ticks; la ultima acumula las mayores.
+ ***********************************************************************************/
+
+#ifndef OS_MONITOR_PERIODICAS
+#define OS_MONITOR_PERIODICAS	0
+#endif
+
+#ifndef OS_CANT_HIST_RESPUESTA
+#define OS_CANT_HIST_RESPUESTA	8		//posiciones del histograma de tiempos de respuesta
+#endif
+
+
+/************************************************************************************
+ * 			Medicion de latencia de interrupciones
+ *
+ * Con OS_LATENCIA_IRQ en 1 la capa de interrupciones mide, para las IRQ registradas con
+ * os_SetReferenciaIRQ, los ciclos desde el evento que produjo la interrupcion (que informa
+ * el periferico, por ejemplo el timer que la genero) hasta que corre la funcion del
+ * usuario, y los ciclos de la funcion del usuario. El OS registra ademas la seccion
+ * critica mas larga (interrupciones deshabilitadas con os_enter_critical), que es la
+ * principal causa de latencia. Los histogramas son logaritmicos como los de las tareas
+ * periodicas, en ciclos.
+ *
+ * Los ciclos se leen con OS_CICLOS(), por defecto el contador DWT_CYCCNT, que el OS
+ * habilita en os_Init con OS_CICLOS_INIT(). Las placas sin DWT redefinen ambas en board.h.
+ ***********************************************************************************/
+
+#ifndef OS_LATENCIA_IRQ
+#define OS_LATENCIA_IRQ			0
+#endif
+
+#ifndef OS_LATENCIA_CANT_IRQ
+#define OS_LATENCIA_CANT_IRQ	4		//cantidad de IRQ que se pueden medir a la vez
+#endif
+
+#ifndef OS_CANT_HIST_LATENCIA
+#define OS_CANT_HIST_LATENCIA	14		//posiciones del histograma, la ultima desde 4096 ciclos
+#endif
+
+/************************************************************************************
+ * 			Estadisticas de ejecucion de las tareas
+ *
+ * Con OS_ESTADISTICAS en 1 el OS cuenta para cada tarea (incluida la idle) los ticks en
+ * los que estaba corriendo y cuantas veces se le asigno el CPU, desde el arranque o desde
+ * el ultimo os_ReiniciarEstadisticas. Junto con os_getStackLibre es la informacion que
+ * muestra el shell de MSE_OS_Shell.c.
+ ***********************************************************************************/
+
+#ifndef OS_ESTADISTICAS
+#define OS_ESTADISTICAS			0
+#endif
+
+
+
+/************************************************************************************
+ * 			Perfil de secciones criticas por punto de llamada
+ *
+ * Con OS_PERFIL_CRITICAS en 1 el OS registra cada seccion critica mas externa segun la
+ * direccion desde la que se llamo a os_enter_critical: cantidad de veces, ciclos totales
+ * y maximos con las interrupciones deshabilitadas. os_getPerfilCriticas devuelve los
+ * puntos de llamada ordenados por su maximo; la direccion se traduce a funcion con
+ * addr2line sobre el firmware. Los ciclos se leen con OS_CICLOS().
+ ***********************************************************************************/
+
+#ifndef OS_PERFIL_CRITICAS
+#define OS_PERFIL_CRITICAS		0
+#endif
+
+#ifndef OS_PERFIL_CANT_SITIOS
+#define OS_PERFIL_CANT_SITIOS	32		//puntos de llamada distintos, potencia de 2
+#endif
+
+#ifndef OS_CICLOS
+#define OS_CICLOS()				(DWT->CYCCNT)
+#define OS_CICLOS_INIT()		do  {												\
+									CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;	\
+									DWT->CYCCNT = 0;								\
+									DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;			\
+								} while (0)
+#endif
+
 
 
 /*==================[definicion codigos de error y warning de OS]=================================*/
 #define ERR_OS_CANT_TAREAS		-1
 #define ERR_OS_SCHEDULING		-2
 #define ERR_OS_DELAY_FROM_ISR	-3
+#define ERR_OS_STACK_OVERFLOW	-4
+#define ERR_OS_PRIORIDAD		-5
+#define ERR_OS_TAREA_FROM_ISR	-6
+#define ERR_OS_TAREA_INVALIDA	-7
+#define ERR_OS_PRESUPUESTO		-8
+#define ERR_OS_PERIODO			-9
+#define ERR_OS_TABLA			-10
+#define ERR_OS_BLOQUEO_FROM_ISR	-11
+#define ERR_OS_MUTEX_AJENO		-12
 
 #define WARN_OS_QUEUE_FULL_ISR	-100
 #define WARN_OS_QUEUE_EMPTY_ISR	-101
+#define WARN_OS_CANT_TAREAS		-102
+#define WARN_OS_STREAM_LLENO_ISR	-103
 
 
 
@@ -96,7 +317,10 @@
 enum _estadoTarea  {
 	TAREA_READY,
 	TAREA_RUNNING,
-	TAREA_BLOCKED
+	TAREA_BLOCKED,
+	TAREA_SUSPENDED,			//detenida por os_Suspend hasta un os_Resume
+	TAREA_DELETED,				//eliminada con os_DeleteTask, su memoria puede reutilizarse
+	TAREA_AGOTADA				//agoto su presupuesto de CPU, espera la reposicion
 };
 
 typedef enum _estadoTarea estadoTarea;
@@ -117,17 +341,113 @@ enum _estadoOS  {
 typedef enum _estadoOS estadoOS;
 
 
+/********************************************************************************
+ * Definicion de las acciones posibles al agotarse el presupuesto de una tarea
+ *******************************************************************************/
+
+enum _accionPresupuesto  {
+	OS_PRESUPUESTO_SUSPENDER,	//la tarea no se ejecuta hasta la reposicion
+	OS_PRESUPUESTO_DEGRADAR		//la tarea sigue en OS_PRIORIDAD_DEGRADADA hasta la reposicion
+};
+
+typedef enum _accionPresupuesto accionPresupuesto;
+
+
+/********************************************************************************
+ * Definicion de las estadisticas de una tarea periodica
+ *******************************************************************************/
+
+struct _estadisticasPeriodica  {
+	uint32_t trabajos;							//trabajos terminados
+	uint32_t deadlines_perdidos;				//trabajos que superaron su deadline
+	uint32_t liberaciones_solapadas;			//liberaciones con el trabajo anterior sin terminar
+	uint32_t respuesta_min;						//tiempo de respuesta minimo en ticks
+	uint32_t respuesta_max;						//tiempo de respuesta maximo en ticks
+	uint32_t histograma[OS_CANT_HIST_RESPUESTA];	//tiempos de respuesta en escala logaritmica
+};
+
+typedef struct _estadisticasPeriodica estadisticasPeriodica;
+
+
+/********************************************************************************
+ * Definicion del perfil de secciones criticas de un punto de llamada
+ *******************************************************************************/
+
+struct _perfilCritica  {
+	void* sitio;								//direccion de retorno de os_enter_critical
+	uint32_t cantidad;							//secciones criticas desde ese punto
+	uint32_t ciclos_max;
+	uint64_t ciclos_total;
+};
+
+typedef struct _perfilCritica perfilCritica;
+
+
+
+/********************************************************************************
+ * Definicion de las listas de espera
+ *
+ * Las primitivas que admiten varias tareas esperando a la vez las encolan en una
+ * lista simplemente enlazada a traves de la propia tarea, ordenada por prioridad
+ * (y por orden de llegada entre iguales), con lo que no necesitan memoria
+ * adicional por tarea en espera.
+ *******************************************************************************/
+
+struct _listaEspera  {
+	struct _tarea* primera;						//tarea de mayor prioridad, NULL si esta vacia
+};
+
+typedef struct _listaEspera listaEspera;
+
+
+
 /********************************************************************************
  * Definicion de la estructura para cada tarea
  *******************************************************************************/
 struct _tarea  {
+#if OS_STACK_GUARDA_MPU
+	uint32_t stack[STACK_SIZE/4] __attribute__((aligned(STACK_GUARDA_SIZE)));
+#else
 	uint32_t stack[STACK_SIZE/4];
+#endif
 	uint32_t stack_pointer;
 	void *entry_point;
-	uint8_t id;
+	uint16_t id;
 	estadoTarea estado;
 	uint8_t prioridad;
 	uint32_t ticks_bloqueada;					//cantidad de ticks que la tarea debe permanecer bloqueada
+	listaEspera* lista_espera;					//lista en la que espera, NULL si no espera en ninguna
+	struct _tarea* siguiente_espera;			//siguiente tarea de esa lista
+	bool despertar_pendiente;					//se intento desbloquearla mientras estaba lista o corriendo
+#if OS_EDF
+	uint32_t deadline_relativo;					//ticks desde la liberacion de cada trabajo, 0 = sin deadline
+	uint32_t deadline_absoluto;					//tick en que vence el trabajo actual
+	uint16_t indice_heap;						//posicion de la tarea en el heap de tareas listas
+#endif
+#if OS_PRESUPUESTOS
+	uint32_t presupuesto;						//ticks de CPU por periodo, 0 = sin limite
+	uint32_t periodo_reposicion;				//ticks desde el inicio del consumo hasta la reposicion
+	uint32_t presupuesto_restante;				//ticks de CPU que le quedan a la tarea
+	uint32_t ticks_reposicion;					//ticks que faltan para reponer, 0 = sin consumo pendiente
+	uint32_t cant_agotamientos;					//cantidad de veces que agoto el presupuesto
+	accionPresupuesto accion_presupuesto;
+	uint8_t prioridad_base;						//prioridad asignada mientras la tarea esta degradada
+	bool degradada;
+#endif
+#if OS_ESTADISTICAS
+	uint32_t ticks_cpu;							//ticks en los que la tarea estaba corriendo
+	uint32_t cambios_contexto;					//veces que se le asigno el CPU
+#endif
+#if OS_MONITOR_PERIODICAS
+	uint32_t periodo;							//ticks entre liberaciones, 0 = tarea no periodica
+	uint32_t deadline;							//ticks desde la liberacion para terminar cada trabajo
+	uint32_t ticks_liberacion;					//ticks que faltan para la proxima liberacion
+	uint32_t liberacion;						//tick de liberacion del trabajo actual
+	uint16_t liberaciones_pendientes;			//liberaciones ocurridas con un trabajo en curso
+	bool trabajo_activo;						//la tarea tiene un trabajo liberado sin terminar
+	bool deadline_perdido;						//el trabajo actual ya se conto como perdido
+	estadisticasPeriodica estadisticas;
+#endif
 };
 
 typedef struct _tarea tarea;
@@ -140,13 +460,52 @@ typedef struct _tarea tarea;
 struct _osControl  {
 	void *listaTareas[MAX_TASK_COUNT];			//array de punteros a tareas
 	int32_t error;								//variable que contiene el ultimo error generado
-	uint8_t cantidad_Tareas;					//cantidad de tareas definidas por el usuario
-	uint8_t cantTareas_prioridad[PRIORITY_COUNT];	//cada posicion contiene cuantas tareas tienen la misma prioridad
+	uint16_t cantidad_Tareas;					//cantidad de tareas definidas por el usuario
+	uint16_t cantTareas_prioridad[PRIORITY_COUNT];	//cada posicion contiene cuantas tareas tienen la misma prioridad
+	uint16_t inicioPrioridad[PRIORITY_COUNT];	//posicion en listaTareas de la primer tarea de cada prioridad
+	uint16_t cantListas_prioridad[PRIORITY_COUNT];	//tareas READY o RUNNING de cada prioridad
+	uint32_t prioridadesListas;					//bit n en 1: hay tareas READY o RUNNING de prioridad n
+#if OS_EDF
+	tarea *heapListas[MAX_TASK_COUNT];			//heap de minimo por deadline de tareas listas con deadline
+	uint16_t cantHeap;							//cantidad de tareas en heapListas
+#endif
+
+	uint32_t idsUsados[(MAX_TASK_COUNT + 31) / 32];	//bit en 1: id asignado a una tarea existente
+
+	tarea *listaDemoradas[MAX_TASK_COUNT];		//tareas con ticks_bloqueada > 0 (sin orden)
+	uint16_t cantDemoradas;						//cantidad de tareas en listaDemoradas
+
+#if OS_PRESUPUESTOS
+	tarea *listaReposiciones[MAX_TASK_COUNT];	//tareas con ticks_reposicion > 0 (sin orden)
+	uint16_t cantReposiciones;					//cantidad de tareas en listaReposiciones
+#endif
+
+#if OS_MONITOR_PERIODICAS
+	tarea *listaPeriodicas[MAX_TASK_COUNT];		//tareas con periodo distinto de cero (sin orden)
+	uint16_t cantPeriodicas;					//cantidad de tareas en listaPeriodicas
+#endif
+
+	uint32_t ticks_sistema;						//ticks transcurridos desde el arranque
+#if OS_ESTADISTICAS
+	uint32_t ticks_estadisticas;				//ticks desde el ultimo os_ReiniciarEstadisticas
+#endif
 
 	estadoOS estado_sistema;					//Informacion sobre el estado del OS
 	bool cambioContextoNecesario;
 	bool schedulingFromIRQ;						//esta bandera se utiliza para la atencion a interrupciones
 	int16_t contador_critico;					//Contador de secciones criticas solicitadas
+#if OS_LATENCIA_IRQ || OS_PERFIL_CRITICAS
+	uint32_t inicio_critico;					//ciclos al entrar a la seccion critica mas externa
+#endif
+#if OS_LATENCIA_IRQ
+	uint32_t critico_max;						//seccion critica mas larga, en ciclos
+#endif
+#if OS_PERFIL_CRITICAS
+	void* sitio_critico;						//punto de llamada de la seccion critica mas externa
+#endif
+
+	uint16_t quantum[PRIORITY_COUNT];			//ticks de time slice de cada prioridad (0 = sin time slicing)
+	uint16_t quantumRestante;					//ticks que le quedan a la tarea actual de su time slice
 
 	tarea *tarea_actual;				//definicion de puntero para tarea actual
 	tarea *tarea_siguiente;			//definicion de puntero para tarea siguiente
@@ -154,6 +513,48 @@ struct _osControl  {
 typedef struct _osControl osControl;
 
 
+/********************************************************************************
+ * Definicion de la tabla de arranque precalculada en tiempo de compilacion
+ *
+ * Contiene el estado inicial de las estructuras del scheduler para un conjunto de
+ * tareas creadas estaticamente con OS_TAREA_INICIALIZADOR. Los arreglos por
+ * prioridad tienen OS_MAX_PRIORIDADES posiciones para no depender de MIN_PRIORITY.
+ *******************************************************************************/
+#define OS_MAX_PRIORIDADES	32			//maximo de prioridades que admite el mapa de bits
+
+struct _osTablaEstatica  {
+	tarea * const *listaTareas;					//tareas ordenadas por prioridad
+	uint16_t cantidad_Tareas;
+	uint16_t cantTareas_prioridad[OS_MAX_PRIORIDADES];
+	uint16_t inicioPrioridad[OS_MAX_PRIORIDADES];
+	uint32_t prioridadesListas;
+};
+typedef struct _osTablaEstatica osTablaEstatica;
+
+
+/********************************************************************************
+ * Inicializador de una tarea con el stack pintado y el stack frame inicial armado,
+ * equivalente a lo que hace os_InitTarea en tiempo de ejecucion. Se usa en la
+ * definicion de la propia tarea (task), que debe tener un id unico menor a
+ * MAX_TASK_COUNT. Requiere punteros de 32 bits.
+ *******************************************************************************/
+#define OS_TAREA_INICIALIZADOR(task, entryPoint, _id, _prioridad)  {					\
+	.stack = {																			\
+		[0 ... STACK_SIZE/4 - 1] = STACK_PATTERN,										\
+		[STACK_CANARY_POS] = STACK_CANARY,												\
+		[STACK_SIZE/4 - XPSR] = INIT_XPSR,												\
+		[STACK_SIZE/4 - PC_REG] = OS_DIRECCION(entryPoint),								\
+		[STACK_SIZE/4 - LR] = OS_DIRECCION(returnHook),									\
+		[STACK_SIZE/4 - LR_PREV_VALUE] = EXEC_RETURN									\
+	},																					\
+	.stack_pointer = OS_DIRECCION(&(task).stack[STACK_SIZE/4 - FULL_STACKING_SIZE]),	\
+	.entry_point = (entryPoint),														\
+	.id = (_id),																		\
+	.estado = TAREA_READY,																\
+	.prioridad = (_prioridad)															\
+}
+
+
 /*==================[definicion de prototipos]=================================*/
 
 void os_InitTarea(void *entryPoint, tarea *task, uint8_t prioridad);
@@ -165,10 +566,65 @@ void os_setEstadoSistema(estadoOS estado);
 void os_setScheduleDesdeISR(bool value);
 bool os_getScheduleDesdeISR(void);
 void os_setError(int32_t err, void* caller);
+void os_setWarning(int32_t warn);
 void os_CpuYield(void);
+uint32_t os_getStackLibre(tarea* task);
+void os_SetQuantum(uint8_t prioridad, uint16_t ticks);
+uint32_t os_getTicks(void);
+#if OS_EDF
+void os_SetDeadline(tarea* task, uint32_t ticks);
+#endif
+#if OS_PRESUPUESTOS
+void os_SetPresupuesto(tarea* task, uint32_t ticks, uint32_t periodo, accionPresupuesto accion);
+uint32_t os_getAgotamientos(tarea* task);
+#endif
+#if OS_MONITOR_PERIODICAS
+void os_SetPeriodica(tarea* task, uint32_t periodo, uint32_t deadline);
+void os_EsperarPeriodo(void);
+void os_getEstadisticasPeriodica(tarea* task, estadisticasPeriodica* destino);
+void os_ReiniciarEstadisticasPeriodica(tarea* task);
+#endif
+
+void os_BloquearTarea(tarea* task);
+void os_DesbloquearTarea(tarea* task);
+void os_DemorarTarea(tarea* task, uint32_t ticks);
+void os_CancelarDemora(tarea* task);
+
+void os_ListaEsperaInit(listaEspera* lista);
+void os_EsperarEnLista(listaEspera* lista);
+bool os_DespertarPrimera(listaEspera* lista);
+void os_DespertarTodas(listaEspera* lista);
+bool os_TrasladarPrimera(listaEspera* origen, listaEspera* destino);
+
+bool os_CreateTask(void *entryPoint, tarea *task, uint8_t prioridad);
+void os_DeleteTask(tarea* task);
+void os_Suspend(tarea* task);
+void os_Resume(tarea* task);
+void os_SetPriority(tarea* task, uint8_t prioridad);
+
+void os_PortEliminarTarea(tarea* task);
+void returnHook(void);
+
+void os_CargarTablaEstatica(const osTablaEstatica* tabla);
 
 void os_enter_critical(void);
 void os_exit_critical(void);
+#if OS_LATENCIA_IRQ
+uint32_t os_getSeccionCriticaMax(void);
+void os_ReiniciarSeccionCriticaMax(void);
+#endif
+#if OS_ESTADISTICAS
+uint16_t os_getCantidadTareas(void);
+tarea* os_getTarea(uint16_t indice);
+tarea* os_getTareaIdle(void);
+uint32_t os_getTicksEstadisticas(void);
+void os_ReiniciarEstadisticas(void);
+#endif
+#if OS_PERFIL_CRITICAS
+uint16_t os_getPerfilCriticas(perfilCritica* destino, uint16_t cantidad);
+uint32_t os_getSitiosDescartados(void);
+void os_ReiniciarPerfilCriticas(void);
+#endif
 
 
 
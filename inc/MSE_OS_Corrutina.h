@@ -0,0 +1,176 @@
+/*
+ * MSE_OS_Corrutina.h
+ *
+ *  Corrutinas sin stack y su ejecutor.
+ *
+ *  Cada tarea del OS necesita su stack y su estructura de control, por lo que no alcanza
+ *  para cientos de maquinas de estado concurrentes (por ejemplo sesiones de un protocolo).
+ *  Una corrutina es una funcion que se ejecuta hasta que tiene que esperar, retorna y la
+ *  proxima vez continua desde ese punto: el punto de reanudacion es un numero de linea
+ *  guardado en su estructura (un switch sobre __LINE__, al estilo de los protothreads), y
+ *  todas las corrutinas de un ejecutor comparten el stack de la tarea que lo corre. Una
+ *  corrutina ocupa solo su osCorrutina y los datos de la sesion.
+ *
+ *  Las corrutinas esperan con las macros OS_CO_*: datos en una cola, un semaforo, una
+ *  demora en ticks o una condicion cualquiera. Ninguna espera bloquea a la tarea: la
+ *  corrutina retorna al ejecutor, que corre las demas, y la tarea solo se bloquea cuando
+ *  ninguna corrutina puede avanzar, hasta la demora mas proxima o hasta que llega un dato
+ *  o un give a un objeto que alguna espera.
+ *
+ *  Reglas del cuerpo de una corrutina:
+ *  - las variables locales no se conservan entre esperas: el estado de la sesion va en la
+ *    memoria apuntada por co->datos (o en variables static)
+ *  - no puede llamar funciones que bloqueen (os_Delay, os_ColaRead, os_SemaforoTake, ...),
+ *    porque bloquearian a todas las corrutinas del ejecutor
+ *  - no puede haber dos macros OS_CO_* en la misma linea, ni una espera dentro de un
+ *    switch propio del cuerpo
+ *
+ *  Las colas y los semaforos que esperan las corrutinas no deben compartirse con tareas:
+ *  guardan una sola tarea en espera, y si una tarea ya esta bloqueada en el objeto el
+ *  ejecutor no la reemplaza (o una tarea que se bloquea despues reemplaza al ejecutor),
+ *  con lo que la corrutina solo ve el evento cuando el ejecutor despierta por otro motivo.
+ *
+ *  Ejemplo:
+ *
+ *    estadoCorrutina sesion(osCorrutina* co)  {
+ *        datosSesion* s = co->datos;
+ *
+ *        OS_CO_INICIO(co);
+ *        while (1)  {
+ *            OS_CO_LEER_COLA(co, &s->entrada, &s->paquete);
+ *            procesar(s);
+ *            OS_CO_DEMORAR(co, 5);
+ *        }
+ *        OS_CO_FIN(co);
+ *    }
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_CORRUTINA_H_
+#define MSE_OS_INC_MSE_OS_CORRUTINA_H_
+
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+
+
+#ifndef OS_EJECUTOR_SONDEO
+#define OS_EJECUTOR_SONDEO		1			//ticks maximos entre evaluaciones de OS_CO_ESPERAR_HASTA
+#endif
+
+
+enum _estadoCorrutina  {
+	CORRUTINA_ESPERANDO,
+	CORRUTINA_TERMINADA
+};
+
+typedef enum _estadoCorrutina estadoCorrutina;
+
+/*
+ * Que espera una corrutina, para que el ejecutor decida sin correrla si puede avanzar
+ */
+enum _esperaCorrutina  {
+	CO_ESPERA_NINGUNA,						//lista, por ejemplo luego de OS_CO_CEDER
+	CO_ESPERA_DEMORA,
+	CO_ESPERA_COLA,
+	CO_ESPERA_SEMAFORO,
+	CO_ESPERA_CONDICION						//se evalua en cada pasada del ejecutor
+};
+
+typedef enum _esperaCorrutina esperaCorrutina;
+
+
+/********************************************************************************
+ * Definicion de la estructura de una corrutina
+ *
+ * La memoria la provee el usuario y se entrega al ejecutor con
+ * os_EjecutorAgregar. Al terminar (OS_CO_FIN) el ejecutor la quita y puede
+ * volver a agregarse.
+ *******************************************************************************/
+struct _corrutina  {
+	estadoCorrutina (*cuerpo)(struct _corrutina* co);
+	void* datos;								//datos de la sesion, para el cuerpo
+	void* objeto;								//cola o semaforo que espera
+	uint32_t vencimiento;						//tick en que vence la demora
+	uint16_t punto;								//linea donde continua, 0 al inicio
+	uint8_t espera;								//esperaCorrutina
+	struct _corrutina* siguiente;
+};
+
+typedef struct _corrutina osCorrutina;
+
+typedef estadoCorrutina (*cuerpoCorrutina)(osCorrutina* co);
+
+
+/********************************************************************************
+ * Definicion de la estructura del ejecutor
+ *
+ * Un ejecutor corre en una sola tarea, que llama a os_EjecutorCorrer y no
+ * vuelve. Las corrutinas pueden agregarse desde cualquier tarea, o desde otra
+ * corrutina (por ejemplo una que acepta conexiones y crea una sesion por cada
+ * una).
+ *******************************************************************************/
+struct _ejecutor  {
+	osCorrutina* primera;
+	tarea* tarea_ejecutor;						//tarea que lo corre, NULL antes de correr
+	uint16_t cantidad;							//corrutinas sin terminar
+	bool aviso;									//os_EjecutorAvisar pendiente
+};
+
+typedef struct _ejecutor osEjecutor;
+
+
+/*
+ * Macros del cuerpo de una corrutina. Cada espera guarda la linea como punto de
+ * reanudacion y retorna; al volver a correr el switch de OS_CO_INICIO salta al case de
+ * esa linea y reevalua la condicion
+ */
+#define OS_CO_INICIO(co)		switch ((co)->punto)  { case 0:
+
+#define OS_CO_FIN(co)			}										\
+								(co)->punto = 0;						\
+								return CORRUTINA_TERMINADA
+
+#define OS_CO_ESPERAR(co, tipo, obj, condicion)							\
+	do  {																\
+		(co)->espera = (tipo);											\
+		(co)->objeto = (obj);											\
+		(co)->punto = __LINE__;											\
+	case __LINE__:														\
+		if (!(condicion))												\
+			return CORRUTINA_ESPERANDO;									\
+		(co)->espera = CO_ESPERA_NINGUNA;								\
+	} while (0)
+
+#define OS_CO_ESPERAR_HASTA(co, condicion)								\
+	OS_CO_ESPERAR(co, CO_ESPERA_CONDICION, NULL, condicion)
+
+#define OS_CO_LEER_COLA(co, cola, dato)									\
+	OS_CO_ESPERAR(co, CO_ESPERA_COLA, cola, os_ColaReadSinEspera(cola, dato))
+
+#define OS_CO_TOMAR_SEMAFORO(co, sem)									\
+	OS_CO_ESPERAR(co, CO_ESPERA_SEMAFORO, sem, os_SemaforoTakeSinEspera(sem))
+
+#define OS_CO_DEMORAR(co, ticks)										\
+	do  {																\
+		(co)->vencimiento = os_getTicks() + (ticks);					\
+		OS_CO_ESPERAR(co, CO_ESPERA_DEMORA, NULL,						\
+				(int32_t) (os_getTicks() - (co)->vencimiento) >= 0);	\
+	} while (0)
+
+#define OS_CO_CEDER(co)													\
+	do  {																\
+		(co)->espera = CO_ESPERA_NINGUNA;								\
+		(co)->punto = __LINE__;											\
+		return CORRUTINA_ESPERANDO;										\
+	case __LINE__:;														\
+	} while (0)
+
+
+void os_EjecutorInit(osEjecutor* ejecutor);
+void os_EjecutorAgregar(osEjecutor* ejecutor, osCorrutina* co, cuerpoCorrutina cuerpo, void* datos);
+void os_EjecutorAvisar(osEjecutor* ejecutor);
+void os_EjecutorCorrer(osEjecutor* ejecutor);
+uint16_t os_EjecutorCantidad(osEjecutor* ejecutor);
+
+
+#endif /* MSE_OS_INC_MSE_OS_CORRUTINA_H_ */
@@ -0,0 +1,27 @@
+/*
+ * MSE_OS_DMA.h
+ *
+ *  Despachador de las interrupciones del GPDMA. Los ocho canales comparten la
+ *  interrupcion DMA_IRQn, por lo que los drivers que usan DMA reservan un canal con
+ *  os_DMAReservarCanal y reciben el fin de cada transferencia en un callback, que se
+ *  ejecuta en modo handler a traves de la capa de interrupciones del OS (y puede usar
+ *  la API desde ISR).
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_DMA_H_
+#define MSE_OS_INC_MSE_OS_DMA_H_
+
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_IRQ.h"
+#include "board.h"
+
+
+#define OS_DMA_CANALES			GPDMA_NUMBER_CHANNELS
+
+
+bool os_DMAReservarCanal(uint32_t conexion, void (*callback)(void*), void* contexto, uint8_t* canal);
+void os_DMALiberarCanal(uint8_t canal);
+
+
+#endif /* MSE_OS_INC_MSE_OS_DMA_H_ */
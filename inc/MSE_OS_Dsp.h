@@ -0,0 +1,40 @@
+/*
+ * MSE_OS_Dsp.h
+ *
+ *  Filtros para procesar bloques de muestras, escritos con las instrucciones SIMD del
+ *  Cortex-M4: __SMLALD multiplica dos pares de muestras de 16 bits y acumula ambos
+ *  productos en 64 bits en una sola instruccion, con lo que un FIR de N coeficientes
+ *  cuesta unas N/2 instrucciones de multiplicacion por muestra.
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_DSP_H_
+#define MSE_OS_INC_MSE_OS_DSP_H_
+
+
+#include <stdint.h>
+#include "board.h"
+
+
+/********************************************************************************
+ * Definicion de la estructura de un filtro FIR en Q15
+ *
+ * Igual que en CMSIS-DSP, los coeficientes van en orden inverso (h[N-1] primero). La
+ * cantidad de coeficientes debe ser par (se completa con un cero si hace falta) y el
+ * estado debe tener lugar para cant_coeficientes - 1 + tam_bloque muestras.
+ *******************************************************************************/
+struct _firQ15  {
+	const int16_t* coeficientes;
+	uint16_t cant_coeficientes;
+	int16_t* estado;
+	uint16_t tam_bloque;
+};
+
+typedef struct _firQ15 osFirQ15;
+
+
+void os_FirQ15Init(osFirQ15* fir, const int16_t* coeficientes, uint16_t cant_coeficientes,
+		int16_t* estado, uint16_t tam_bloque);
+void os_FirQ15(osFirQ15* fir, const int16_t* entrada, int16_t* salida, uint16_t cantidad);
+
+
+#endif /* MSE_OS_INC_MSE_OS_DSP_H_ */
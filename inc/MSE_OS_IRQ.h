@@ -18,8 +18,39 @@
 
 extern osControl g_sControl_OS;
 
+
+#if OS_LATENCIA_IRQ
+/********************************************************************************
+ * Estadisticas de latencia de una IRQ (ver OS_LATENCIA_IRQ en MSE_OS_Core.h).
+ * La posicion 0 del histograma cuenta latencias de 0 ciclos y la posicion n las de
+ * 2^(n-1) a 2^n - 1 ciclos; la ultima acumula las mayores. La diferencia entre la
+ * latencia maxima y la minima es el jitter de atencion.
+ *******************************************************************************/
+struct _estadisticasIRQ  {
+	uint32_t atenciones;						//atenciones medidas
+	uint32_t latencia_min;						//ciclos desde el evento hasta la funcion del usuario
+	uint32_t latencia_max;
+	uint64_t latencia_suma;						//para el promedio
+	uint32_t histograma[OS_CANT_HIST_LATENCIA];
+	uint32_t duracion_max;						//ciclos de la funcion del usuario
+};
+typedef struct _estadisticasIRQ estadisticasIRQ;
+
+/*
+ * Devuelve los ciclos transcurridos desde el evento de hardware que produjo la
+ * interrupcion, por ejemplo la cuenta del timer que la genero desde el match
+ */
+typedef uint32_t (*osReferenciaIRQ)(void);
+#endif
+
+
 bool os_InstalarIRQ(LPC43XX_IRQn_Type irq, void* usr_isr);
 bool os_RemoverIRQ(LPC43XX_IRQn_Type irq);
+#if OS_LATENCIA_IRQ
+bool os_SetReferenciaIRQ(LPC43XX_IRQn_Type irq, osReferenciaIRQ referencia);
+bool os_getEstadisticasIRQ(LPC43XX_IRQn_Type irq, estadisticasIRQ* destino);
+void os_ReiniciarEstadisticasIRQ(LPC43XX_IRQn_Type irq);
+#endif
 
 
 #endif /* MSE_OS_INC_MSE_OS_IRQ_H_ */
@@ -0,0 +1,125 @@
+/*
+ * MSE_OS_Log.h
+ *
+ *  Log binario diferido.
+ *
+ *  Las tareas y los handlers no arman texto: os_Log0 ... os_Log4 guardan en un buffer
+ *  circular solo el id del mensaje (declarado en mensajes_log.def), el tick y los
+ *  argumentos crudos, con lo que registrar un mensaje cuesta unas decenas de ciclos. El
+ *  buffer no usa secciones criticas: cada registro reserva su lugar con una operacion
+ *  atomica (LDREX/STREX) y se publica al escribir su cabecera, por lo que un handler puede
+ *  registrar aun si interrumpe a una tarea en medio de otro registro.
+ *
+ *  El formato se aplica despues, en una tarea de la menor prioridad (os_LogTarea) que
+ *  vacia el buffer con os_LogVaciar y entrega el texto a la salida configurada. Con
+ *  OS_LOG_CRUDO en 1 el firmware no formatea ni incluye los formatos: entrega los
+ *  registros binarios y el decodificador de host tools/logdec los imprime.
+ *
+ *  Con el formato en el firmware la tarea que vacia el log usa snprintf, que segun la
+ *  biblioteca C necesita varios cientos de bytes de stack: con el STACK_SIZE por defecto
+ *  (256 bytes) desborda. La linea y la copia del registro son estaticas, por lo que se
+ *  debe compilar con OS_LOG_STACK_MINIMO o mas (-DSTACK_SIZE=1024) y confirmarlo con
+ *  os_getStackLibre o con la prueba pila_log del firmware de QEMU. Con OS_LOG_CRUDO
+ *  alcanza el stack por defecto.
+ *
+ *  Formato de un registro, en palabras de 32 bits:
+ *
+ *    cabecera: bit 31 en 1, cantidad de argumentos en los bits 16 a 23, id en los bits 0 a 15
+ *    tick del sistema
+ *    argumentos (0 a OS_LOG_MAX_ARGS)
+ *
+ *  La primera parte de este header no depende del OS para que pueda compilarse en el
+ *  host (definiendo OS_LOG_HOST).
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_LOG_H_
+#define MSE_OS_INC_MSE_OS_LOG_H_
+
+#include <stdint.h>
+
+
+#define OS_LOG_MAX_ARGS					4
+#define OS_LOG_PALABRAS_CABECERA		2			//cabecera y tick
+
+#define OS_LOG_VALIDO					(1UL << 31)
+#define OS_LOG_CABECERA(id, cant)		(OS_LOG_VALIDO | ((uint32_t) (cant) << 16) | (uint32_t) (id))
+#define OS_LOG_ID(cabecera)				((cabecera) & 0xFFFF)
+#define OS_LOG_CANT_ARGS(cabecera)		(((cabecera) >> 16) & 0xFF)
+#define OS_LOG_RESERVADO(cabecera)		((cabecera) & 0x7F000000)	//siempre en 0
+
+#define OS_LOG_FORMATO_PERDIDOS			"%u registros perdidos por buffer lleno"
+
+/*
+ * El id 0 lo usa el OS para informar los registros descartados
+ */
+enum _idLog  {
+	LOG_PERDIDOS,
+#define OS_LOG_MENSAJE(nombre, formato)		LOG_##nombre,
+#include "mensajes_log.def"
+	OS_LOG_CANT_MENSAJES
+};
+
+
+#ifndef OS_LOG_HOST
+
+#include "MSE_OS_Core.h"
+
+
+#ifndef OS_LOG_PALABRAS
+#define OS_LOG_PALABRAS			256			//tamaño del buffer en palabras, potencia de 2
+#endif
+
+#ifndef OS_LOG_CRUDO
+#define OS_LOG_CRUDO			0			//1: entrega los registros sin formatear, para tools/logdec
+#endif
+
+#ifndef OS_LOG_PERIODO_VACIADO
+#define OS_LOG_PERIODO_VACIADO	10			//ticks entre vaciados de os_LogTarea
+#endif
+
+#define OS_LOG_TAM_LINEA		96			//tamaño maximo de una linea formateada
+
+#define OS_LOG_STACK_MINIMO		1024		//STACK_SIZE recomendado sin OS_LOG_CRUDO (newlib)
+
+#if (OS_LOG_PALABRAS & (OS_LOG_PALABRAS - 1)) != 0
+#error "OS_LOG_PALABRAS debe ser potencia de 2"
+#endif
+
+
+/*
+ * Recibe cada linea formateada o cada registro crudo. Se llama desde la tarea que vacia
+ * el log, por lo que puede bloquearse (por ejemplo con os_UartTxWrite)
+ */
+typedef void (*osLogSalida)(const void* datos, uint16_t cantidad);
+
+
+void os_LogInit(osLogSalida salida);
+void os_LogRegistrar(uint32_t cabecera, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+uint16_t os_LogVaciar(void);
+uint32_t os_LogPerdidos(void);
+void os_LogTarea(void);
+
+
+static inline void os_Log0(uint16_t id)  {
+	os_LogRegistrar(OS_LOG_CABECERA(id, 0), 0, 0, 0, 0);
+}
+
+static inline void os_Log1(uint16_t id, uint32_t arg0)  {
+	os_LogRegistrar(OS_LOG_CABECERA(id, 1), arg0, 0, 0, 0);
+}
+
+static inline void os_Log2(uint16_t id, uint32_t arg0, uint32_t arg1)  {
+	os_LogRegistrar(OS_LOG_CABECERA(id, 2), arg0, arg1, 0, 0);
+}
+
+static inline void os_Log3(uint16_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2)  {
+	os_LogRegistrar(OS_LOG_CABECERA(id, 3), arg0, arg1, arg2, 0);
+}
+
+static inline void os_Log4(uint16_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3)  {
+	os_LogRegistrar(OS_LOG_CABECERA(id, 4), arg0, arg1, arg2, arg3);
+}
+
+#endif
+
+#endif /* MSE_OS_INC_MSE_OS_LOG_H_ */
@@ -0,0 +1,50 @@
+/*
+ * MSE_OS_Shell.h
+ *
+ *  Shell de diagnostico por UART.
+ *
+ *  Una tarea de la menor prioridad recibe comandos por los drivers de MSE_OS_Uart.c y
+ *  responde con el estado del OS, sin interferir con las tareas de tiempo real: solo
+ *  corre cuando no hay otra tarea lista, se despierta con cada linea recibida (el
+ *  delimitador del receptor) y usa memoria fija, una linea de entrada y una de salida.
+ *  Los comandos son:
+ *
+ *    tareas     estado, prioridad, % de CPU, stack libre y cambios de contexto de cada tarea
+ *    objetos    semaforos, colas y stream buffers declarados en tareas.def
+ *    reset      reinicia las estadisticas de las tareas
+ *    ayuda      lista los comandos
+ *
+ *  Solo se compila con OS_ESTADISTICAS en 1. Los nombres de las tareas y los objetos se
+ *  toman de tareas.def; las tareas que no estan en la tabla se muestran por su id.
+ *
+ *  Las respuestas se arman con vsnprintf, que segun la biblioteca C usa varios cientos de
+ *  bytes de stack: con el STACK_SIZE por defecto (256 bytes) la tarea del shell desborda.
+ *  Las lineas de entrada y de salida son estaticas, por lo que el stack que necesita es
+ *  el de vsnprintf mas el de las funciones del shell y el contexto guardado. Se debe compilar con
+ *  OS_SHELL_STACK_MINIMO o mas (-DSTACK_SIZE=1024) y confirmarlo con la columna de stack
+ *  libre del propio comando tareas, o con la prueba pila_shell del firmware de QEMU.
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_SHELL_H_
+#define MSE_OS_INC_MSE_OS_SHELL_H_
+
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_Uart.h"
+
+
+#ifndef OS_SHELL_TAM_LINEA
+#define OS_SHELL_TAM_LINEA		48			//largo maximo de un comando
+#endif
+
+#define OS_SHELL_TAM_SALIDA		80			//largo maximo de una linea de respuesta
+
+#define OS_SHELL_STACK_MINIMO	1024		//STACK_SIZE recomendado con el shell (newlib)
+
+
+void os_ShellInit(osUartRx* rx, osUartTx* tx);
+void os_ShellTarea(void);
+
+
+#endif /* MSE_OS_INC_MSE_OS_SHELL_H_ */
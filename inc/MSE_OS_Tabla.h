@@ -0,0 +1,80 @@
+/*
+ * MSE_OS_Tabla.h
+ *
+ *  Tabla estatica de tareas y objetos de la aplicacion.
+ *
+ *  Las tareas, semaforos, colas y stream buffers se declaran una sola vez en tareas.def
+ *  con las macros
+ *
+ *    OS_TAREA(nombre, entry_point, prioridad, periodo_us, wcet_us, deadline_us)
+ *    OS_SEMAFORO(nombre)
+ *    OS_COLA(nombre, tam_elemento)
+ *    OS_STREAM_BUFFER(nombre, tamanio, nivel_disparo)
+ *
+ *  y esa misma tabla la leen el firmware (MSE_OS_Tabla.c define g_s<nombre>,
+ *  sem<nombre>, cola<nombre> y stream<nombre> ya inicializados) y la herramienta tools/rta, que hace el
+ *  analisis de tiempo de respuesta y genera tareas_rta.h con la lista de tareas ordenada
+ *  por prioridad y el hash de la tabla analizada. Las tareas esporadicas (las que
+ *  esperan un semaforo o una cola) declaran como periodo su tiempo minimo entre
+ *  activaciones.
+ *
+ *  Este header no depende del OS para que pueda compilarse en el host; el firmware
+ *  debe incluir MSE_OS_Core.h y MSE_OS_API.h antes que este archivo.
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_TABLA_H_
+#define MSE_OS_INC_MSE_OS_TABLA_H_
+
+#include <stdint.h>
+
+
+#ifndef OS_US_POR_TICK
+#define OS_US_POR_TICK			1000		//microsegundos por tick de sistema
+#endif
+
+#ifndef OS_MAX_PRIORIDADES
+#define OS_MAX_PRIORIDADES		32			//igual que en MSE_OS_Core.h, para el host
+#endif
+
+#define OS_TABLA_HASH_INICIAL	2166136261UL	//base de FNV-1a de 32 bits
+#define OS_TABLA_HASH_PRIMO		16777619UL
+
+
+/*************************************************************************************************
+	 *  @brief Agrega un valor al hash de la tabla de tareas.
+     *
+     *  @details
+     *   FNV-1a de 32 bits sobre los cuatro bytes del valor, del menos significativo al mas
+     *   significativo, con lo que el resultado es el mismo en el host y en el firmware sin
+     *   importar el endianness.
+     *
+	 *  @param hash		Hash acumulado
+	 *  @param valor	Valor a agregar
+	 *  @return     Nuevo hash.
+***************************************************************************************************/
+static inline uint32_t os_TablaHash(uint32_t hash, uint32_t valor)  {
+	for (uint8_t i = 0; i < 4; i++)  {
+		hash ^= (valor >> (8 * i)) & 0xFF;
+		hash *= OS_TABLA_HASH_PRIMO;
+	}
+
+	return hash;
+}
+
+
+#ifndef OS_TABLA_HOST
+
+/*
+ * Declaracion de las tareas y objetos de la tabla, definidos en MSE_OS_Tabla.c
+ */
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	extern tarea g_s##nombre;
+#define OS_SEMAFORO(nombre)		extern osSemaforo sem##nombre;
+#define OS_COLA(nombre, tam_elemento)	extern osCola cola##nombre;
+#define OS_STREAM_BUFFER(nombre, tamanio, nivel_disparo)	extern osStreamBuffer stream##nombre;
+#include "tareas.def"
+
+void os_InitTablaTareas(void);
+
+#endif
+
+#endif /* MSE_OS_INC_MSE_OS_TABLA_H_ */
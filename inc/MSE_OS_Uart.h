@@ -0,0 +1,90 @@
+/*
+ * MSE_OS_Uart.h
+ *
+ *  Drivers de transmision y recepcion por UART integrados al OS.
+ *
+ *  Transmision:
+ *  Las tareas escriben en un stream buffer propio del driver y el GPDMA transmite
+ *  directamente desde esa memoria, sin copias intermedias: cada transferencia toma el
+ *  bloque contiguo pendiente (os_StreamBufferLeerBloque) y lo libera al terminar, desde
+ *  el handler de DMA_IRQn, que en el mismo momento lanza la transferencia siguiente. El
+ *  procesador solo interviene una vez por bloque y no por caracter, y la tarea que
+ *  escribe solo se bloquea mientras el buffer esta lleno.
+ *
+ *  Recepcion:
+ *  El handler de la UART vacia la FIFO de recepcion directamente en un stream buffer
+ *  (os_StreamBufferReservarBloque), con la FIFO configurada para interrumpir cada
+ *  OS_UART_RX_NIVEL_FIFO bytes y no en cada caracter. La tarea lectora no despierta por
+ *  cada interrupcion sino cuando se alcanza el umbral, cuando llega el delimitador
+ *  configurado o cuando la linea queda inactiva, que detecta la propia UART con la
+ *  interrupcion de timeout de caracter (unos 4 caracteres sin datos nuevos).
+ */
+
+#ifndef MSE_OS_INC_MSE_OS_UART_H_
+#define MSE_OS_INC_MSE_OS_UART_H_
+
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_DMA.h"
+
+
+#define OS_UART_DMA_MAX			4095		//maximo de bytes por transferencia del GPDMA
+
+#ifndef OS_UART_RX_NIVEL_FIFO
+#define OS_UART_RX_NIVEL_FIFO	UART_FCR_TRG_LEV2	//interrupcion de recepcion cada 8 bytes
+#endif
+
+/*
+ * FCR es de solo escritura, por lo que los drivers de transmision y recepcion de una
+ * misma UART escriben el mismo valor
+ */
+#define OS_UART_FCR				(UART_FCR_FIFO_EN | UART_FCR_DMAMODE_SEL | OS_UART_RX_NIVEL_FIFO)
+
+#define OS_UART_SIN_DELIMITADOR	(-1)
+#define OS_UART_RX_CANT			4					//UARTs del LPC43xx
+
+
+/********************************************************************************
+ * Definicion de la estructura del driver de transmision
+ *******************************************************************************/
+struct _uartTx  {
+	osStreamBuffer stream;
+	LPC_USART_T* uart;
+	uint32_t conexion_dma;					//GPDMA_CONN_UARTn_Tx
+	uint8_t canal_dma;
+	uint16_t bytes_en_curso;				//bytes de la transferencia en curso, 0 si el DMA esta detenido
+	uint32_t bytes_enviados;
+	uint32_t transferencias;
+};
+
+typedef struct _uartTx osUartTx;
+
+
+/********************************************************************************
+ * Definicion de la estructura del driver de recepcion
+ *******************************************************************************/
+struct _uartRx  {
+	osStreamBuffer stream;					//su nivel de disparo es el umbral de la lectora
+	LPC_USART_T* uart;
+	int16_t delimitador;					//OS_UART_SIN_DELIMITADOR si no se usa
+	uint32_t bytes_recibidos;
+	uint32_t bytes_perdidos;				//llegaron con el buffer lleno
+	uint32_t errores_linea;					//overrun, paridad, framing o break
+	uint32_t interrupciones;
+};
+
+typedef struct _uartRx osUartRx;
+
+
+bool os_UartTxInit(osUartTx* tx, LPC_USART_T* uart, uint32_t conexion_dma, uint8_t* memoria, uint16_t tamanio);
+uint16_t os_UartTxWrite(osUartTx* tx, const void* datos, uint16_t cantidad);
+uint16_t os_UartTxPendientes(osUartTx* tx);
+
+bool os_UartRxInit(osUartRx* rx, LPC_USART_T* uart, LPC43XX_IRQn_Type irq, uint8_t* memoria,
+		uint16_t tamanio, uint16_t umbral);
+void os_UartRxSetDelimitador(osUartRx* rx, int16_t delimitador);
+uint16_t os_UartRxRead(osUartRx* rx, void* destino, uint16_t maximo);
+
+
+#endif /* MSE_OS_INC_MSE_OS_UART_H_ */
@@ -0,0 +1,24 @@
+/*
+ * tareas_rta.h
+ *
+ *  Generado por tools/rta a partir de tareas.def. No editar.
+ *
+ *  EncenderLed      R = 400 us
+ *  ApagarLed        R = 400 us
+ */
+
+#ifndef MSE_OS_INC_TAREAS_RTA_H_
+#define MSE_OS_INC_TAREAS_RTA_H_
+
+#define OS_TABLA_HASH			0xECCE1D2EUL
+#define OS_TABLA_PLANIFICABLE	1
+
+#define OS_TABLA_CANT_TAREAS	2
+#define OS_TABLA_PRIORIDAD_MAX	0
+#define OS_TABLA_PRIORIDADES	0x00000001UL
+
+#define OS_TABLA_LISTA	{ &g_sEncenderLed, &g_sApagarLed }
+#define OS_TABLA_CANT_PRIORIDAD	{ 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }
+#define OS_TABLA_INICIO_PRIORIDAD	{ 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 }
+
+#endif /* MSE_OS_INC_TAREAS_RTA_H_ */
@@ -0,0 +1,598 @@
+/*
+ * MSE_OS_Chip.c (port POSIX)
+ *
+ *  Emulacion de los perifericos del LPC43xx que usan los drivers del OS, con la misma
+ *  interfaz de LPCOpen, para poder probar los drivers en una PC sin modificaciones.
+ *
+ *  - Cada canal del GPDMA es un hilo del host que recorre la lista de descriptores de la
+ *    transferencia. Una transferencia de memoria a la UART
+ *    tarda lo que tardaria en salir por la linea (10 bits por byte al baudrate
+ *    configurado) y recien al final se leen los datos de la memoria de origen, con lo
+ *    que un driver que libere el buffer antes de tiempo transmite datos pisados. Al
+ *    terminar se marca la interrupcion de fin de transferencia del canal y se genera
+ *    DMA_IRQn. Una transferencia desde el ADC escribe las muestras al ritmo de la
+ *    frecuencia de muestreo.
+ *  - La UART no emula registros: guarda la configuracion y entrega los bytes
+ *    transmitidos a la funcion de salida configurada con os_PortUartSalida (si no hay
+ *    ninguna se descartan).
+ *  - La recepcion la genera un hilo del host con os_PortUartRecibir, que entrega los
+ *    bytes a la FIFO de 16 bytes al ritmo del baudrate. Igual que en el LPC43xx, hay
+ *    interrupcion cuando la FIFO alcanza el nivel configurado en FCR, y timeout de
+ *    caracter si quedan datos y no llega ninguno durante 4 caracteres. Los bytes que
+ *    llegan con la FIFO llena se pierden y marcan overrun.
+ *
+ *  Se compila junto con MSE_OS_Port.c.
+ */
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/prctl.h>
+
+#include "MSE_OS_Port.h"
+
+
+#define BAUDIOS_POR_DEFECTO		115200
+#define BITS_POR_BYTE			10				//start, 8 datos y stop
+
+
+/*==================[definicion de datos del port]=================================*/
+
+struct _canalEmulado  {
+	bool reservado;
+	bool iniciado;								//el hilo del canal fue creado
+	volatile bool activo;						//equivalente al bit Enable de DMACCxConfig
+	volatile bool fin_transferencia;			//equivalente al bit de IntTCStat del canal
+	DMA_TransferDescriptor_t primero;			//primer descriptor de la transferencia
+	GPDMA_FLOW_CONTROL_T tipo;
+	sem_t inicio;
+	pthread_t hilo;
+};
+
+typedef struct _canalEmulado canalEmulado;
+
+
+#define CARACTERES_TIMEOUT		4				//caracteres sin datos para el timeout de la FIFO
+#define ESPERA_INTERRUPCION_NS	20000			//sondeo del DMA mientras espera que se atienda su interrupcion
+
+
+LPC_USART_T os_PortUSART[4] = {
+	{ .baudios = BAUDIOS_POR_DEFECTO, .irq = USART0_IRQn },
+	{ .baudios = BAUDIOS_POR_DEFECTO, .irq = UART1_IRQn },
+	{ .baudios = BAUDIOS_POR_DEFECTO, .irq = USART2_IRQn },
+	{ .baudios = BAUDIOS_POR_DEFECTO, .irq = USART3_IRQn }
+};
+
+/*
+ * Bytes de la FIFO de recepcion que generan interrupcion segun UART_FCR_TRG_LEVn
+ */
+static const uint32_t nivelesFIFO[4] = { 1, 4, 8, 14 };
+
+LPC_GPDMA_T os_PortGPDMA;
+LPC_ADC_T os_PortADC[2];
+
+static canalEmulado canalesDMA[GPDMA_NUMBER_CHANNELS];
+
+
+/*==================[definicion de prototipos static]=================================*/
+static void* hiloCanal(void* arg);
+static void esperarAtencion(canalEmulado* canal);
+static void ejecutarDescriptor(const DMA_TransferDescriptor_t* descriptor, GPDMA_FLOW_CONTROL_T tipo,
+		uint64_t* proximo);
+static LPC_USART_T* uartDeConexion(uintptr_t conexion);
+static LPC_ADC_T* adcDeConexion(uintptr_t conexion);
+static void esperarBytes(LPC_USART_T* uart, uint32_t cantidad);
+static uint32_t bytesFIFO(LPC_USART_T* uart);
+static uint64_t nsCaracter(LPC_USART_T* uart);
+static uint64_t ahoraNs(void);
+static void esperarHasta(uint64_t ns);
+
+
+
+/*==================[UART]=================================*/
+
+void Chip_UART_SetupFIFOS(LPC_USART_T* pUART, uint32_t fcr)  {
+	pUART->FCR = fcr;
+}
+
+
+uint32_t Chip_UART_SetBaud(LPC_USART_T* pUART, uint32_t baudrate)  {
+	pUART->baudios = baudrate;
+	return baudrate;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Configura a donde van los bytes transmitidos por una UART emulada.
+     *
+     *  @details
+     *   La funcion se llama desde el hilo del host que emula el DMA, no desde el OS, por lo
+     *   que no puede usar la API del OS.
+     *
+	 *  @param		uart		UART emulada (LPC_USARTn)
+	 *  @param		salida		Funcion que recibe los bytes transmitidos, NULL para descartarlos
+	 *  @return     None.
+***************************************************************************************************/
+void os_PortUartSalida(LPC_USART_T* uart, void (*salida)(const uint8_t* datos, uint32_t cantidad))  {
+	uart->salida = salida;
+}
+
+
+void Chip_UART_IntEnable(LPC_USART_T* pUART, uint32_t intMask)  {
+	__atomic_fetch_or(&pUART->IER, intMask, __ATOMIC_SEQ_CST);
+}
+
+
+void Chip_UART_IntDisable(LPC_USART_T* pUART, uint32_t intMask)  {
+	__atomic_fetch_and(&pUART->IER, ~intMask, __ATOMIC_SEQ_CST);
+}
+
+
+/*
+ * Interrupcion pendiente de mayor prioridad, igual que el registro IIR: errores de linea,
+ * FIFO en nivel y timeout de caracter
+ */
+uint32_t Chip_UART_ReadIntIDReg(LPC_USART_T* pUART)  {
+	uint32_t ier = __atomic_load_n(&pUART->IER, __ATOMIC_SEQ_CST);
+	uint32_t nivel = nivelesFIFO[(pUART->FCR >> 6) & 0x3];
+
+	if ((ier & UART_IER_RLSINT) && __atomic_load_n(&pUART->lsr_errores, __ATOMIC_SEQ_CST))
+		return UART_IIR_INTID_RLS;
+
+	if ((ier & UART_IER_RBRINT) && bytesFIFO(pUART) >= nivel)
+		return UART_IIR_INTID_RDA;
+
+	if ((ier & UART_IER_RBRINT) && __atomic_load_n(&pUART->timeout_caracter, __ATOMIC_SEQ_CST))
+		return UART_IIR_INTID_CTI;
+
+	return UART_IIR_INTSTAT_PEND;
+}
+
+
+/*
+ * Igual que LSR, la lectura limpia los bits de error
+ */
+uint32_t Chip_UART_ReadLineStatus(LPC_USART_T* pUART)  {
+	uint32_t lsr = __atomic_exchange_n(&pUART->lsr_errores, 0, __ATOMIC_SEQ_CST);
+
+	if (bytesFIFO(pUART) > 0)
+		lsr |= UART_LSR_RDR;
+
+	return lsr;
+}
+
+
+/*
+ * Leer un byte de la FIFO limpia el timeout de caracter
+ */
+uint8_t Chip_UART_ReadByte(LPC_USART_T* pUART)  {
+	uint32_t leidos = __atomic_load_n(&pUART->rx_leidos, __ATOMIC_SEQ_CST);
+	uint8_t dato = 0;
+
+	__atomic_store_n(&pUART->timeout_caracter, false, __ATOMIC_SEQ_CST);
+
+	if (bytesFIFO(pUART) > 0)  {
+		dato = pUART->fifo_rx[leidos % UART_RX_FIFO_TAM];
+		__atomic_store_n(&pUART->rx_leidos, leidos + 1, __ATOMIC_SEQ_CST);
+	}
+
+	return dato;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Recibe bytes por una UART emulada.
+     *
+     *  @details
+     *   Debe llamarse desde un hilo del host con SIGALRM y SIGUSR1 bloqueadas, que hace las
+     *   veces del otro extremo de la linea: la funcion entrega los bytes a la FIFO al ritmo
+     *   del baudrate configurado, genera la interrupcion de la UART cada vez que la FIFO
+     *   alcanza su nivel y, al terminar, la de timeout de caracter si quedaron datos.
+     *   Vuelve cuando la linea queda inactiva.
+     *
+	 *  @param		uart		UART emulada (LPC_USARTn)
+	 *  @param		datos		Bytes a recibir
+	 *  @param		cantidad	Cantidad de bytes
+	 *  @return     None.
+***************************************************************************************************/
+void os_PortUartRecibir(LPC_USART_T* uart, const uint8_t* datos, uint32_t cantidad)  {
+	uint64_t caracter = nsCaracter(uart);
+	uint64_t proximo, ahora;
+	uint32_t escritos;
+
+	prctl(PR_SET_TIMERSLACK, 1UL, 0, 0, 0);
+	proximo = ahoraNs() + caracter;
+
+	for (uint32_t i = 0; i < cantidad; i++)  {
+		/*
+		 * Si el host demoro este hilo, el byte llega tarde (la linea hizo una pausa) en
+		 * lugar de entregar de golpe los atrasados: eso seria recibir mas rapido que el
+		 * baudrate y desbordaria la FIFO sin que sea culpa del driver
+		 */
+		esperarHasta(proximo);
+		ahora = ahoraNs();
+		proximo = (ahora > proximo ? ahora : proximo) + caracter;
+
+		if (bytesFIFO(uart) >= UART_RX_FIFO_TAM)  {
+			__atomic_fetch_or(&uart->lsr_errores, UART_LSR_OE, __ATOMIC_SEQ_CST);
+		}
+		else  {
+			escritos = __atomic_load_n(&uart->rx_escritos, __ATOMIC_SEQ_CST);
+			uart->fifo_rx[escritos % UART_RX_FIFO_TAM] = datos[i];
+			__atomic_store_n(&uart->rx_escritos, escritos + 1, __ATOMIC_SEQ_CST);
+		}
+
+		if (Chip_UART_ReadIntIDReg(uart) != UART_IIR_INTSTAT_PEND)
+			os_PortDispararIRQ(uart->irq);
+	}
+
+	esperarHasta(proximo + (CARACTERES_TIMEOUT - 1) * caracter);
+
+	if (bytesFIFO(uart) > 0)  {
+		__atomic_store_n(&uart->timeout_caracter, true, __ATOMIC_SEQ_CST);
+		os_PortDispararIRQ(uart->irq);
+	}
+}
+
+
+
+/*==================[ADC]=================================*/
+
+void Chip_ADC_Init(LPC_ADC_T* pADC, ADC_CLOCK_SETUP_T* ADCSetup)  {
+	pADC->frecuencia = 400000;
+	pADC->canales = 0;
+	pADC->burst = false;
+
+	ADCSetup->adcRate = 400000;
+	ADCSetup->bitsAccuracy = 10;
+	ADCSetup->burstMode = false;
+}
+
+
+void Chip_ADC_SetSampleRate(LPC_ADC_T* pADC, ADC_CLOCK_SETUP_T* ADCSetup, uint32_t rate)  {
+	ADCSetup->adcRate = rate;
+	pADC->frecuencia = rate;
+}
+
+
+void Chip_ADC_EnableChannel(LPC_ADC_T* pADC, ADC_CHANNEL_T channel, FunctionalState NewState)  {
+	if (NewState == ENABLE)
+		pADC->canales |= 1UL << channel;
+	else
+		pADC->canales &= ~(1UL << channel);
+}
+
+
+/*
+ * En el ADC real habilita el pedido de DMA del canal; la emulacion siempre lo entrega
+ */
+void Chip_ADC_Int_SetChannelCmd(LPC_ADC_T* pADC, uint8_t channel, FunctionalState NewState)  {
+	(void) pADC;
+	(void) channel;
+	(void) NewState;
+}
+
+
+void Chip_ADC_SetBurstCmd(LPC_ADC_T* pADC, FunctionalState NewState)  {
+	pADC->burst = (NewState == ENABLE);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Configura la señal que convierte un ADC emulado.
+     *
+     *  @details
+     *   La funcion se llama desde el hilo del host que emula el DMA con el numero de muestra
+     *   desde el arranque, y devuelve el resultado de 10 bits de la conversion.
+     *
+	 *  @param		adc			ADC emulado (LPC_ADCn)
+	 *  @param		senial		Funcion que genera las muestras
+	 *  @return     None.
+***************************************************************************************************/
+void os_PortAdcSenial(LPC_ADC_T* adc, uint16_t (*senial)(uint32_t muestra))  {
+	adc->senial = senial;
+}
+
+
+
+/*==================[GPDMA]=================================*/
+
+void Chip_GPDMA_Init(LPC_GPDMA_T* pGPDMA)  {
+	(void) pGPDMA;
+}
+
+
+/*
+ * Igual que en LPCOpen, devuelve 0 tambien si no hay canales libres
+ */
+uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T* pGPDMA, uint32_t PeripheralConnection_ID)  {
+	(void) pGPDMA;
+	(void) PeripheralConnection_ID;
+
+	for (uint8_t i = 0; i < GPDMA_NUMBER_CHANNELS; i++)  {
+		if (!canalesDMA[i].reservado)  {
+			canalesDMA[i].reservado = true;
+			return i;
+		}
+	}
+
+	return 0;
+}
+
+
+Status Chip_GPDMA_Transfer(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum, uintptr_t src, uintptr_t dst,
+		GPDMA_FLOW_CONTROL_T TransferType, uint32_t Size)  {
+	DMA_TransferDescriptor_t descriptor;
+
+	descriptor.src = src;
+	descriptor.dst = dst;
+	descriptor.lli = 0;
+	descriptor.ctrl = GPDMA_DMACCxControl_TransferSize(Size) | GPDMA_DMACCxControl_I;
+
+	return Chip_GPDMA_SGTransfer(pGPDMA, ChannelNum, &descriptor, TransferType);
+}
+
+
+Status Chip_GPDMA_PrepareDescriptor(LPC_GPDMA_T* pGPDMA, DMA_TransferDescriptor_t* DMADescriptor,
+		uintptr_t src, uintptr_t dst, uint32_t Size, GPDMA_FLOW_CONTROL_T TransferType,
+		const DMA_TransferDescriptor_t* NextDescriptor)  {
+	(void) pGPDMA;
+	(void) TransferType;
+
+	DMADescriptor->src = src;
+	DMADescriptor->dst = dst;
+	DMADescriptor->lli = (uintptr_t) NextDescriptor;
+	DMADescriptor->ctrl = GPDMA_DMACCxControl_TransferSize(Size);
+
+	return SUCCESS;
+}
+
+
+/*
+ * Igual que en el GPDMA, el canal recorre la lista de descriptores hasta uno con lli en 0
+ * (una lista circular no termina nunca) o hasta que se lo detiene con Chip_GPDMA_Stop, y
+ * genera la interrupcion al terminar cada descriptor que tenga el bit I en ctrl
+ */
+Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum,
+		const DMA_TransferDescriptor_t* DMADescriptor, GPDMA_FLOW_CONTROL_T TransferType)  {
+	canalEmulado* canal;
+	sigset_t senales, mascaraPrevia;
+
+	(void) pGPDMA;
+
+	if (ChannelNum >= GPDMA_NUMBER_CHANNELS)
+		return ERROR;
+
+	canal = &canalesDMA[ChannelNum];
+
+	/*
+	 * El hilo del canal se crea con las señales del OS bloqueadas, para que SIGALRM y
+	 * SIGUSR1 se sigan atendiendo siempre en el hilo que corre el OS
+	 */
+	if (!canal->iniciado)  {
+		sem_init(&canal->inicio, 0, 0);
+
+		sigemptyset(&senales);
+		sigaddset(&senales, SIGALRM);
+		sigaddset(&senales, SIGUSR1);
+		pthread_sigmask(SIG_BLOCK, &senales, &mascaraPrevia);
+		pthread_create(&canal->hilo, NULL, hiloCanal, canal);
+		pthread_sigmask(SIG_SETMASK, &mascaraPrevia, NULL);
+
+		canal->iniciado = true;
+	}
+
+	canal->primero = *DMADescriptor;
+	canal->tipo = TransferType;
+	canal->activo = true;
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	sem_post(&canal->inicio);
+
+	return SUCCESS;
+}
+
+
+/*
+ * Igual que en LPCOpen, devuelve SUCCESS y limpia el pedido si el canal termino una
+ * transferencia
+ */
+Status Chip_GPDMA_Interrupt(LPC_GPDMA_T* pGPDMA, uint8_t ch)  {
+	(void) pGPDMA;
+
+	if (ch < GPDMA_NUMBER_CHANNELS &&
+			__atomic_exchange_n(&canalesDMA[ch].fin_transferencia, false, __ATOMIC_SEQ_CST))
+		return SUCCESS;
+
+	return ERROR;
+}
+
+
+void Chip_GPDMA_Stop(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum)  {
+	(void) pGPDMA;
+
+	if (ChannelNum < GPDMA_NUMBER_CHANNELS)  {
+		canalesDMA[ChannelNum].reservado = false;
+		canalesDMA[ChannelNum].activo = false;
+		canalesDMA[ChannelNum].fin_transferencia = false;
+	}
+}
+
+
+
+/*==================[funciones internas]=================================*/
+
+/*
+ * Hilo de un canal del GPDMA: espera cada transferencia, completa cada descriptor en el
+ * tiempo del periferico y genera las interrupciones
+ */
+static void* hiloCanal(void* arg)  {
+	canalEmulado* canal = arg;
+	DMA_TransferDescriptor_t descriptor;
+	uint64_t proximo;
+	bool ultimo;
+
+	while (1)  {
+		sem_wait(&canal->inicio);
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+		descriptor = canal->primero;
+		proximo = ahoraNs();
+
+		while (canal->activo)  {
+			ejecutarDescriptor(&descriptor, canal->tipo, &proximo);
+
+			if (!canal->activo)
+				break;		//detenido durante la transferencia
+
+			/*
+			 * En el micro el handler atiende cada fin de descriptor mucho antes del
+			 * siguiente. Si este hilo se demoro y completa varios seguidos, se espera a
+			 * que se atienda el anterior para no juntar dos interrupciones en una
+			 */
+			if (descriptor.ctrl & GPDMA_DMACCxControl_I)
+				esperarAtencion(canal);
+
+			/*
+			 * Igual que en el GPDMA, el canal se deshabilita antes de la interrupcion del
+			 * ultimo descriptor: el handler puede lanzar la transferencia siguiente en el
+			 * mismo canal, y no debe quedar detenida
+			 */
+			ultimo = (descriptor.lli == 0);
+			if (ultimo)
+				canal->activo = false;
+
+			if (descriptor.ctrl & GPDMA_DMACCxControl_I)  {
+				__atomic_store_n(&canal->fin_transferencia, true, __ATOMIC_SEQ_CST);
+				os_PortDispararIRQ(DMA_IRQn);
+
+				if (ultimo)
+					esperarAtencion(canal);
+			}
+
+			if (ultimo)
+				break;
+
+			descriptor = *(const DMA_TransferDescriptor_t*) descriptor.lli;
+		}
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Espera a que el handler limpie el fin de transferencia del canal (o a que se detenga el
+ * canal). La interrupcion del GPDMA es por nivel: sigue pedida mientras el canal tenga el
+ * fin de transferencia sin limpiar. Por eso se vuelve a generar mientras tanto, ya que
+ * os_IRQHandler limpia el pendiente al terminar y borraria un pedido que llegue mientras
+ * se atiende otro
+ */
+static void esperarAtencion(canalEmulado* canal)  {
+	while (__atomic_load_n(&canal->fin_transferencia, __ATOMIC_SEQ_CST))  {
+		esperarHasta(ahoraNs() + ESPERA_INTERRUPCION_NS);
+
+		if (__atomic_load_n(&canal->fin_transferencia, __ATOMIC_SEQ_CST))
+			os_PortDispararIRQ(DMA_IRQn);
+	}
+}
+
+
+/*
+ * Completa un descriptor. proximo es el instante en que el periferico tiene listo el
+ * siguiente dato, y se mantiene entre los descriptores de una lista para que el ADC
+ * muestree a frecuencia constante aunque el hilo se demore
+ */
+static void ejecutarDescriptor(const DMA_TransferDescriptor_t* descriptor, GPDMA_FLOW_CONTROL_T tipo,
+		uint64_t* proximo)  {
+	uint32_t cantidad = GPDMA_DMACCxControl_TransferSize(descriptor->ctrl);
+	uint32_t* destino;
+	LPC_USART_T* uart;
+	LPC_ADC_T* adc;
+
+	if (tipo == GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA)  {
+		uart = uartDeConexion(descriptor->dst);
+
+		if (uart != NULL)  {
+			esperarBytes(uart, cantidad);
+
+			if (uart->salida != NULL)
+				uart->salida((const uint8_t*) descriptor->src, cantidad);
+		}
+	}
+	else if (tipo == GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA)  {
+		adc = adcDeConexion(descriptor->src);
+
+		if (adc != NULL && adc->burst && adc->frecuencia > 0)  {
+			*proximo += (uint64_t) cantidad * 1000000000ULL / adc->frecuencia;
+			esperarHasta(*proximo);
+
+			destino = (uint32_t*) descriptor->dst;
+			for (uint32_t i = 0; i < cantidad; i++)  {
+				destino[i] = (1UL << 31) |
+						((uint32_t) (adc->senial != NULL ? adc->senial(adc->muestra) : 0) & 0x3FF) << 6;
+				adc->muestra++;
+			}
+		}
+	}
+}
+
+
+static LPC_USART_T* uartDeConexion(uintptr_t conexion)  {
+	switch (conexion)  {
+	case GPDMA_CONN_UART0_Tx:	return LPC_USART0;
+	case GPDMA_CONN_UART1_Tx:	return LPC_UART1;
+	case GPDMA_CONN_UART2_Tx:	return LPC_USART2;
+	case GPDMA_CONN_UART3_Tx:	return LPC_USART3;
+	default:					return NULL;
+	}
+}
+
+
+static LPC_ADC_T* adcDeConexion(uintptr_t conexion)  {
+	switch (conexion)  {
+	case GPDMA_CONN_ADC_0:		return LPC_ADC0;
+	case GPDMA_CONN_ADC_1:		return LPC_ADC1;
+	default:					return NULL;
+	}
+}
+
+
+static void esperarBytes(LPC_USART_T* uart, uint32_t cantidad)  {
+	esperarHasta(ahoraNs() + cantidad * nsCaracter(uart));
+}
+
+
+static uint32_t bytesFIFO(LPC_USART_T* uart)  {
+	return __atomic_load_n(&uart->rx_escritos, __ATOMIC_SEQ_CST) -
+			__atomic_load_n(&uart->rx_leidos, __ATOMIC_SEQ_CST);
+}
+
+
+static uint64_t nsCaracter(LPC_USART_T* uart)  {
+	return (BITS_POR_BYTE * 1000000000ULL) / uart->baudios;
+}
+
+
+static uint64_t ahoraNs(void)  {
+	struct timespec ahora;
+
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+	return (uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec;
+}
+
+
+/*
+ * Espera hasta el instante ns de CLOCK_MONOTONIC, con tiempo absoluto para que los
+ * retrasos de cada espera no se acumulen
+ */
+static void esperarHasta(uint64_t ns)  {
+	struct timespec fin;
+
+	fin.tv_sec = ns / 1000000000ULL;
+	fin.tv_nsec = ns % 1000000000ULL;
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &fin, NULL) != 0)
+		;
+}
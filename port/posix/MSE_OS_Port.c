@@ -0,0 +1,534 @@
+/*
+ * MSE_OS_Port.c (port POSIX)
+ *
+ *  Emulacion del Cortex-M4 necesaria para correr el OS sin cambios en una PC.
+ *
+ *  - Cada tarea corre en un contexto ucontext con un stack propio del host de
+ *    PORT_STACK_SIZE bytes. El stack de la estructura tarea se sigue inicializando
+ *    (y pintando) pero no se utiliza.
+ *  - El SysTick es un timer ITIMER_REAL que entrega SIGALRM.
+ *  - Las interrupciones externas se marcan pendientes en una mascara de 64 bits
+ *    y se entregan con SIGUSR1 al hilo que corre el OS.
+ *  - __disable_irq/__enable_irq bloquean y desbloquean ambas señales, con lo que
+ *    todas las interrupciones tienen la misma prioridad.
+ *  - PendSV se emula con un bit en SCB->ICSR. Se atiende al salir del handler mas
+ *    externo, o en __ISB/__enable_irq si se pidio desde modo thread, tal como lo
+ *    haria la excepcion de menor prioridad del sistema.
+ *
+ *  Compilacion (desde la raiz del repositorio):
+ *    gcc -std=gnu99 -O2 -Iport/posix -Iinc src/MSE_OS_Core.c src/MSE_OS_API.c \
+ *        src/MSE_OS_IRQ.c src/MSE_OS_DMA.c src/MSE_OS_Uart.c port/posix/MSE_OS_Port.c \
+ *        port/posix/MSE_OS_Chip.c port/posix/main_posix.c -lpthread -o mse_os_posix
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <ucontext.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "MSE_OS_Port.h"
+#include "MSE_OS_Core.h"
+
+#if OS_STACK_GUARDA_MPU
+#error "El port POSIX no emula el MPU, compilar con OS_STACK_GUARDA_MPU = 0"
+#endif
+
+
+/*==================[simbolos del OS utilizados por el port]=================================*/
+
+uint32_t getContextoSiguiente(uint32_t sp_actual);
+void SysTick_Handler(void);
+void returnHook(void);
+
+void DAC_IRQHandler(void);			void M0APP_IRQHandler(void);		void DMA_IRQHandler(void);
+void FLASH_EEPROM_IRQHandler(void);	void ETH_IRQHandler(void);			void SDIO_IRQHandler(void);
+void LCD_IRQHandler(void);			void USB0_IRQHandler(void);			void USB1_IRQHandler(void);
+void SCT_IRQHandler(void);			void RIT_IRQHandler(void);			void TIMER0_IRQHandler(void);
+void TIMER1_IRQHandler(void);		void TIMER2_IRQHandler(void);		void TIMER3_IRQHandler(void);
+void MCPWM_IRQHandler(void);		void ADC0_IRQHandler(void);			void I2C0_IRQHandler(void);
+void I2C1_IRQHandler(void);			void SPI_IRQHandler(void);			void ADC1_IRQHandler(void);
+void SSP0_IRQHandler(void);			void SSP1_IRQHandler(void);			void UART0_IRQHandler(void);
+void UART1_IRQHandler(void);		void UART2_IRQHandler(void);		void UART3_IRQHandler(void);
+void I2S0_IRQHandler(void);			void I2S1_IRQHandler(void);			void SPIFI_IRQHandler(void);
+void SGPIO_IRQHandler(void);		void GPIO0_IRQHandler(void);		void GPIO1_IRQHandler(void);
+void GPIO2_IRQHandler(void);		void GPIO3_IRQHandler(void);		void GPIO4_IRQHandler(void);
+void GPIO5_IRQHandler(void);		void GPIO6_IRQHandler(void);		void GPIO7_IRQHandler(void);
+void GINT0_IRQHandler(void);		void GINT1_IRQHandler(void);		void EVRT_IRQHandler(void);
+void CAN1_IRQHandler(void);			void ADCHS_IRQHandler(void);		void ATIMER_IRQHandler(void);
+void RTC_IRQHandler(void);			void WDT_IRQHandler(void);			void M0SUB_IRQHandler(void);
+void CAN0_IRQHandler(void);			void QEI_IRQHandler(void);
+
+
+/*
+ * Tabla de vectores de interrupciones externas, en el mismo orden que la del LPC43xx
+ */
+static void (* const vectorIRQ[CANT_IRQ_PORT])(void) = {
+	DAC_IRQHandler,		M0APP_IRQHandler,	DMA_IRQHandler,		FLASH_EEPROM_IRQHandler,
+	NULL,				ETH_IRQHandler,		SDIO_IRQHandler,	LCD_IRQHandler,
+	USB0_IRQHandler,	USB1_IRQHandler,	SCT_IRQHandler,		RIT_IRQHandler,
+	TIMER0_IRQHandler,	TIMER1_IRQHandler,	TIMER2_IRQHandler,	TIMER3_IRQHandler,
+	MCPWM_IRQHandler,	ADC0_IRQHandler,	I2C0_IRQHandler,	I2C1_IRQHandler,
+	SPI_IRQHandler,		ADC1_IRQHandler,	SSP0_IRQHandler,	SSP1_IRQHandler,
+	UART0_IRQHandler,	UART1_IRQHandler,	UART2_IRQHandler,	UART3_IRQHandler,
+	I2S0_IRQHandler,	I2S1_IRQHandler,	SPIFI_IRQHandler,	SGPIO_IRQHandler,
+	GPIO0_IRQHandler,	GPIO1_IRQHandler,	GPIO2_IRQHandler,	GPIO3_IRQHandler,
+	GPIO4_IRQHandler,	GPIO5_IRQHandler,	GPIO6_IRQHandler,	GPIO7_IRQHandler,
+	GINT0_IRQHandler,	GINT1_IRQHandler,	EVRT_IRQHandler,	CAN1_IRQHandler,
+	NULL,				ADCHS_IRQHandler,	ATIMER_IRQHandler,	RTC_IRQHandler,
+	NULL,				WDT_IRQHandler,		M0SUB_IRQHandler,	CAN0_IRQHandler,
+	QEI_IRQHandler
+};
+
+
+/*==================[definicion de datos del port]=================================*/
+
+/*
+ * Cada tarea del OS tiene asociado un contexto del host. La asociacion se hace por
+ * puntero a la estructura tarea. La tarea idle ocupa un lugar mas.
+ */
+struct _contextoHost  {
+	tarea* task;
+	ucontext_t contexto;
+	void* stack;
+	bool eliminada;				//la tarea fue eliminada, el contexto se libera en el proximo PendSV
+};
+
+typedef struct _contextoHost contextoHost;
+
+
+SCB_Type os_PortSCB;
+uint32_t SystemCoreClock = 204000000;
+
+static contextoHost contextos[MAX_TASK_COUNT + 1];
+static volatile sig_atomic_t nivelHandler;		//profundidad de handlers en curso (0 = modo thread)
+static volatile sig_atomic_t irqDeshabilitadas;	//equivalente a PRIMASK
+static uint64_t irqPendientes;					//equivalente a NVIC->ISPR
+static uint64_t irqHabilitadas;					//equivalente a NVIC->ISER
+static sigset_t senialesIRQ;
+static pthread_t hiloKernel;
+static bool portIniciado;
+static uint32_t cambiosContexto;
+
+
+/*==================[definicion de prototipos static]=================================*/
+static void iniciarPort(void);
+static void handlerSysTick(int sig);
+static void handlerIRQ(int sig);
+static void salidaExcepcion(sig_atomic_t deshabilitadas);
+static void ejecutarPendSV(void);
+static void arranqueTarea(void);
+static contextoHost* buscarContexto(tarea* task);
+static void liberarContextos(tarea* saliente);
+
+
+
+/*==================[emulacion de intrinsecos del core]=================================*/
+
+void __disable_irq(void)  {
+	iniciarPort();
+	sigprocmask(SIG_BLOCK, &senialesIRQ, NULL);
+	irqDeshabilitadas = true;
+}
+
+
+void __enable_irq(void)  {
+	irqDeshabilitadas = false;
+
+	/*
+	 * Dentro de un handler no se habilitan las señales: todas las interrupciones
+	 * emuladas tienen la misma prioridad y no pueden anidarse
+	 */
+	if (nivelHandler > 0)
+		return;
+
+	sigprocmask(SIG_UNBLOCK, &senialesIRQ, NULL);
+
+	if (SCB->ICSR & SCB_ICSR_PENDSVSET_Msk)
+		ejecutarPendSV();
+}
+
+
+void __ISB(void)  {
+	/*
+	 * setPendSV termina con una barrera. Si el pedido se hizo desde modo thread con las
+	 * interrupciones habilitadas, PendSV se atiende en este momento, igual que en el micro
+	 */
+	if (nivelHandler == 0 && !irqDeshabilitadas && (SCB->ICSR & SCB_ICSR_PENDSVSET_Msk))
+		ejecutarPendSV();
+}
+
+
+void __DSB(void)  {
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+
+void __WFI(void)  {
+	sigset_t mascara;
+
+	if (irqDeshabilitadas || nivelHandler > 0)
+		return;
+
+	sigprocmask(SIG_SETMASK, NULL, &mascara);
+	sigdelset(&mascara, SIGALRM);
+	sigdelset(&mascara, SIGUSR1);
+	sigsuspend(&mascara);
+}
+
+
+
+/*==================[emulacion del NVIC]=================================*/
+
+void NVIC_EnableIRQ(LPC43XX_IRQn_Type IRQn)  {
+	iniciarPort();
+	__atomic_fetch_or(&irqHabilitadas, 1ULL << IRQn, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&irqPendientes, __ATOMIC_SEQ_CST) & (1ULL << IRQn))
+		pthread_kill(hiloKernel, SIGUSR1);
+}
+
+
+void NVIC_DisableIRQ(LPC43XX_IRQn_Type IRQn)  {
+	__atomic_fetch_and(&irqHabilitadas, ~(1ULL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+
+void NVIC_SetPendingIRQ(LPC43XX_IRQn_Type IRQn)  {
+	iniciarPort();
+	__atomic_fetch_or(&irqPendientes, 1ULL << IRQn, __ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&irqHabilitadas, __ATOMIC_SEQ_CST) & (1ULL << IRQn))
+		pthread_kill(hiloKernel, SIGUSR1);
+}
+
+
+void NVIC_ClearPendingIRQ(LPC43XX_IRQn_Type IRQn)  {
+	if (IRQn >= 0)
+		__atomic_fetch_and(&irqPendientes, ~(1ULL << IRQn), __ATOMIC_SEQ_CST);
+}
+
+
+void NVIC_SetPriority(LPC43XX_IRQn_Type IRQn, uint32_t priority)  {
+	(void) IRQn;
+	(void) priority;
+}
+
+
+
+/*==================[reloj y SysTick]=================================*/
+
+void SystemCoreClockUpdate(void)  {
+}
+
+
+void Board_Init(void)  {
+	iniciarPort();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Contador de ciclos emulado.
+     *
+     *  @details
+     *   Reemplaza a DWT_CYCCNT (OS_CICLOS): convierte el reloj monotonico del host a ciclos de
+     *   SystemCoreClock. Como en el micro, el contador es de 32 bits y da la vuelta.
+     *
+	 *  @param 		None
+	 *  @return     Ciclos transcurridos.
+***************************************************************************************************/
+uint32_t os_PortCiclos(void)  {
+	struct timespec ahora;
+
+	clock_gettime(CLOCK_MONOTONIC, &ahora);
+
+	return (uint32_t) (((uint64_t) ahora.tv_sec * 1000000000ULL + ahora.tv_nsec) *
+			(SystemCoreClock / 1000000) / 1000);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Configura el SysTick emulado.
+     *
+     *  @details
+     *   Convierte la cantidad de ciclos de reloj entre ticks en un periodo de tiempo real,
+     *   respetando SystemCoreClock, y lo programa en un timer POSIX que entrega SIGALRM.
+     *
+	 *  @param		ticks	Ciclos de reloj entre interrupciones, igual que en CMSIS
+	 *  @return     0 si el timer se pudo programar, 1 en caso contrario.
+***************************************************************************************************/
+uint32_t SysTick_Config(uint32_t ticks)  {
+	struct itimerval periodo;
+	uint64_t us;
+
+	iniciarPort();
+
+	us = ((uint64_t) ticks * 1000000) / SystemCoreClock;
+	if (us == 0)
+		us = 1;
+
+	periodo.it_interval.tv_sec = us / 1000000;
+	periodo.it_interval.tv_usec = us % 1000000;
+	periodo.it_value = periodo.it_interval;
+
+	return setitimer(ITIMER_REAL, &periodo, NULL) == 0 ? 0 : 1;
+}
+
+
+
+/*==================[funciones propias del port]=================================*/
+
+/*************************************************************************************************
+	 *  @brief Genera una interrupcion externa.
+     *
+     *  @details
+     *   Equivale a que el periferico asociado levante su pedido de interrupcion. Puede llamarse
+     *   desde cualquier hilo del host (por ejemplo un hilo que simula un periferico), la
+     *   interrupcion siempre se atiende en el hilo que corre el OS.
+     *
+	 *  @param		irq		Numero de interrupcion, igual que en el LPC43xx
+	 *  @return     None.
+***************************************************************************************************/
+void os_PortDispararIRQ(LPC43XX_IRQn_Type irq)  {
+	NVIC_SetPendingIRQ(irq);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de cambios de contexto efectivos desde el arranque.
+     *
+	 *  @param		None.
+	 *  @return     Cantidad de veces que PendSV cambio de tarea.
+***************************************************************************************************/
+uint32_t os_PortCambiosContexto(void)  {
+	return cambiosContexto;
+}
+
+
+
+/*==================[funciones internas]=================================*/
+
+static void iniciarPort(void)  {
+	struct sigaction sa;
+
+	if (portIniciado)
+		return;
+
+	portIniciado = true;
+	hiloKernel = pthread_self();
+
+	sigemptyset(&senialesIRQ);
+	sigaddset(&senialesIRQ, SIGALRM);
+	sigaddset(&senialesIRQ, SIGUSR1);
+
+	sa.sa_mask = senialesIRQ;
+	sa.sa_flags = SA_RESTART;
+
+	sa.sa_handler = handlerSysTick;
+	sigaction(SIGALRM, &sa, NULL);
+
+	sa.sa_handler = handlerIRQ;
+	sigaction(SIGUSR1, &sa, NULL);
+}
+
+
+static void handlerSysTick(int sig)  {
+	sig_atomic_t deshabilitadas = irqDeshabilitadas;
+
+	(void) sig;
+
+	nivelHandler++;
+	SysTick_Handler();
+	salidaExcepcion(deshabilitadas);
+}
+
+
+static void handlerIRQ(int sig)  {
+	sig_atomic_t deshabilitadas = irqDeshabilitadas;
+	uint64_t pendientes;
+	int32_t irq;
+
+	(void) sig;
+
+	nivelHandler++;
+
+	/*
+	 * Igual que el NVIC, se limpia el bit de pendiente al ingresar a cada handler y se atienden
+	 * de menor a mayor numero de interrupcion
+	 */
+	while ((pendientes = __atomic_load_n(&irqPendientes, __ATOMIC_SEQ_CST) & irqHabilitadas) != 0)  {
+		irq = __builtin_ctzll(pendientes);
+		__atomic_fetch_and(&irqPendientes, ~(1ULL << irq), __ATOMIC_SEQ_CST);
+
+		if (irq < CANT_IRQ_PORT && vectorIRQ[irq] != NULL)
+			vectorIRQ[irq]();
+	}
+
+	salidaExcepcion(deshabilitadas);
+}
+
+
+/*
+ * Al salir del handler mas externo se atiende PendSV si quedo pendiente, que es lo que
+ * hace el hardware por tail-chaining con la excepcion de menor prioridad. PRIMASK vuelve
+ * al valor que tenia al entrar: las secciones criticas del handler lo modifican, y si
+ * quedara en true el modo thread veria las interrupciones deshabilitadas (__WFI y __ISB
+ * no harian nada) aunque las señales esten habilitadas
+ */
+static void salidaExcepcion(sig_atomic_t deshabilitadas)  {
+	if (nivelHandler == 1 && (SCB->ICSR & SCB_ICSR_PENDSVSET_Msk))
+		ejecutarPendSV();
+
+	irqDeshabilitadas = deshabilitadas;
+	nivelHandler--;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Emulacion de PendSV_Handler.
+     *
+     *  @details
+     *   Llama a getContextoSiguiente igual que el handler en assembler y, si la tarea actual
+     *   cambio, hace swapcontext hacia el contexto del host de la tarea entrante. A la funcion
+     *   del OS se le pasa la base del stack de la tarea saliente como sp_actual: en el host el
+     *   stack pointer real queda guardado en el ucontext. Una tarea cuyo stack_pointer todavia
+     *   apunta al stack frame inicial nunca corrio (o fue reinicializada) y se crea su contexto.
+     *   El nivel de handler y PRIMASK se guardan por contexto, porque una tarea puede ser
+     *   desalojada desde un handler y retomada desde modo thread o viceversa.
+***************************************************************************************************/
+static void ejecutarPendSV(void)  {
+	sigset_t mascaraPrevia;
+	sig_atomic_t nivel, deshabilitadas;
+	tarea *saliente, *entrante;
+	contextoHost *ctxSaliente, *ctxEntrante;
+
+	sigprocmask(SIG_BLOCK, &senialesIRQ, &mascaraPrevia);
+	SCB->ICSR &= ~SCB_ICSR_PENDSVSET_Msk;
+
+	saliente = os_getTareaActual();
+	liberarContextos(saliente);
+	getContextoSiguiente(OS_DIRECCION(saliente->stack));
+	entrante = os_getTareaActual();
+
+	if (saliente != entrante)  {
+		ctxSaliente = buscarContexto(saliente);
+		ctxEntrante = buscarContexto(entrante);
+
+		/*
+		 * Sin contexto no hay a donde cambiar: si errorHook retorna se sigue en el de la
+		 * tarea saliente
+		 */
+		if (ctxSaliente == NULL || ctxEntrante == NULL)  {
+			sigprocmask(SIG_SETMASK, &mascaraPrevia, NULL);
+			return;
+		}
+
+		if (entrante->stack_pointer ==
+				OS_DIRECCION(entrante->stack + STACK_SIZE/4 - FULL_STACKING_SIZE))  {
+
+			/*
+			 * La tarea puede ser una eliminada y vuelta a crear sobre la misma estructura:
+			 * el contexto nuevo ya no debe liberarse
+			 */
+			ctxEntrante->eliminada = false;
+
+			if (ctxEntrante->stack == NULL)
+				ctxEntrante->stack = malloc(PORT_STACK_SIZE);
+
+			getcontext(&ctxEntrante->contexto);
+			ctxEntrante->contexto.uc_stack.ss_sp = ctxEntrante->stack;
+			ctxEntrante->contexto.uc_stack.ss_size = PORT_STACK_SIZE;
+			ctxEntrante->contexto.uc_link = NULL;
+			ctxEntrante->contexto.uc_sigmask = senialesIRQ;
+			makecontext(&ctxEntrante->contexto, arranqueTarea, 0);
+		}
+
+		cambiosContexto++;
+
+		nivel = nivelHandler;
+		deshabilitadas = irqDeshabilitadas;
+		swapcontext(&ctxSaliente->contexto, &ctxEntrante->contexto);
+		nivelHandler = nivel;
+		irqDeshabilitadas = deshabilitadas;
+	}
+
+	sigprocmask(SIG_SETMASK, &mascaraPrevia, NULL);
+}
+
+
+/*
+ * Punto de entrada de todos los contextos nuevos. La tarea arranca en modo thread con
+ * las interrupciones habilitadas, igual que con el stack frame inicial de os_InitTarea.
+ * El contexto se crea con las señales bloqueadas y se habilitan recien aqui: si setcontext
+ * las habilitara, una interrupcion podria atenderse sobre el stack de la tarea saliente
+ * con el contexto de la entrante a medio cargar
+ */
+static void arranqueTarea(void)  {
+	void (*entry_point)(void);
+
+	nivelHandler = 0;
+	irqDeshabilitadas = false;
+	sigprocmask(SIG_UNBLOCK, &senialesIRQ, NULL);
+
+	entry_point = (void (*)(void)) os_getTareaActual()->entry_point;
+	entry_point();
+
+	returnHook();
+}
+
+
+/*
+ * Devuelve el contexto de la tarea, o le asigna uno libre si no tenia. Se buscan en dos
+ * recorridos y sin variables que sobrevivan al recorrido porque la funcion se expande
+ * dentro de ejecutarPendSV, que llama a swapcontext. Si la tabla esta llena (mas tareas
+ * vivas que contextos, o contextos de tareas eliminadas que todavia no se liberaron) se
+ * levanta ERR_OS_CANT_TAREAS y se devuelve NULL
+ */
+static contextoHost* buscarContexto(tarea* task)  {
+	for (uint32_t i = 0; i < MAX_TASK_COUNT + 1; i++)  {
+		if (contextos[i].task == task)
+			return &contextos[i];
+	}
+
+	for (uint32_t i = 0; i < MAX_TASK_COUNT + 1; i++)  {
+		if (contextos[i].task == NULL)  {
+			contextos[i].task = task;
+			return &contextos[i];
+		}
+	}
+
+	os_setError(ERR_OS_CANT_TAREAS, buscarContexto);
+	return NULL;
+}
+
+
+/*
+ * Los contextos de tareas eliminadas no se liberan en os_PortEliminarTarea porque una tarea
+ * que se elimina a si misma sigue corriendo sobre el stack del host hasta el cambio de
+ * contexto. Se liberan en el siguiente PendSV que no sale de esa tarea; el stack del host
+ * queda asignado al contexto libre y se reutiliza en la proxima tarea creada
+ */
+static void liberarContextos(tarea* saliente)  {
+	for (uint32_t i = 0; i < MAX_TASK_COUNT + 1; i++)  {
+		if (contextos[i].eliminada && contextos[i].task != saliente)  {
+			contextos[i].task = NULL;
+			contextos[i].eliminada = false;
+		}
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Aviso de tarea eliminada.
+     *
+     *  @details
+     *   Redefine el hook debil del core para liberar el contexto del host asociado a la tarea,
+     *   de modo que crear y eliminar tareas indefinidamente no agote la tabla de contextos.
+***************************************************************************************************/
+void os_PortEliminarTarea(tarea* task)  {
+	for (uint32_t i = 0; i < MAX_TASK_COUNT + 1; i++)  {
+		if (contextos[i].task == task)
+			contextos[i].eliminada = true;
+	}
+}
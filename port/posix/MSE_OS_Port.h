@@ -0,0 +1,26 @@
+/*
+ * MSE_OS_Port.h (port POSIX)
+ *
+ *  Funciones propias del port POSIX que no existen en el hardware real. Permiten
+ *  a un programa de simulacion generar interrupciones externas y consultar el
+ *  estado del emulador.
+ */
+
+#ifndef MSE_OS_PORT_POSIX_MSE_OS_PORT_H_
+#define MSE_OS_PORT_POSIX_MSE_OS_PORT_H_
+
+#include "board.h"
+
+
+#define PORT_STACK_SIZE		(64 * 1024)		//stack real (del host) de cada tarea
+#define CANT_IRQ_PORT		53				//interrupciones externas emuladas (igual que CANT_IRQ)
+
+
+void os_PortDispararIRQ(LPC43XX_IRQn_Type irq);
+uint32_t os_PortCambiosContexto(void);
+void os_PortUartSalida(LPC_USART_T* uart, void (*salida)(const uint8_t* datos, uint32_t cantidad));
+void os_PortUartRecibir(LPC_USART_T* uart, const uint8_t* datos, uint32_t cantidad);
+void os_PortAdcSenial(LPC_ADC_T* adc, uint16_t (*senial)(uint32_t muestra));
+
+
+#endif /* MSE_OS_PORT_POSIX_MSE_OS_PORT_H_ */
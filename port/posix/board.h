@@ -0,0 +1,263 @@
+/*
+ * board.h (port POSIX)
+ *
+ *  Reemplazo de board.h para compilar MSE_OS_Core.c, MSE_OS_API.c y MSE_OS_IRQ.c
+ *  sin modificaciones en una PC. Provee lo minimo de CMSIS que utiliza el OS:
+ *  registros SCB (solo ICSR y SHCSR), barreras, enmascarado de interrupciones,
+ *  WFI y SysTick_Config. Las tareas corren como contextos ucontext, el SysTick
+ *  es un timer POSIX (SIGALRM) y las interrupciones externas se entregan con
+ *  SIGUSR1. Ver MSE_OS_Port.c
+ *
+ *  Tambien declara la parte de LPCOpen que usan los drivers del OS (UART y GPDMA),
+ *  emulada en MSE_OS_Chip.c
+ */
+
+#ifndef MSE_OS_PORT_POSIX_BOARD_H_
+#define MSE_OS_PORT_POSIX_BOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cmsis_43xx.h"
+
+
+/*==================[registros del System Control Block emulados]=================================*/
+
+typedef struct  {
+	volatile uint32_t ICSR;
+	volatile uint32_t SHCSR;
+} SCB_Type;
+
+extern SCB_Type os_PortSCB;
+
+#define SCB								(&os_PortSCB)
+#define SCB_ICSR_PENDSVSET_Msk			(1UL << 28)
+#define SCB_SHCSR_MEMFAULTENA_Msk		(1UL << 16)
+
+
+/*==================[intrinsecos del core]=================================*/
+
+void __disable_irq(void);
+void __enable_irq(void);
+void __ISB(void);
+void __DSB(void);
+void __WFI(void);
+
+/*
+ * Instrucciones SIMD del Cortex-M4 que usan los filtros, con la misma semantica
+ */
+static inline uint32_t __SMLAD(uint32_t op1, uint32_t op2, uint32_t op3)  {
+	return op3 + (int32_t) (int16_t) op1 * (int16_t) op2
+			+ (int32_t) (int16_t) (op1 >> 16) * (int16_t) (op2 >> 16);
+}
+
+static inline uint64_t __SMLALD(uint32_t op1, uint32_t op2, uint64_t acc)  {
+	return acc + (int64_t) ((int32_t) (int16_t) op1 * (int16_t) op2)
+			+ (int64_t) ((int32_t) (int16_t) (op1 >> 16) * (int16_t) (op2 >> 16));
+}
+
+static inline int32_t __SSAT(int32_t valor, uint32_t bits)  {
+	int32_t maximo = (1L << (bits - 1)) - 1;
+
+	if (valor > maximo)
+		return maximo;
+	if (valor < -maximo - 1)
+		return -maximo - 1;
+
+	return valor;
+}
+
+
+/*==================[reloj y SysTick]=================================*/
+
+extern uint32_t SystemCoreClock;
+
+void SystemCoreClockUpdate(void);
+uint32_t SysTick_Config(uint32_t ticks);
+void Board_Init(void);
+
+/*
+ * No hay DWT: los ciclos se calculan del reloj monotonico del host a SystemCoreClock
+ */
+uint32_t os_PortCiclos(void);
+
+#define OS_CICLOS()				os_PortCiclos()
+#define OS_CICLOS_INIT()
+
+/*
+ * Los punteros son de 64 bits: las direcciones del stack frame se truncan a 32. El port
+ * no ejecuta ese stack frame y reconoce el inicial comparando con la misma direccion
+ * truncada
+ */
+#define OS_DIRECCION(p)			((uint32_t) (uintptr_t) (p))
+
+
+/*==================[tipos de LPCOpen]=================================*/
+
+typedef enum {ERROR = 0, SUCCESS = !ERROR} Status;
+typedef enum {DISABLE = 0, ENABLE = !DISABLE} FunctionalState;
+
+
+/*==================[UART emulada]=================================*/
+
+/*
+ * Solo lo que usan los drivers del OS. Los registros no se emulan: la estructura guarda
+ * la configuracion, a donde van los bytes transmitidos (ver os_PortUartSalida) y la FIFO
+ * de recepcion, que llena os_PortUartRecibir
+ */
+#define UART_RX_FIFO_TAM				16
+
+typedef struct  {
+	uint32_t FCR;
+	uint32_t IER;
+	uint32_t baudios;
+	LPC43XX_IRQn_Type irq;
+	void (*salida)(const uint8_t* datos, uint32_t cantidad);
+	uint8_t fifo_rx[UART_RX_FIFO_TAM];
+	uint32_t rx_escritos;				//contadores libres de la FIFO (productor y consumidor)
+	uint32_t rx_leidos;
+	uint32_t lsr_errores;
+	bool timeout_caracter;
+} LPC_USART_T;
+
+extern LPC_USART_T os_PortUSART[4];
+
+#define LPC_USART0						(&os_PortUSART[0])
+#define LPC_UART1						(&os_PortUSART[1])
+#define LPC_USART2						(&os_PortUSART[2])
+#define LPC_USART3						(&os_PortUSART[3])
+
+#define UART_FCR_FIFO_EN				(1 << 0)
+#define UART_FCR_RX_RS					(1 << 1)
+#define UART_FCR_TX_RS					(1 << 2)
+#define UART_FCR_DMAMODE_SEL			(1 << 3)
+#define UART_FCR_TRG_LEV0				(0)
+#define UART_FCR_TRG_LEV1				(1 << 6)
+#define UART_FCR_TRG_LEV2				(2 << 6)
+#define UART_FCR_TRG_LEV3				(3 << 6)
+
+#define UART_IER_RBRINT					(1 << 0)
+#define UART_IER_THREINT				(1 << 1)
+#define UART_IER_RLSINT					(1 << 2)
+
+#define UART_IIR_INTSTAT_PEND			(1 << 0)
+#define UART_IIR_INTID_MASK				(7 << 1)
+#define UART_IIR_INTID_RLS				(3 << 1)
+#define UART_IIR_INTID_RDA				(2 << 1)
+#define UART_IIR_INTID_CTI				(6 << 1)
+#define UART_IIR_INTID_THRE				(1 << 1)
+
+#define UART_LSR_RDR					(1 << 0)
+#define UART_LSR_OE						(1 << 1)
+#define UART_LSR_PE						(1 << 2)
+#define UART_LSR_FE						(1 << 3)
+#define UART_LSR_BI						(1 << 4)
+
+void Chip_UART_SetupFIFOS(LPC_USART_T* pUART, uint32_t fcr);
+uint32_t Chip_UART_SetBaud(LPC_USART_T* pUART, uint32_t baudrate);
+void Chip_UART_IntEnable(LPC_USART_T* pUART, uint32_t intMask);
+void Chip_UART_IntDisable(LPC_USART_T* pUART, uint32_t intMask);
+uint32_t Chip_UART_ReadIntIDReg(LPC_USART_T* pUART);
+uint32_t Chip_UART_ReadLineStatus(LPC_USART_T* pUART);
+uint8_t Chip_UART_ReadByte(LPC_USART_T* pUART);
+
+
+/*==================[GPDMA emulado]=================================*/
+
+/*
+ * Cada canal es un hilo del host que completa la transferencia en el tiempo que tardaria
+ * el periferico y luego genera DMA_IRQn. Las direcciones se reciben como uintptr_t (en
+ * el micro son uint32_t) para no truncar los punteros del host
+ */
+typedef struct  {
+	uint32_t reservado;
+} LPC_GPDMA_T;
+
+extern LPC_GPDMA_T os_PortGPDMA;
+
+#define LPC_GPDMA						(&os_PortGPDMA)
+#define GPDMA_NUMBER_CHANNELS			8
+
+#define GPDMA_CONN_MEMORY				(0UL)
+#define GPDMA_CONN_UART0_Tx				(2UL)
+#define GPDMA_CONN_UART0_Rx				(4UL)
+#define GPDMA_CONN_UART1_Tx				(6UL)
+#define GPDMA_CONN_UART1_Rx				(8UL)
+#define GPDMA_CONN_UART2_Tx				(10UL)
+#define GPDMA_CONN_UART2_Rx				(12UL)
+#define GPDMA_CONN_UART3_Tx				(14UL)
+#define GPDMA_CONN_UART3_Rx				(16UL)
+#define GPDMA_CONN_ADC_0				(25UL)
+#define GPDMA_CONN_ADC_1				(26UL)
+
+#define GPDMA_DMACCxControl_I			(1UL << 31)		//interrupcion al terminar el descriptor
+#define GPDMA_DMACCxControl_TransferSize(n)	((n) & 0xFFF)
+
+typedef enum  {
+	GPDMA_TRANSFERTYPE_M2M_CONTROLLER_DMA = 0,
+	GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA = 1,
+	GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA = 2,
+	GPDMA_TRANSFERTYPE_P2P_CONTROLLER_DMA = 3
+} GPDMA_FLOW_CONTROL_T;
+
+typedef struct  {
+	uintptr_t src;
+	uintptr_t dst;
+	uintptr_t lli;						//siguiente descriptor, 0 al final de la lista
+	uint32_t ctrl;
+} DMA_TransferDescriptor_t;
+
+void Chip_GPDMA_Init(LPC_GPDMA_T* pGPDMA);
+uint8_t Chip_GPDMA_GetFreeChannel(LPC_GPDMA_T* pGPDMA, uint32_t PeripheralConnection_ID);
+Status Chip_GPDMA_Transfer(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum, uintptr_t src, uintptr_t dst,
+		GPDMA_FLOW_CONTROL_T TransferType, uint32_t Size);
+Status Chip_GPDMA_PrepareDescriptor(LPC_GPDMA_T* pGPDMA, DMA_TransferDescriptor_t* DMADescriptor,
+		uintptr_t src, uintptr_t dst, uint32_t Size, GPDMA_FLOW_CONTROL_T TransferType,
+		const DMA_TransferDescriptor_t* NextDescriptor);
+Status Chip_GPDMA_SGTransfer(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum,
+		const DMA_TransferDescriptor_t* DMADescriptor, GPDMA_FLOW_CONTROL_T TransferType);
+Status Chip_GPDMA_Interrupt(LPC_GPDMA_T* pGPDMA, uint8_t ch);
+void Chip_GPDMA_Stop(LPC_GPDMA_T* pGPDMA, uint8_t ChannelNum);
+
+
+/*==================[ADC emulado]=================================*/
+
+/*
+ * Convierte en modo burst a la frecuencia configurada. Los valores los genera la funcion
+ * configurada con os_PortAdcSenial y se leen solo por DMA (GPDMA_CONN_ADC_n), con el mismo
+ * formato que el registro GDR: resultado de 10 bits en los bits 15:6 y DONE en el bit 31
+ */
+typedef struct  {
+	uint32_t frecuencia;
+	uint32_t canales;
+	bool burst;
+	uint16_t (*senial)(uint32_t muestra);
+	uint32_t muestra;
+} LPC_ADC_T;
+
+typedef struct  {
+	uint32_t adcRate;
+	uint8_t bitsAccuracy;
+	bool burstMode;
+} ADC_CLOCK_SETUP_T;
+
+typedef enum  {
+	ADC_CH0 = 0, ADC_CH1, ADC_CH2, ADC_CH3, ADC_CH4, ADC_CH5, ADC_CH6, ADC_CH7
+} ADC_CHANNEL_T;
+
+extern LPC_ADC_T os_PortADC[2];
+
+#define LPC_ADC0						(&os_PortADC[0])
+#define LPC_ADC1						(&os_PortADC[1])
+
+#define ADC_DR_RESULT(n)				(((n) >> 6) & 0x3FF)
+#define ADC_DR_DONE(n)					(((n) >> 31))
+
+void Chip_ADC_Init(LPC_ADC_T* pADC, ADC_CLOCK_SETUP_T* ADCSetup);
+void Chip_ADC_SetSampleRate(LPC_ADC_T* pADC, ADC_CLOCK_SETUP_T* ADCSetup, uint32_t rate);
+void Chip_ADC_EnableChannel(LPC_ADC_T* pADC, ADC_CHANNEL_T channel, FunctionalState NewState);
+void Chip_ADC_Int_SetChannelCmd(LPC_ADC_T* pADC, uint8_t channel, FunctionalState NewState);
+void Chip_ADC_SetBurstCmd(LPC_ADC_T* pADC, FunctionalState NewState);
+
+
+#endif /* MSE_OS_PORT_POSIX_BOARD_H_ */
@@ -0,0 +1,249 @@
+/*
+ * main_posix.c (port POSIX)
+ *
+ *  Aplicacion de ejemplo y medicion para el port POSIX. Corre varias cargas en paralelo:
+ *  - productor/consumidor de igual prioridad sobre una cola de uint32_t
+ *  - una tarea despertada por semaforo desde una interrupcion emulada (PIN_INT0), que
+ *    genera un hilo del host haciendo las veces de periferico
+ *  - una tarea gestora que cada PERIODO_MANEJADOR ms crea un manejador de maxima prioridad
+ *    con os_CreateTask, que atiende un pedido y se elimina a si mismo con os_DeleteTask
+ *  - una tarea transmisora que escribe por el driver de UART con DMA bloques de bytes
+ *    numerados mas largos que su buffer. La funcion de salida de la UART emulada verifica
+ *    que lleguen en orden, y en cada tick se cuenta si la transmisora esta bloqueada con
+ *    lugar en el buffer, lo que no deberia ocurrir
+ *  - una tarea de reporte de maxima prioridad que cada segundo imprime las tasas medidas
+ *
+ *  Cada linea de reporte tiene formato "clave=valor" para poder procesarla con scripts.
+ *  Se compila junto con src/MSE_OS_DMA.c, src/MSE_OS_Uart.c y port/posix/MSE_OS_Chip.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_IRQ.h"
+#include "MSE_OS_Uart.h"
+#include "MSE_OS_Port.h"
+
+
+/*==================[macros and definitions]=================================*/
+
+#define MILISEC				1000
+#define SEGUNDOS_MEDICION	3
+#define PERIODO_IRQ_US		500
+#define PERIODO_MANEJADOR	10
+#define BAUDIOS_UART		921600
+#define TAM_BUFFER_UART		64
+#define TAM_ESCRITURA_UART	200			//mas largo que el buffer
+
+#define PRIORIDAD_0		0
+#define PRIORIDAD_1		1
+
+
+/*==================[Global data declaration]==============================*/
+
+tarea g_sProductor, g_sConsumidor;		//prioridad 1
+tarea g_sEvento;						//prioridad 1
+tarea g_sGestor;						//prioridad 1
+tarea g_sTransmisor;					//prioridad 1
+tarea g_sReporte;						//prioridad 0
+tarea g_sManejador;						//prioridad 0, creada y eliminada en ejecucion
+
+osCola colaDatos;
+osSemaforo semEvento;
+osUartTx uartTx;
+
+static uint8_t bufferUart[TAM_BUFFER_UART];
+
+static volatile uint32_t elementosLeidos;
+static volatile uint32_t eventosAtendidos;
+static volatile uint32_t manejadoresEjecutados;
+static volatile uint32_t bytesUart;				//recibidos por la salida de la UART
+static volatile uint32_t erroresUart;			//bytes fuera de orden
+static volatile uint32_t bloqueosConLugar;		//ticks con la transmisora bloqueada y lugar libre
+
+
+/*==================[Definicion de tareas para el OS]==========================*/
+
+void productor(void)  {
+	uint32_t dato = 0;
+
+	while(1)  {
+		os_ColaWrite(&colaDatos,&dato);
+		dato++;
+	}
+}
+
+
+void consumidor(void)  {
+	uint32_t dato;
+
+	while(1)  {
+		os_ColaRead(&colaDatos,&dato);
+		elementosLeidos++;
+	}
+}
+
+
+void evento(void)  {
+	while(1)  {
+		os_SemaforoTake(&semEvento);
+		eventosAtendidos++;
+	}
+}
+
+
+/*
+ * El manejador corre con mas prioridad que el gestor, por lo que cuando os_CreateTask retorna
+ * ya termino y se elimino, y la misma estructura puede reutilizarse en el siguiente pedido
+ */
+void manejador(void)  {
+	manejadoresEjecutados++;
+	os_DeleteTask(NULL);
+}
+
+
+void gestor(void)  {
+	while(1)  {
+		os_Delay(PERIODO_MANEJADOR);
+		os_CreateTask(manejador, &g_sManejador, PRIORIDAD_0);
+	}
+}
+
+
+void transmisor(void)  {
+	uint8_t bloque[TAM_ESCRITURA_UART];
+	uint8_t dato = 0;
+
+	while(1)  {
+		for (uint16_t i = 0; i < TAM_ESCRITURA_UART; i++)
+			bloque[i] = dato++;
+
+		os_UartTxWrite(&uartTx, bloque, TAM_ESCRITURA_UART);
+	}
+}
+
+
+void reporte(void)  {
+	uint32_t leidos_previo = 0, eventos_previo = 0, cambios_previo = 0, manejadores_previo = 0;
+	uint32_t uart_previo = 0;
+	uint32_t leidos, eventos, cambios, manejadores, uart;
+
+	for (uint32_t segundo = 1; segundo <= SEGUNDOS_MEDICION; segundo++)  {
+		os_Delay(MILISEC);
+
+		leidos = elementosLeidos;
+		eventos = eventosAtendidos;
+		cambios = os_PortCambiosContexto();
+		manejadores = manejadoresEjecutados;
+		uart = bytesUart;
+
+		printf("t=%u cola_elem_s=%u irq_eventos_s=%u cambios_contexto_s=%u manejadores_s=%u "
+				"uart_bytes_s=%u uart_errores=%u uart_bloqueos_con_lugar=%u\n",
+				segundo, leidos - leidos_previo, eventos - eventos_previo, cambios - cambios_previo,
+				manejadores - manejadores_previo, uart - uart_previo, erroresUart, bloqueosConLugar);
+		fflush(stdout);
+
+		leidos_previo = leidos;
+		eventos_previo = eventos;
+		cambios_previo = cambios;
+		manejadores_previo = manejadores;
+		uart_previo = uart;
+	}
+
+	exit(0);
+}
+
+
+/*==================[periferico simulado]==========================*/
+
+void evento_ISR(void)  {
+	os_SemaforoGive(&semEvento);
+}
+
+
+static void* perifericoSimulado(void* arg)  {
+	(void) arg;
+
+	while(1)  {
+		usleep(PERIODO_IRQ_US);
+		os_PortDispararIRQ(PIN_INT0_IRQn);
+	}
+
+	return NULL;
+}
+
+
+/*
+ * Se llama desde el hilo del host que emula el DMA, con los bytes que salen por la linea
+ */
+static void salidaUart(const uint8_t* datos, uint32_t cantidad)  {
+	static uint8_t esperado;
+
+	for (uint32_t i = 0; i < cantidad; i++)  {
+		if (datos[i] != esperado)
+			erroresUart++;
+
+		esperado = datos[i] + 1;
+	}
+
+	bytesUart += cantidad;
+}
+
+
+/*
+ * El handler del DMA libera lugar y desbloquea a la transmisora en la misma interrupcion,
+ * por lo que desde el SysTick nunca deberia verse bloqueada con lugar en el buffer
+ */
+void tickHook(void)  {
+	if (g_sTransmisor.estado == TAREA_BLOCKED && os_UartTxPendientes(&uartTx) < TAM_BUFFER_UART)
+		bloqueosConLugar++;
+}
+
+
+/*============================================================================*/
+
+int main(void)  {
+	pthread_t hilo;
+	sigset_t mascara, previa;
+
+	Board_Init();
+
+	/*
+	 * Los hilos auxiliares del host deben bloquear las señales que emulan las interrupciones,
+	 * para que siempre se atiendan en el hilo que corre el OS
+	 */
+	sigemptyset(&mascara);
+	sigaddset(&mascara, SIGALRM);
+	sigaddset(&mascara, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &mascara, &previa);
+	pthread_create(&hilo, NULL, perifericoSimulado, NULL);
+	pthread_sigmask(SIG_SETMASK, &previa, NULL);
+
+	os_InitTarea(productor, &g_sProductor, PRIORIDAD_1);
+	os_InitTarea(consumidor, &g_sConsumidor, PRIORIDAD_1);
+	os_InitTarea(evento, &g_sEvento, PRIORIDAD_1);
+	os_InitTarea(gestor, &g_sGestor, PRIORIDAD_1);
+	os_InitTarea(transmisor, &g_sTransmisor, PRIORIDAD_1);
+	os_InitTarea(reporte, &g_sReporte, PRIORIDAD_0);
+
+	os_ColaInit(&colaDatos,sizeof(uint32_t));
+	os_SemaforoInit(&semEvento);
+
+	Chip_UART_SetBaud(LPC_USART2, BAUDIOS_UART);
+	os_PortUartSalida(LPC_USART2, salidaUart);
+	os_UartTxInit(&uartTx, LPC_USART2, GPDMA_CONN_UART2_Tx, bufferUart, TAM_BUFFER_UART);
+
+	os_InstalarIRQ(PIN_INT0_IRQn,evento_ISR);
+	os_Init();
+
+	SysTick_Config(SystemCoreClock / MILISEC);		//systick 1ms
+
+	while (1) {
+		__WFI();
+	}
+}
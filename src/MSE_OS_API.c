@@ -9,6 +9,9 @@
 #include "MSE_OS_API.h"
 
 
+static void notificarConjunto(struct _conjunto* conjunto);
+
+
 /*************************************************************************************************
 	 *  @brief delay no preciso en base a ticks del sistema
      *
@@ -44,24 +47,26 @@ void os_Delay(uint32_t ticks)  {
 
 		//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 		tarea_actual = os_getTareaActual();
-		tarea_actual->ticks_bloqueada = ticks;
-		//----------------------------------------------------------------------------------------------------
-
-		os_exit_critical();
+		os_DemorarTarea(tarea_actual,ticks);
 
 		/*
 		 * El proximo bloque while tiene la finalidad de asegurarse que la tarea solo se desbloquee
 		 * en el momento que termine la cuenta de ticks. Si por alguna razon la tarea se vuelve a
 		 * ejecutar antes que termine el periodo de bloqueado, queda atrapada.
-		 * La bandera delay activo es puesta en false por el SysTick. En teoria esto no deberia volver
-		 * a ejecutarse dado que el scheduler no vuelve a darle CPU hasta que no pase a estado READY
-		 *
+		 * El contador lo descuenta el SysTick, que desbloquea la tarea al llegar a cero. La
+		 * comprobacion y el bloqueo se hacen dentro de la seccion critica para que el SysTick
+		 * no pueda vencer el delay entre ambos y dejar la tarea bloqueada sin demora pendiente
 		 */
-
 		while (tarea_actual->ticks_bloqueada > 0)  {
-			tarea_actual->estado = TAREA_BLOCKED;
+			os_BloquearTarea(tarea_actual);
+
+			os_exit_critical();
 			os_CpuYield();
+			os_enter_critical();
 		}
+		//----------------------------------------------------------------------------------------------------
+
+		os_exit_critical();
 	}
 }
 
@@ -79,6 +84,7 @@ void os_Delay(uint32_t ticks)  {
 void os_SemaforoInit(osSemaforo* sem)  {
 	sem->tomado = true;
 	sem->tarea_asociada = NULL;
+	sem->conjunto = NULL;
 }
 
 
@@ -115,14 +121,13 @@ void os_SemaforoTake(osSemaforo* sem)  {
 		 * Se agrega una seccion critica al momento de obtener la tarea actual e
 		 * interactuar con su estado
 		 */
-		if(sem->tomado)  {
-			os_enter_critical();
+		os_enter_critical();
 
-			//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+		//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+		if(sem->tomado)  {
 			tarea_actual = os_getTareaActual();
-			tarea_actual->estado = TAREA_BLOCKED;
+			os_BloquearTarea(tarea_actual);
 			sem->tarea_asociada = tarea_actual;
-			//---------------------------------------------------------------------------
 
 			os_exit_critical();
 			os_CpuYield();
@@ -130,7 +135,10 @@ void os_SemaforoTake(osSemaforo* sem)  {
 		else  {
 			sem->tomado = true;
 			Salir = true;
+
+			os_exit_critical();
 		}
+		//---------------------------------------------------------------------------
 
 	}
 }
@@ -154,17 +162,62 @@ void os_SemaforoGive(osSemaforo* sem)  {
 	 * libera y se actualiza la tarea correspondiente a estado ready.
 	 */
 
+	os_enter_critical();
+
+	/*
+	 * os_DesbloquearTarea indica ademas la necesidad de un scheduling si es llamada desde
+	 * una interrupcion, porque seguramente existe una tarea esperando este evento
+	 */
 	if (sem->tomado == true &&	sem->tarea_asociada != NULL)  {
 		sem->tomado = false;
-		sem->tarea_asociada->estado = TAREA_READY;
-
-		/*
-		 * Si es llamada desde una interrupcion, se debe indicar que es necesario efectuar
-		 * un scheduling, porque seguramente existe una tarea esperando este evento
-		 */
-		if (os_getEstadoSistema() == OS_IRQ_RUN)
-			 os_setScheduleDesdeISR(true);
+		os_DesbloquearTarea(sem->tarea_asociada);
 	}
+
+	/*
+	 * Un semaforo de un conjunto se libera aunque nadie lo este esperando todavia,
+	 * porque la tarea del conjunto lo toma despues de que os_ConjuntoEsperar lo
+	 * encuentre libre
+	 */
+	else if (sem->tomado == true && sem->conjunto != NULL)
+		sem->tomado = false;
+
+	if (!sem->tomado)
+		notificarConjunto(sem->conjunto);
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Tomar un semaforo sin bloquearse
+     *
+     *  @details
+     *   Si el semaforo esta libre lo toma. Si no, deja a la tarea como asociada sin
+     *   bloquearla, de modo que el proximo give libera el semaforo y despierta a la tarea si
+     *   en ese momento esta bloqueada por otro motivo. Lo usa el ejecutor de corrutinas, que
+     *   espera los eventos de todas sus corrutinas en un solo bloqueo. Si otra tarea ya
+     *   esta bloqueada en os_SemaforoTake no se la reemplaza, porque no volveria a despertar.
+     *
+	 *  @param		sem		Semaforo a tomar
+	 *  @return     true si lo tomo.
+***************************************************************************************************/
+bool os_SemaforoTakeSinEspera(osSemaforo* sem)  {
+	bool tomado;
+
+	os_enter_critical();
+
+	tomado = !sem->tomado;
+
+	if (tomado)
+		sem->tomado = true;
+	else if (os_getEstadoSistema() != OS_IRQ_RUN &&
+			(sem->tarea_asociada == NULL || sem->tarea_asociada->estado != TAREA_BLOCKED))
+		sem->tarea_asociada = os_getTareaActual();
+
+	os_exit_critical();
+
+	return tomado;
 }
 
 
@@ -194,6 +247,7 @@ void os_ColaInit(osCola* cola, uint16_t datasize)  {
 	cola->indice_tail = 0;
 	cola->tarea_asociada = NULL;
 	cola->size_elemento = datasize;
+	cola->conjunto = NULL;
 }
 
 
@@ -212,39 +266,9 @@ void os_ColaWrite(osCola* cola, void* dato)  {
 	uint16_t elementos_total;		//variable para legibilidad
 	tarea* tarea_actual;
 
-	index_h = cola->indice_head * cola->size_elemento;
 	elementos_total = QUEUE_HEAP_SIZE / cola->size_elemento;
 
 
-	/*
-	 * el primer bloque determina tres cosas, que gracias a la disposicion de los
-	 * parentesis se dan en un orden especifico:
-	 * 1) Se determina si head == tail, con lo que la cola estaria vacia
-	 * 2) Sobre el resultado de 1) se determina si existe una tarea asociada
-	 * 3) Si la cola esta vacia, y el puntero a la tarea asociada es valido, se
-	 * 		verifica si la tarea asociada esta bloqueada
-	 * Estas condiciones en ese orden determinan si se trato de leer de una cola vacia
-	 * y la tarea que quizo leer se bloqueo porque la misma estaba vacia. Como
-	 * seguramente en este punto se escribe un dato a la misma, esa tarea tiene que
-	 * pasar a ready
-	 */
-
-	if(((cola->indice_head == cola->indice_tail) && cola->tarea_asociada != NULL) &&
-		cola->tarea_asociada->estado == TAREA_BLOCKED)  {
-
-		cola->tarea_asociada->estado = TAREA_READY;
-
-		/*
-		 * Si es llamada desde una interrupcion, se debe indicar que es necesario efectuar
-		 * un scheduling, porque seguramente existe una tarea esperando este evento
-		 */
-		if (os_getEstadoSistema() == OS_IRQ_RUN)
-			os_setScheduleDesdeISR(true);
-
-	}
-
-
-
 	 /*
 	 * En el caso de que se quiera escribir una cola desde un ISR y este
 	 * llena, la operacion es abortada (no se puede bloquear un handler)
@@ -260,20 +284,22 @@ void os_ColaWrite(osCola* cola, void* dato)  {
 	/*
 	 * El siguiente bloque while determina que hasta que la cola no tenga lugar
 	 * disponible, no se avance. Si no tiene lugar se bloquea la tarea actual
-	 * que es la que esta tratando de escribir y luego se hace un yield
+	 * que es la que esta tratando de escribir y luego se hace un yield.
+	 * La condicion de cola llena se evalua dentro de la seccion critica: si se
+	 * evaluara fuera, el lector podria vaciar la cola y bloquearse entre la
+	 * comprobacion y el bloqueo de esta tarea, y ninguna de las dos despertaria
 	 */
-	while((cola->indice_head + 1) % elementos_total == cola->indice_tail)  {
-
-		os_enter_critical();
+	os_enter_critical();
 
-		//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	while((cola->indice_head + 1) % elementos_total == cola->indice_tail)  {
 		tarea_actual = os_getTareaActual();
-		tarea_actual->estado = TAREA_BLOCKED;
+		os_BloquearTarea(tarea_actual);
 		cola->tarea_asociada = tarea_actual;
-		//---------------------------------------------------------------------------
 
 		os_exit_critical();
 		os_CpuYield();
+		os_enter_critical();
 	}
 
 	/*
@@ -282,13 +308,27 @@ void os_ColaWrite(osCola* cola, void* dato)  {
 	 * primer elemento. Como data es un vector del tipo uint8_t, la aritmetica
 	 * de punteros es byte a byte (consecutivos) y se logra el efecto deseado
 	 * Esto permite guardar datos definidos por el usuario, como ser estructuras
-	 * de datos completas. Luego se actualiza el undice head y se limpia la tarea
-	 * asociada, dado que ese puntero ya no tiene utilidad
+	 * de datos completas. Luego se actualiza el undice head
 	 */
-
+	index_h = cola->indice_head * cola->size_elemento;
 	memcpy(cola->data+index_h,dato,cola->size_elemento);
 	cola->indice_head = (cola->indice_head + 1) % elementos_total;
+
+	/*
+	 * Si existe una tarea asociada bloqueada, es una tarea que quiso leer de la cola
+	 * vacia. Como ahora la cola tiene al menos un dato, esa tarea tiene que pasar a
+	 * ready. Luego se limpia la tarea asociada, dado que ese puntero ya no tiene utilidad.
+	 * Todo esto ocurre en la misma seccion critica que la escritura, para que el lector
+	 * no pueda registrarse entre la actualizacion del indice y la limpieza del puntero
+	 */
+	if(cola->tarea_asociada != NULL)
+		os_DesbloquearTarea(cola->tarea_asociada);
+
 	cola->tarea_asociada = NULL;
+	notificarConjunto(cola->conjunto);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
 }
 
 void os_ColaRead(osCola* cola, void* dato)  {
@@ -297,38 +337,9 @@ void os_ColaRead(osCola* cola, void* dato)  {
 	tarea* tarea_actual;
 
 
-	index_t = cola->indice_tail * cola->size_elemento;
 	elementos_total = QUEUE_HEAP_SIZE / cola->size_elemento;
 
 
-	/*
-	 * el primer bloque determina tres cosas, que gracias a la disposicion de los
-	 * parentesis se dan en un orden especifico:
-	 * 1) Se determina si la cola esta llena (head+1)%CANT_ELEMENTOS == tail
-	 * 2) Sobre el resultado de 1) se determina si existe una tarea asociada
-	 * 3) Si la cola esta llena, y el puntero a la tarea asociada es valido, se
-	 * 		verifica si la tarea asociada esta bloqueada
-	 * Estas condiciones en ese orden determinan si se trato de escribir en una cola
-	 * llena y la tarea que quizo escribir se bloqueo porque la misma estaba llena. Como
-	 * seguramente en este punto se lee un dato de la misma, esa tarea tiene que
-	 * pasar a ready
-	 */
-
-	if((( (cola->indice_head + 1) % elementos_total == cola->indice_tail) &&
-			cola->tarea_asociada != NULL) &&
-			cola->tarea_asociada->estado == TAREA_BLOCKED)  {
-
-		cola->tarea_asociada->estado = TAREA_READY;
-
-		/*
-		 * Si es llamada desde una interrupcion, se debe indicar que es necesario efectuar
-		 * un scheduling, porque seguramente existe una tarea esperando este evento
-		 */
-		if (os_getEstadoSistema() == OS_IRQ_RUN)
-			os_setScheduleDesdeISR(true);
-	}
-
-
 	/*
 	 * En el caso de que se quiera leer una cola desde un ISR y este
 	 * vacia, la operacion es abortada (no se puede bloquear un handler)
@@ -341,20 +352,20 @@ void os_ColaRead(osCola* cola, void* dato)  {
 	/*
 	 * El siguiente bloque while determina que hasta que la cola no tenga un dato
 	 * disponible, no se avance. Si no hay un dato que leer, se bloquea la tarea
-	 * actual que es la que esta tratando de leer un dato y luego se hace un yield
+	 * actual que es la que esta tratando de leer un dato y luego se hace un yield.
+	 * Igual que en la escritura, la condicion se evalua dentro de la seccion critica
 	 */
+	os_enter_critical();
 
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 	while(cola->indice_head == cola->indice_tail)  {
-		os_enter_critical();
-
-		//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
 		tarea_actual = os_getTareaActual();
-		tarea_actual->estado = TAREA_BLOCKED;
+		os_BloquearTarea(tarea_actual);
 		cola->tarea_asociada = tarea_actual;
-		//---------------------------------------------------------------------------
 
 		os_exit_critical();
 		os_CpuYield();
+		os_enter_critical();
 	}
 
 	/*
@@ -363,13 +374,1378 @@ void os_ColaRead(osCola* cola, void* dato)  {
 	 * primer elemento. Como data es un vector del tipo uint8_t, la aritmetica
 	 * de punteros es byte a byte (consecutivos) y se logra el efecto deseado
 	 * Esto permite guardar datos definidos por el usuario, como ser estructuras
-	 * de datos completas. Luego se actualiza el undice head y se limpia la tarea
-	 * asociada, dado que ese puntero ya no tiene utilidad
+	 * de datos completas. Luego se actualiza el undice tail
 	 */
-
+	index_t = cola->indice_tail * cola->size_elemento;
 	memcpy(dato,cola->data+index_t,cola->size_elemento);
 	cola->indice_tail = (cola->indice_tail + 1) % elementos_total;
+
+	/*
+	 * Si existe una tarea asociada bloqueada, es una tarea que quiso escribir en la cola
+	 * llena. Ahora hay lugar, por lo que pasa a ready y se limpia la tarea asociada
+	 */
+	if(cola->tarea_asociada != NULL)
+		os_DesbloquearTarea(cola->tarea_asociada);
+
 	cola->tarea_asociada = NULL;
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Leer de una cola sin bloquearse
+     *
+     *  @details
+     *   Si la cola tiene un dato lo lee con os_ColaRead, que entonces no se bloquea. Si esta
+     *   vacia deja a la tarea como asociada sin bloquearla, como os_SemaforoTakeSinEspera,
+     *   para que la proxima escritura la despierte si esta bloqueada por otro motivo. Si otra
+     *   tarea ya esta bloqueada en os_ColaRead no se la reemplaza.
+     *
+	 *  @param		cola	Cola de donde leer
+	 *  @param		dato	Donde copiar el dato
+	 *  @return     true si leyo un dato.
+***************************************************************************************************/
+bool os_ColaReadSinEspera(osCola* cola, void* dato)  {
+	bool hay_dato;
+
+	os_enter_critical();
+
+	hay_dato = cola->indice_head != cola->indice_tail;
+
+	if (hay_dato)
+		os_ColaRead(cola, dato);
+	else if (os_getEstadoSistema() != OS_IRQ_RUN &&
+			(cola->tarea_asociada == NULL || cola->tarea_asociada->estado != TAREA_BLOCKED))
+		cola->tarea_asociada = os_getTareaActual();
+
+	os_exit_critical();
+
+	return hay_dato;
+}
+
+
+
+/*
+ * La tarea lectora espera mientras no haya los bytes que pidio, salvo que se haya forzado
+ * la lectura con os_StreamBufferForzarLectura y haya al menos un byte
+ */
+#define LECTURA_PENDIENTE(sb)	\
+	((sb)->cantidad < (sb)->bytes_esperados && !((sb)->lectura_forzada && (sb)->cantidad > 0))
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de un stream buffer
+     *
+     *  @details
+     *   La memoria la provee el usuario y debe tener al menos tamanio bytes. Un nivel de
+     *   disparo 0 equivale a 1, y uno mayor al tamaño se limita al tamaño, ya que de otro
+     *   modo la tarea lectora no despertaria nunca.
+     *
+	 *  @param		sb				Puntero al stream buffer a inicializar
+	 *  @param		memoria			Memoria para los datos del stream
+	 *  @param		tamanio			Capacidad en bytes
+	 *  @param		nivel_disparo	Bytes minimos para despertar a la tarea lectora
+	 *  @return     None.
+***************************************************************************************************/
+void os_StreamBufferInit(osStreamBuffer* sb, uint8_t* memoria, uint16_t tamanio, uint16_t nivel_disparo)  {
+	sb->memoria = memoria;
+	sb->tamanio = tamanio;
+	sb->indice_head = 0;
+	sb->indice_tail = 0;
+	sb->cantidad = 0;
+	sb->bytes_esperados = 0;
+	sb->espacio_esperado = 0;
+	sb->lectura_forzada = false;
+	sb->tarea_lectora = NULL;
+	sb->tarea_escritora = NULL;
+
+	os_StreamBufferSetNivelDisparo(sb, nivel_disparo);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Nivel de disparo efectivo de un stream buffer
+     *
+     *  @details
+     *   Los stream buffers inicializados con OS_STREAM_BUFFER_INICIALIZADOR no pasan por
+     *   os_StreamBufferSetNivelDisparo, por lo que el rango se asegura tambien aca.
+     *
+	 *  @param		sb		Stream buffer
+	 *  @return     Nivel de disparo entre 1 y el tamaño del stream.
+***************************************************************************************************/
+static uint16_t nivelDisparo(osStreamBuffer* sb)  {
+	if (sb->nivel_disparo == 0)
+		return 1;
+
+	return sb->nivel_disparo > sb->tamanio ? sb->tamanio : sb->nivel_disparo;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Copia datos al stream y avanza el indice head
+     *
+     *  @details
+     *   Copia lo que entre, en a lo sumo dos memcpy (antes y despues de dar la vuelta al
+     *   buffer). Debe llamarse dentro de una seccion critica.
+     *
+	 *  @param		sb			Stream buffer
+	 *  @param		datos		Datos a escribir
+	 *  @param		cantidad	Bytes a escribir
+	 *  @return     Bytes copiados.
+***************************************************************************************************/
+static uint16_t copiarEntrada(osStreamBuffer* sb, const uint8_t* datos, uint16_t cantidad)  {
+	uint16_t libre = sb->tamanio - sb->cantidad;
+	uint16_t tramo;
+
+	if (cantidad > libre)
+		cantidad = libre;
+
+	tramo = sb->tamanio - sb->indice_head;
+	if (tramo > cantidad)
+		tramo = cantidad;
+
+	memcpy(sb->memoria + sb->indice_head, datos, tramo);
+	memcpy(sb->memoria, datos + tramo, cantidad - tramo);
+
+	sb->indice_head += cantidad;
+	if (sb->indice_head >= sb->tamanio)
+		sb->indice_head -= sb->tamanio;
+	sb->cantidad += cantidad;
+
+	return cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Copia datos del stream y avanza el indice tail
+     *
+     *  @details
+     *   Igual que copiarEntrada pero en sentido inverso. Debe llamarse dentro de una
+     *   seccion critica.
+     *
+	 *  @param		sb			Stream buffer
+	 *  @param		destino		Donde copiar los datos
+	 *  @param		maximo		Bytes maximos a leer
+	 *  @return     Bytes copiados.
+***************************************************************************************************/
+static uint16_t copiarSalida(osStreamBuffer* sb, uint8_t* destino, uint16_t maximo)  {
+	uint16_t cantidad = sb->cantidad;
+	uint16_t tramo;
+
+	if (cantidad > maximo)
+		cantidad = maximo;
+
+	tramo = sb->tamanio - sb->indice_tail;
+	if (tramo > cantidad)
+		tramo = cantidad;
+
+	memcpy(destino, sb->memoria + sb->indice_tail, tramo);
+	memcpy(destino + tramo, sb->memoria, cantidad - tramo);
+
+	sb->indice_tail += cantidad;
+	if (sb->indice_tail >= sb->tamanio)
+		sb->indice_tail -= sb->tamanio;
+	sb->cantidad -= cantidad;
+
+	return cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a la tarea lectora si ya hay los bytes que espera
+     *
+     *  @details
+     *   A diferencia de la cola, no se despierta en cada escritura: con un nivel de disparo
+     *   N la lectora pasa a ready una sola vez, cuando se alcanzan los N bytes. Debe
+     *   llamarse dentro de una seccion critica.
+     *
+	 *  @param		sb		Stream buffer
+	 *  @return     None.
+***************************************************************************************************/
+static void despertarLectora(osStreamBuffer* sb)  {
+	if (sb->tarea_lectora != NULL && !LECTURA_PENDIENTE(sb))  {
+		os_DesbloquearTarea(sb->tarea_lectora);
+		sb->tarea_lectora = NULL;
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a la tarea escritora si ya hay el espacio que espera
+     *
+	 *  @param		sb		Stream buffer
+	 *  @return     None.
+***************************************************************************************************/
+static void despertarEscritora(osStreamBuffer* sb)  {
+	if (sb->tarea_escritora != NULL && sb->tamanio - sb->cantidad >= sb->espacio_esperado)  {
+		os_DesbloquearTarea(sb->tarea_escritora);
+		sb->tarea_escritora = NULL;
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Escritura en un stream buffer
+     *
+     *  @details
+     *   Escribe cantidad bytes de longitud arbitraria. Si el resto a escribir no entra, la
+     *   tarea se bloquea hasta que entre todo o hasta que el stream se vacie si es mas
+     *   largo que el buffer, con lo que una escritura que entra en el buffer nunca se
+     *   intercala con la de otra tarea y la escritora no se despierta por cada byte leido.
+     *   Desde un handler no se puede bloquear: se escribe lo que entra, y si no entra todo
+     *   se genera el warning WARN_OS_STREAM_LLENO_ISR.
+     *
+	 *  @param		sb			Stream buffer donde escribir
+	 *  @param		datos		Datos a escribir
+	 *  @param		cantidad	Cantidad de bytes a escribir
+	 *  @return     Bytes escritos (cantidad, salvo desde un handler).
+	 *  @warning	Solo una tarea puede estar bloqueada escribiendo a la vez, igual que en
+	 *  			las colas
+***************************************************************************************************/
+uint16_t os_StreamBufferWrite(osStreamBuffer* sb, const void* datos, uint16_t cantidad)  {
+	const uint8_t* origen = datos;
+	uint16_t escritos = 0;
+	uint16_t restante;
+	tarea* tarea_actual;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		escritos = copiarEntrada(sb, origen, cantidad);
+		if (escritos < cantidad)
+			os_setWarning(WARN_OS_STREAM_LLENO_ISR);
+	}
+	else  {
+		while (escritos < cantidad)  {
+			restante = cantidad - escritos;
+			sb->espacio_esperado = restante < sb->tamanio ? restante : sb->tamanio;
+
+			/*
+			 * Igual que en las colas, la condicion se evalua dentro de la seccion critica
+			 * para que la lectora no pueda liberar espacio entre la comprobacion y el
+			 * bloqueo de esta tarea
+			 */
+			while (sb->tamanio - sb->cantidad < sb->espacio_esperado)  {
+				tarea_actual = os_getTareaActual();
+				os_BloquearTarea(tarea_actual);
+				sb->tarea_escritora = tarea_actual;
+
+				os_exit_critical();
+				os_CpuYield();
+				os_enter_critical();
+			}
+
+			escritos += copiarEntrada(sb, origen + escritos, restante);
+			despertarLectora(sb);
+		}
+	}
+
+	despertarLectora(sb);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
 
+	return escritos;
 }
 
+
+/*************************************************************************************************
+	 *  @brief Lectura de un stream buffer
+     *
+     *  @details
+     *   Si hay menos bytes que el nivel de disparo (o que maximo, si es menor) la tarea se
+     *   bloquea hasta que los haya, y luego lee todos los disponibles hasta maximo. Desde un
+     *   handler no se bloquea y se leen los bytes disponibles, que pueden ser cero.
+     *
+	 *  @param		sb			Stream buffer de donde leer
+	 *  @param		datos		Donde copiar los datos leidos
+	 *  @param		maximo		Cantidad maxima de bytes a leer
+	 *  @return     Bytes leidos.
+***************************************************************************************************/
+uint16_t os_StreamBufferRead(osStreamBuffer* sb, void* datos, uint16_t maximo)  {
+	uint16_t leidos;
+	tarea* tarea_actual;
+
+	if (maximo == 0)
+		return 0;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if (os_getEstadoSistema() != OS_IRQ_RUN)  {
+		sb->bytes_esperados = nivelDisparo(sb);
+		if (sb->bytes_esperados > maximo)
+			sb->bytes_esperados = maximo;
+
+		while (LECTURA_PENDIENTE(sb))  {
+			tarea_actual = os_getTareaActual();
+			os_BloquearTarea(tarea_actual);
+			sb->tarea_lectora = tarea_actual;
+
+			os_exit_critical();
+			os_CpuYield();
+			os_enter_critical();
+		}
+	}
+
+	leidos = copiarSalida(sb, datos, maximo);
+
+	/*
+	 * Una lectura forzada que no llevo todos los bytes deja el resto para la siguiente,
+	 * que tambien vuelve sin esperar el nivel de disparo
+	 */
+	if (sb->cantidad == 0)
+		sb->lectura_forzada = false;
+
+	despertarEscritora(sb);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return leidos;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Acceso directo al bloque contiguo de datos del stream
+     *
+     *  @details
+     *   Se bloquea como os_StreamBufferRead hasta alcanzar el nivel de disparo y devuelve
+     *   un puntero al primer byte sin leer y la cantidad de bytes contiguos desde ahi (los
+     *   que estan despues de dar la vuelta al buffer quedan para el siguiente bloque). Los
+     *   datos no se consumen hasta llamar a os_StreamBufferLiberar, lo que permite por
+     *   ejemplo entregarlos a un DMA sin copiarlos. Desde un handler no se bloquea.
+     *
+	 *  @param		sb		Stream buffer de donde leer
+	 *  @param		bloque	Donde devolver el puntero al bloque
+	 *  @return     Cantidad de bytes contiguos en el bloque.
+***************************************************************************************************/
+uint16_t os_StreamBufferLeerBloque(osStreamBuffer* sb, uint8_t** bloque)  {
+	uint16_t cantidad;
+	tarea* tarea_actual;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if (os_getEstadoSistema() != OS_IRQ_RUN)  {
+		sb->bytes_esperados = nivelDisparo(sb);
+
+		while (LECTURA_PENDIENTE(sb))  {
+			tarea_actual = os_getTareaActual();
+			os_BloquearTarea(tarea_actual);
+			sb->tarea_lectora = tarea_actual;
+
+			os_exit_critical();
+			os_CpuYield();
+			os_enter_critical();
+		}
+	}
+
+	cantidad = sb->tamanio - sb->indice_tail;
+	if (cantidad > sb->cantidad)
+		cantidad = sb->cantidad;
+
+	*bloque = sb->memoria + sb->indice_tail;
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Consume bytes del stream leidos con os_StreamBufferLeerBloque
+     *
+	 *  @param		sb			Stream buffer
+	 *  @param		cantidad	Bytes a consumir, como maximo los del ultimo bloque
+	 *  @return     None.
+***************************************************************************************************/
+void os_StreamBufferLiberar(osStreamBuffer* sb, uint16_t cantidad)  {
+	os_enter_critical();
+
+	if (cantidad > sb->cantidad)
+		cantidad = sb->cantidad;
+
+	sb->indice_tail += cantidad;
+	if (sb->indice_tail >= sb->tamanio)
+		sb->indice_tail -= sb->tamanio;
+	sb->cantidad -= cantidad;
+
+	if (sb->cantidad == 0)
+		sb->lectura_forzada = false;
+
+	despertarEscritora(sb);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Acceso directo al bloque contiguo libre del stream
+     *
+     *  @details
+     *   Devuelve un puntero a la posicion de escritura y la cantidad de bytes libres
+     *   contiguos desde ahi. No se bloquea, por lo que puede usarse desde un handler (por
+     *   ejemplo para que un DMA escriba directamente en el stream). Los datos escritos
+     *   quedan disponibles al llamar a os_StreamBufferConfirmar.
+     *
+	 *  @param		sb		Stream buffer donde escribir
+	 *  @param		bloque	Donde devolver el puntero al bloque
+	 *  @return     Cantidad de bytes libres contiguos, que puede ser cero.
+***************************************************************************************************/
+uint16_t os_StreamBufferReservarBloque(osStreamBuffer* sb, uint8_t** bloque)  {
+	uint16_t cantidad;
+
+	os_enter_critical();
+
+	cantidad = sb->tamanio - sb->indice_head;
+	if (cantidad > sb->tamanio - sb->cantidad)
+		cantidad = sb->tamanio - sb->cantidad;
+
+	*bloque = sb->memoria + sb->indice_head;
+
+	os_exit_critical();
+
+	return cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Publica bytes escritos en un bloque de os_StreamBufferReservarBloque
+     *
+	 *  @param		sb			Stream buffer
+	 *  @param		cantidad	Bytes escritos, como maximo los del ultimo bloque reservado
+	 *  @return     None.
+***************************************************************************************************/
+void os_StreamBufferConfirmar(osStreamBuffer* sb, uint16_t cantidad)  {
+	os_enter_critical();
+
+	if (cantidad > sb->tamanio - sb->cantidad)
+		cantidad = sb->tamanio - sb->cantidad;
+
+	sb->indice_head += cantidad;
+	if (sb->indice_head >= sb->tamanio)
+		sb->indice_head -= sb->tamanio;
+	sb->cantidad += cantidad;
+
+	despertarLectora(sb);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de bytes disponibles para leer en un stream buffer
+     *
+	 *  @param		sb		Stream buffer
+	 *  @return     Bytes almacenados.
+***************************************************************************************************/
+uint16_t os_StreamBufferDisponible(osStreamBuffer* sb)  {
+	return sb->cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Hace volver a la tarea lectora aunque no se alcance el nivel de disparo
+     *
+     *  @details
+     *   La proxima lectura (o la que esta bloqueada) vuelve con los bytes disponibles, siempre
+     *   que haya al menos uno, y las siguientes tambien hasta que se consuman todos. Permite que un productor marque el fin de un mensaje mas corto
+     *   que el nivel de disparo, por ejemplo al recibir un delimitador o al quedar la linea
+     *   inactiva. Puede llamarse desde un handler.
+     *
+	 *  @param		sb		Stream buffer
+	 *  @return     None.
+***************************************************************************************************/
+void os_StreamBufferForzarLectura(osStreamBuffer* sb)  {
+	os_enter_critical();
+
+	sb->lectura_forzada = true;
+	despertarLectora(sb);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cambia el nivel de disparo de un stream buffer
+     *
+     *  @details
+     *   Si hay una tarea lectora bloqueada se vuelve a evaluar su condicion con el nuevo
+     *   nivel, con lo que bajar el nivel puede despertarla.
+     *
+	 *  @param		sb				Stream buffer
+	 *  @param		nivel_disparo	Bytes minimos para despertar a la tarea lectora
+	 *  @return     None.
+***************************************************************************************************/
+void os_StreamBufferSetNivelDisparo(osStreamBuffer* sb, uint16_t nivel_disparo)  {
+	os_enter_critical();
+
+	sb->nivel_disparo = nivel_disparo;
+	sb->nivel_disparo = nivelDisparo(sb);
+
+	if (sb->tarea_lectora != NULL && sb->bytes_esperados > sb->nivel_disparo)  {
+		sb->bytes_esperados = sb->nivel_disparo;
+		despertarLectora(sb);
+	}
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de un conjunto de colas y semaforos
+     *
+	 *  @param		conjunto	Conjunto a inicializar, sin miembros
+	 *  @return     None.
+***************************************************************************************************/
+void os_ConjuntoInit(osConjunto* conjunto)  {
+	conjunto->cantidad = 0;
+	conjunto->siguiente = 0;
+	conjunto->tarea_asociada = NULL;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega un miembro a un conjunto
+     *
+	 *  @param		conjunto	Conjunto
+	 *  @param		objeto		Cola o semaforo, ya inicializado
+	 *  @param		tipo		Tipo del objeto
+	 *  @param		pertenencia	Campo conjunto del objeto
+	 *  @return     false si el conjunto esta lleno o el objeto ya pertenece a un conjunto.
+***************************************************************************************************/
+static bool agregarMiembro(osConjunto* conjunto, void* objeto, tipoMiembro tipo,
+		struct _conjunto** pertenencia)  {
+	bool agregado = false;
+
+	os_enter_critical();
+
+	if (conjunto->cantidad < OS_CONJUNTO_MAX_MIEMBROS && *pertenencia == NULL)  {
+		conjunto->miembros[conjunto->cantidad].objeto = objeto;
+		conjunto->miembros[conjunto->cantidad].tipo = tipo;
+		conjunto->cantidad++;
+		*pertenencia = conjunto;
+		agregado = true;
+	}
+
+	os_exit_critical();
+
+	return agregado;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega una cola a un conjunto
+     *
+     *  @details
+     *   La cola queda lista para el conjunto cuando tiene al menos un dato. Se la sigue
+     *   leyendo con os_ColaRead, que no se bloquea si os_ConjuntoEsperar la devolvio.
+     *
+	 *  @param		conjunto	Conjunto
+	 *  @param		cola		Cola, ya inicializada
+	 *  @return     false si el conjunto esta lleno o la cola ya pertenece a un conjunto.
+***************************************************************************************************/
+bool os_ConjuntoAgregarCola(osConjunto* conjunto, osCola* cola)  {
+	return agregarMiembro(conjunto, cola, MIEMBRO_COLA, &cola->conjunto);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega un semaforo a un conjunto
+     *
+     *  @details
+     *   El semaforo queda listo para el conjunto cuando esta libre, y se lo toma con
+     *   os_SemaforoTake. A diferencia de un semaforo fuera de un conjunto, un give sin
+     *   ninguna tarea esperando lo deja libre.
+     *
+	 *  @param		conjunto	Conjunto
+	 *  @param		sem			Semaforo, ya inicializado
+	 *  @return     false si el conjunto esta lleno o el semaforo ya pertenece a un conjunto.
+***************************************************************************************************/
+bool os_ConjuntoAgregarSemaforo(osConjunto* conjunto, osSemaforo* sem)  {
+	return agregarMiembro(conjunto, sem, MIEMBRO_SEMAFORO, &sem->conjunto);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a la tarea que espera en un conjunto
+     *
+     *  @details
+     *   La llaman la escritura de una cola y el give de un semaforo cuando el miembro
+     *   queda listo. Debe llamarse dentro de una seccion critica.
+     *
+	 *  @param		conjunto	Conjunto del miembro, puede ser NULL
+	 *  @return     None.
+***************************************************************************************************/
+static void notificarConjunto(struct _conjunto* conjunto)  {
+	if (conjunto != NULL && conjunto->tarea_asociada != NULL)  {
+		os_DesbloquearTarea(conjunto->tarea_asociada);
+		conjunto->tarea_asociada = NULL;
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Busca un miembro listo en un conjunto
+     *
+     *  @details
+     *   Recorre los miembros empezando por el siguiente al ultimo devuelto, para que un
+     *   miembro con datos continuos no oculte a los demas. Debe llamarse dentro de una
+     *   seccion critica.
+     *
+	 *  @param		conjunto	Conjunto
+	 *  @return     Cola o semaforo listo, o NULL si no hay ninguno.
+***************************************************************************************************/
+static void* buscarListo(osConjunto* conjunto)  {
+	miembroConjunto* miembro;
+	osCola* cola;
+	uint8_t indice = conjunto->siguiente;
+
+	for (uint8_t i = 0; i < conjunto->cantidad; i++)  {
+		if (indice >= conjunto->cantidad)
+			indice = 0;
+
+		miembro = &conjunto->miembros[indice++];
+
+		if (miembro->tipo == MIEMBRO_COLA)  {
+			cola = miembro->objeto;
+			if (cola->indice_head == cola->indice_tail)
+				continue;
+		}
+		else if (((osSemaforo*) miembro->objeto)->tomado)
+			continue;
+
+		conjunto->siguiente = indice;
+		return miembro->objeto;
+	}
+
+	return NULL;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Espera hasta que algun miembro de un conjunto este listo
+     *
+     *  @details
+     *   Si ningun miembro esta listo la tarea se bloquea, y la despierta la proxima
+     *   escritura en una de las colas o give de uno de los semaforos. El miembro devuelto
+     *   no se consume: la tarea debe leerlo con os_ColaRead o tomarlo con os_SemaforoTake,
+     *   que no se bloquean mientras sea la unica que lo usa. Desde un handler no se
+     *   bloquea.
+     *
+	 *  @param		conjunto	Conjunto donde esperar
+	 *  @return     Puntero a la cola o al semaforo listo, para compararlo con los miembros.
+	 *  			Desde un handler, NULL si no habia ninguno listo.
+***************************************************************************************************/
+void* os_ConjuntoEsperar(osConjunto* conjunto)  {
+	void* listo;
+	tarea* tarea_actual;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	listo = buscarListo(conjunto);
+
+	/*
+	 * Igual que en las colas, la condicion se evalua dentro de la seccion critica para
+	 * que ningun miembro pueda quedar listo entre la busqueda y el bloqueo
+	 */
+	if (os_getEstadoSistema() != OS_IRQ_RUN)  {
+		while (listo == NULL)  {
+			tarea_actual = os_getTareaActual();
+			os_BloquearTarea(tarea_actual);
+			conjunto->tarea_asociada = tarea_actual;
+
+			os_exit_critical();
+			os_CpuYield();
+			os_enter_critical();
+
+			listo = buscarListo(conjunto);
+		}
+
+		conjunto->tarea_asociada = NULL;
+	}
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return listo;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de un lock de lectura y escritura
+     *
+	 *  @param		lock	Lock a inicializar, queda libre
+	 *  @return     None.
+***************************************************************************************************/
+void os_RWLockInit(osRWLock* lock)  {
+	os_ListaEsperaInit(&lock->lectoras);
+	os_ListaEsperaInit(&lock->escritoras);
+	lock->escritora = NULL;
+	lock->lectoras_activas = 0;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Toma un lock para leer
+     *
+     *  @details
+     *   Si ninguna escritora tiene el lock ni esta esperando, la tarea entra junto con las
+     *   demas lectoras sin bloquearse. Si no, espera en la lista de lectoras del lock.
+     *
+	 *  @param		lock	Lock a tomar
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_RWLockLeer(osRWLock* lock)  {
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_BLOQUEO_FROM_ISR, os_RWLockLeer);
+		return;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	while (lock->escritora != NULL || lock->escritoras.primera != NULL)
+		os_EsperarEnLista(&lock->lectoras);
+
+	lock->lectoras_activas++;
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Entrega un lock a la siguiente escritora en espera
+     *
+     *  @details
+     *   Igual que entregarMutex: la escritora de mayor prioridad en espera queda con el lock
+     *   antes de despertarse, por lo que las lectoras que lleguen hasta que corra esperan en
+     *   vez de adelantarse. Si no hay escritoras el lock queda libre. Debe llamarse dentro de
+     *   una seccion critica.
+     *
+	 *  @param		lock	Lock a entregar
+	 *  @return     true si habia una escritora en espera.
+***************************************************************************************************/
+static bool entregarEscritura(osRWLock* lock)  {
+	lock->escritora = lock->escritoras.primera;
+	return os_DespertarPrimera(&lock->escritoras);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Libera un lock tomado para leer
+     *
+     *  @details
+     *   La ultima lectora en salir entrega el lock a la escritora en espera de mayor
+     *   prioridad.
+     *
+	 *  @param		lock	Lock a liberar
+	 *  @return     None.
+***************************************************************************************************/
+void os_RWLockLiberarLectura(osRWLock* lock)  {
+	os_enter_critical();
+
+	if (lock->lectoras_activas > 0 && --lock->lectoras_activas == 0)
+		entregarEscritura(lock);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Toma un lock para escribir
+     *
+     *  @details
+     *   Espera hasta que no haya lectoras ni otra escritora con el lock, o hasta que el lock
+     *   le sea entregado al liberarse. Mientras espera, las lectoras nuevas tambien esperan,
+     *   aunque el lock este tomado para leer.
+     *
+	 *  @param		lock	Lock a tomar
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_RWLockEscribir(osRWLock* lock)  {
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_BLOQUEO_FROM_ISR, os_RWLockEscribir);
+		return;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	while (lock->escritora != os_getTareaActual() &&
+			(lock->escritora != NULL || lock->lectoras_activas > 0))
+		os_EsperarEnLista(&lock->escritoras);
+
+	lock->escritora = os_getTareaActual();
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Libera un lock tomado para escribir
+     *
+     *  @details
+     *   Si hay escritoras esperando entrega el lock a la de mayor prioridad; si no, despierta
+     *   a todas las lectoras, que corren en orden de prioridad.
+     *
+	 *  @param		lock	Lock a liberar
+	 *  @return     None.
+***************************************************************************************************/
+void os_RWLockLiberarEscritura(osRWLock* lock)  {
+	os_enter_critical();
+
+	if (!entregarEscritura(lock))
+		os_DespertarTodas(&lock->lectoras);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de un mutex
+     *
+	 *  @param		mutex	Mutex a inicializar, queda libre
+	 *  @return     None.
+***************************************************************************************************/
+void os_MutexInit(osMutex* mutex)  {
+	os_ListaEsperaInit(&mutex->esperando);
+	mutex->propietaria = NULL;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Espera hasta tener un mutex
+     *
+     *  @details
+     *   Debe llamarse dentro de una seccion critica. Si el mutex esta libre lo toma; si no,
+     *   espera a que la dueña se lo entregue al liberarlo.
+     *
+	 *  @param		mutex		Mutex a tomar
+	 *  @param		tarea_actual	Tarea que lo toma
+	 *  @return     None.
+***************************************************************************************************/
+static void tomarMutex(osMutex* mutex, tarea* tarea_actual)  {
+	while (mutex->propietaria != tarea_actual)  {
+		if (mutex->propietaria == NULL)
+			mutex->propietaria = tarea_actual;
+		else
+			os_EsperarEnLista(&mutex->esperando);
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Entrega un mutex a la siguiente tarea en espera
+     *
+     *  @details
+     *   La tarea de mayor prioridad en espera pasa a ser la dueña antes de despertarse, por
+     *   lo que otra tarea que llegue mientras tanto no puede quitarselo. Debe llamarse dentro
+     *   de una seccion critica.
+     *
+	 *  @param		mutex	Mutex a entregar
+	 *  @return     None.
+***************************************************************************************************/
+static void entregarMutex(osMutex* mutex)  {
+	mutex->propietaria = mutex->esperando.primera;
+	os_DespertarPrimera(&mutex->esperando);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Toma un mutex
+     *
+	 *  @param		mutex	Mutex a tomar
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS. Una tarea que
+	 *  			ya tiene el mutex no debe volver a tomarlo.
+***************************************************************************************************/
+void os_MutexTomar(osMutex* mutex)  {
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_BLOQUEO_FROM_ISR, os_MutexTomar);
+		return;
+	}
+
+	os_enter_critical();
+	tomarMutex(mutex, os_getTareaActual());
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Libera un mutex
+     *
+	 *  @param		mutex	Mutex a liberar
+	 *  @return     None.
+	 *  @warning	Solo la tarea que tiene el mutex puede liberarlo; si no, produce un error de
+	 *  			OS
+***************************************************************************************************/
+void os_MutexLiberar(osMutex* mutex)  {
+
+	/*
+	 * Si la tarea actual es la dueña nadie mas puede cambiar la dueña, por lo que la
+	 * comprobacion no necesita la seccion critica
+	 */
+	if (os_getEstadoSistema() == OS_IRQ_RUN || mutex->propietaria != os_getTareaActual())  {
+		os_setError(ERR_OS_MUTEX_AJENO, os_MutexLiberar);
+		return;
+	}
+
+	os_enter_critical();
+	entregarMutex(mutex);
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de una variable de condicion
+     *
+	 *  @param		cond	Variable a inicializar, sin tareas en espera
+	 *  @return     None.
+***************************************************************************************************/
+void os_CondicionInit(osCondicion* cond)  {
+	os_ListaEsperaInit(&cond->esperando);
+	cond->mutex = NULL;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Espera un aviso en una variable de condicion
+     *
+     *  @details
+     *   Libera el mutex y bloquea a la tarea en la misma seccion critica, por lo que un aviso
+     *   dado apenas se libera el mutex no se pierde. Al recibir el aviso vuelve a tomar el
+     *   mutex antes de retornar. La tarea puede volver sin que la condicion se cumpla (otra
+     *   tarea la consumio antes, o la desperto un os_Resume), por lo que debe esperar en un
+     *   ciclo que reevalua la condicion:
+     *
+     *     os_MutexTomar(&mutex);
+     *     while (nivel <= umbral)
+     *         os_CondicionEsperar(&cond, &mutex);
+     *     ...
+     *     os_MutexLiberar(&mutex);
+     *
+	 *  @param		cond	Variable donde esperar
+	 *  @param		mutex	Mutex que protege la condicion, tomado por la tarea
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler ni sin tener el mutex, produce un error
+	 *  			de OS
+***************************************************************************************************/
+void os_CondicionEsperar(osCondicion* cond, osMutex* mutex)  {
+	tarea* tarea_actual;
+
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_BLOQUEO_FROM_ISR, os_CondicionEsperar);
+		return;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	tarea_actual = os_getTareaActual();
+
+	if (mutex->propietaria != tarea_actual)  {
+		os_exit_critical();
+		os_setError(ERR_OS_MUTEX_AJENO, os_CondicionEsperar);
+		return;
+	}
+
+	cond->mutex = mutex;
+	entregarMutex(mutex);
+	os_EsperarEnLista(&cond->esperando);
+
+	tomarMutex(mutex, tarea_actual);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a una tarea de una variable de condicion
+     *
+     *  @details
+     *   Si quien avisa tiene el mutex, la tarea no se despierta para volver a bloquearse en
+     *   el mutex: se la pasa directamente a la lista de espera del mutex, y corre recien
+     *   cuando se lo entregan. Puede llamarse desde un handler, por ejemplo cuando cambia
+     *   el nivel de un buffer.
+     *
+	 *  @param		cond	Variable de condicion
+	 *  @return     true si habia una tarea esperando.
+***************************************************************************************************/
+static bool avisar(osCondicion* cond)  {
+	osMutex* mutex = cond->mutex;
+
+	if (mutex != NULL && os_getEstadoSistema() != OS_IRQ_RUN &&
+			mutex->propietaria == os_getTareaActual())
+		return os_TrasladarPrimera(&cond->esperando, &mutex->esperando);
+
+	return os_DespertarPrimera(&cond->esperando);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Avisa a la tarea de mayor prioridad que espera en una variable de condicion
+     *
+	 *  @param		cond	Variable de condicion
+	 *  @return     None.
+***************************************************************************************************/
+void os_CondicionSenalar(osCondicion* cond)  {
+	os_enter_critical();
+	avisar(cond);
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Avisa a todas las tareas que esperan en una variable de condicion
+     *
+     *  @details
+     *   Las tareas toman el mutex de a una, por orden de prioridad.
+     *
+	 *  @param		cond	Variable de condicion
+	 *  @return     None.
+***************************************************************************************************/
+void os_CondicionDifundir(osCondicion* cond)  {
+	os_enter_critical();
+
+	while (avisar(cond))
+		;
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de una cola con prioridad
+     *
+     *  @details
+     *   La memoria la provee el usuario, declarada con OS_COLA_PRIORIDAD_MEMORIA o de al menos
+     *   OS_COLA_PRIORIDAD_TAMANIO(capacidad, datasize) bytes alineados a 4. Todas las
+     *   posiciones de datos quedan libres.
+     *
+	 *  @param		cola		Cola a inicializar
+	 *  @param		memoria		Memoria para las entradas del heap y los mensajes
+	 *  @param		capacidad	Cantidad maxima de mensajes, hasta 32767
+	 *  @param		datasize	Tamaño de los mensajes, pasado con sizeof()
+	 *  @return     None.
+***************************************************************************************************/
+void os_ColaPrioridadInit(osColaPrioridad* cola, void* memoria, uint16_t capacidad, uint16_t datasize)  {
+	cola->heap = memoria;
+	cola->datos = (uint8_t*) memoria + OS_COLA_PRIORIDAD_OFFSET_DATOS(capacidad);
+	cola->capacidad = capacidad;
+	cola->cantidad = 0;
+	cola->size_elemento = datasize;
+	cola->secuencia = 0;
+	os_ListaEsperaInit(&cola->lectoras);
+	os_ListaEsperaInit(&cola->escritoras);
+
+	for (uint16_t i = 0; i < capacidad; i++)
+		cola->heap[i].posicion = i;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Indica si un mensaje debe leerse antes que otro
+     *
+     *  @details
+     *   La secuencia se compara por diferencia, por lo que sigue siendo correcta cuando da la
+     *   vuelta mientras dos mensajes de la cola difieran en menos de 32768 escrituras. El
+     *   limite no es la cantidad de mensajes sino la antigüedad: si un mensaje queda en la
+     *   cola mientras se escriben 32768 o mas (por ejemplo uno de baja prioridad postergado
+     *   por un flujo continuo de mensajes urgentes), los nuevos de su misma prioridad pasan
+     *   a verse como anteriores a el.
+     *
+	 *  @param		a		Entrada del heap
+	 *  @param		b		Entrada del heap
+	 *  @return     true si a es mas urgente, o igual de urgente y mas antiguo.
+***************************************************************************************************/
+static bool mensajeAntes(const mensajePrioridad* a, const mensajePrioridad* b)  {
+	if (a->prioridad != b->prioridad)
+		return a->prioridad < b->prioridad;
+
+	return (int16_t) (a->secuencia - b->secuencia) < 0;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Sube una entrada del heap hasta su lugar
+     *
+	 *  @param		heap	Entradas del heap
+	 *  @param		i		Posicion de la entrada
+	 *  @return     None.
+***************************************************************************************************/
+static void subirMensaje(mensajePrioridad* heap, uint16_t i)  {
+	mensajePrioridad mensaje = heap[i];
+	uint16_t padre;
+
+	while (i > 0)  {
+		padre = (i - 1) / 2;
+		if (!mensajeAntes(&mensaje, &heap[padre]))
+			break;
+
+		heap[i] = heap[padre];
+		i = padre;
+	}
+
+	heap[i] = mensaje;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Baja una entrada del heap hasta su lugar
+     *
+	 *  @param		heap		Entradas del heap
+	 *  @param		cantidad	Entradas en uso
+	 *  @param		i			Posicion de la entrada
+	 *  @return     None.
+***************************************************************************************************/
+static void bajarMensaje(mensajePrioridad* heap, uint16_t cantidad, uint16_t i)  {
+	mensajePrioridad mensaje = heap[i];
+	uint16_t hijo;
+
+	while ((hijo = 2 * i + 1) < cantidad)  {
+		if (hijo + 1 < cantidad && mensajeAntes(&heap[hijo + 1], &heap[hijo]))
+			hijo++;
+
+		if (!mensajeAntes(&heap[hijo], &mensaje))
+			break;
+
+		heap[i] = heap[hijo];
+		i = hijo;
+	}
+
+	heap[i] = mensaje;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Escritura en una cola con prioridad
+     *
+     *  @details
+     *   El mensaje se copia a la posicion libre guardada en la primera entrada sin uso del
+     *   heap, y esa entrada sube hasta su lugar segun la prioridad. Si la cola esta llena la
+     *   tarea espera; desde un handler no se bloquea, y si la cola esta llena el mensaje se
+     *   descarta con el warning WARN_OS_QUEUE_FULL_ISR.
+     *
+	 *  @param		cola		Cola donde escribir
+	 *  @param		dato		Mensaje a escribir
+	 *  @param		prioridad	Prioridad del mensaje, 0 es la mas urgente
+	 *  @return     false si se descarto (solo desde un handler).
+***************************************************************************************************/
+bool os_ColaPrioridadWrite(osColaPrioridad* cola, const void* dato, uint8_t prioridad)  {
+	mensajePrioridad* entrada;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		if (cola->cantidad == cola->capacidad)  {
+			os_exit_critical();
+			os_setWarning(WARN_OS_QUEUE_FULL_ISR);
+			return false;
+		}
+	}
+	else  {
+		while (cola->cantidad == cola->capacidad)
+			os_EsperarEnLista(&cola->escritoras);
+	}
+
+	entrada = &cola->heap[cola->cantidad];
+	memcpy(cola->datos + entrada->posicion * cola->size_elemento, dato, cola->size_elemento);
+	entrada->prioridad = prioridad;
+	entrada->secuencia = cola->secuencia++;
+	subirMensaje(cola->heap, cola->cantidad++);
+
+	os_DespertarPrimera(&cola->lectoras);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Lectura de una cola con prioridad
+     *
+     *  @details
+     *   Lee el mensaje de la raiz del heap, el mas urgente. La ultima entrada pasa a la raiz
+     *   y baja hasta su lugar, y la entrada que queda sin uso guarda la posicion liberada.
+     *   Si la cola esta vacia la tarea espera; desde un handler no se bloquea.
+     *
+	 *  @param		cola		Cola de donde leer
+	 *  @param		dato		Donde copiar el mensaje
+	 *  @param		prioridad	Donde devolver la prioridad del mensaje, puede ser NULL
+	 *  @return     false si la cola estaba vacia (solo desde un handler).
+***************************************************************************************************/
+bool os_ColaPrioridadRead(osColaPrioridad* cola, void* dato, uint8_t* prioridad)  {
+	mensajePrioridad raiz;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		if (cola->cantidad == 0)  {
+			os_exit_critical();
+			os_setWarning(WARN_OS_QUEUE_EMPTY_ISR);
+			return false;
+		}
+	}
+	else  {
+		while (cola->cantidad == 0)
+			os_EsperarEnLista(&cola->lectoras);
+	}
+
+	raiz = cola->heap[0];
+	memcpy(dato, cola->datos + raiz.posicion * cola->size_elemento, cola->size_elemento);
+	if (prioridad != NULL)
+		*prioridad = raiz.prioridad;
+
+	cola->cantidad--;
+	cola->heap[0] = cola->heap[cola->cantidad];
+	cola->heap[cola->cantidad].posicion = raiz.posicion;
+	bajarMensaje(cola->heap, cola->cantidad, 0);
+
+	os_DespertarPrimera(&cola->escritoras);
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de mensajes en una cola con prioridad
+     *
+	 *  @param		cola	Cola
+	 *  @return     Mensajes almacenados.
+***************************************************************************************************/
+uint16_t os_ColaPrioridadCantidad(osColaPrioridad* cola)  {
+	return cola->cantidad;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Inicializacion de una notificacion con cuenta
+     *
+	 *  @param		notif		Notificacion a inicializar
+	 *  @param		umbral		Eventos que despiertan a la tarea sin esperar la demora, 1 o mas
+	 *  @param		demora		Ticks maximos que la tarea espera con eventos pendientes sin
+	 *  						llegar al umbral, 0 para esperar siempre el umbral
+	 *  @return     None.
+***************************************************************************************************/
+void os_NotificacionInit(osNotificacion* notif, uint32_t umbral, uint32_t demora)  {
+	os_ListaEsperaInit(&notif->esperando);
+	notif->pendientes = 0;
+	notif->umbral = umbral > 0 ? umbral : 1;
+	notif->demora = demora;
+	notif->demorando = false;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Avisa un evento a una notificacion con cuenta
+     *
+     *  @details
+     *   Pensada para llamarse desde un handler en cada evento. Solo despierta a la tarea
+     *   cuando el evento completa el umbral; el primer evento de un lote incompleto carga la
+     *   demora de la tarea, que la despierta el SysTick. Si la tarea no esta esperando (ya
+     *   fue despertada y esta procesando) solo se cuenta el evento, sin costo de scheduling.
+     *
+	 *  @param		notif		Notificacion
+	 *  @return     None.
+***************************************************************************************************/
+void os_NotificacionDar(osNotificacion* notif)  {
+	tarea* task;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	notif->pendientes++;
+	task = notif->esperando.primera;
+
+	if (task != NULL)  {
+		if (notif->pendientes >= notif->umbral)
+			os_DespertarPrimera(&notif->esperando);
+		else if (notif->demora > 0 && !notif->demorando)  {
+			os_DemorarTarea(task, notif->demora);
+			notif->demorando = true;
+		}
+	}
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Espera un lote de eventos de una notificacion con cuenta
+     *
+     *  @details
+     *   Retorna cuando hay umbral eventos pendientes o, si hay menos, cuando vence la demora
+     *   que empieza con el primer evento pendiente. La demora se lleva con el contador de
+     *   ticks de bloqueo de la tarea, como os_Delay, y se cancela si el umbral se completa
+     *   antes. No se puede llamar desde un handler.
+     *
+	 *  @param		notif		Notificacion
+	 *  @return     Cantidad de eventos del lote, que quedan descontados.
+***************************************************************************************************/
+uint32_t os_NotificacionEsperar(osNotificacion* notif)  {
+	tarea* tarea_actual;
+	uint32_t eventos;
+
+	if (os_getEstadoSistema() == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_BLOQUEO_FROM_ISR, os_NotificacionEsperar);
+		return 0;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	tarea_actual = os_getTareaActual();
+
+	while (notif->pendientes < notif->umbral)  {
+		/*
+		 * Con eventos pendientes la espera se limita a la demora. Si la tarea llega con
+		 * eventos que se acumularon mientras procesaba, la demora empieza ahora; si la
+		 * cargo os_NotificacionDar y el contador ya llego a cero, vencio
+		 */
+		if (notif->pendientes > 0 && notif->demora > 0)  {
+			if (!notif->demorando)  {
+				os_DemorarTarea(tarea_actual, notif->demora);
+				notif->demorando = true;
+			}
+			else if (tarea_actual->ticks_bloqueada == 0)
+				break;
+		}
+
+		os_EsperarEnLista(&notif->esperando);
+	}
+
+	if (notif->demorando)  {
+		os_CancelarDemora(tarea_actual);
+		notif->demorando = false;
+	}
+
+	eventos = notif->pendientes;
+	notif->pendientes = 0;
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	return eventos;
+}
@@ -0,0 +1,145 @@
+/*
+ * MSE_OS_Adc.c
+ *
+ *  Servicio de adquisicion con ADC y GPDMA en ping-pong, ver MSE_OS_Adc.h
+ */
+
+
+#include "MSE_OS_Adc.h"
+
+
+/*************************************************************************************************
+	 *  @brief Fin de un bloque, llamado desde el handler de DMA_IRQn.
+     *
+     *  @details
+     *   El DMA ya paso al bloque siguiente por la lista circular de descriptores. Si la tarea
+     *   todavia tiene ese bloque, el DMA esta pisando datos que no termino de procesar y se
+     *   cuenta un desborde. El bloque recien completado se entrega por la cola, salvo que la
+     *   tarea tampoco lo haya liberado (ya se conto el desborde cuando el DMA empezo a
+     *   escribirlo).
+     *
+	 *  @param 		contexto	Servicio de adquisicion
+	 *  @return     None
+***************************************************************************************************/
+static void finBloque(void* contexto)  {
+	osAdcDMA* adc = contexto;
+	uint8_t lleno = adc->bloque_dma;
+	uint32_t* bloque;
+
+	adc->bloque_dma = (lleno + 1) % OS_ADC_BLOQUES;
+	adc->bloques_completos++;
+
+	if (adc->en_uso[adc->bloque_dma])
+		adc->desbordes++;
+
+	if (adc->en_uso[lleno])
+		return;
+
+	adc->en_uso[lleno] = true;
+	bloque = adc->bloques[lleno];
+	os_ColaWrite(&adc->bloques_llenos, &bloque);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa y arranca la adquisicion.
+     *
+     *  @details
+     *   Configura el ADC en modo burst sobre un canal a la frecuencia pedida y lanza el
+     *   GPDMA sobre la lista circular de descriptores, que genera la interrupcion al
+     *   completar cada bloque.
+     *
+	 *  @param 		adc				Servicio a inicializar
+	 *  @param 		periferico		ADC a utilizar (LPC_ADCn)
+	 *  @param 		conexion_dma	Conexion del GPDMA del ADC (GPDMA_CONN_ADC_n)
+	 *  @param 		canal			Canal del ADC
+	 *  @param 		frecuencia		Frecuencia de muestreo en Hz
+	 *  @return     true si se pudo reservar un canal del GPDMA.
+***************************************************************************************************/
+bool os_AdcInit(osAdcDMA* adc, LPC_ADC_T* periferico, uint32_t conexion_dma, ADC_CHANNEL_T canal,
+		uint32_t frecuencia)  {
+	ADC_CLOCK_SETUP_T configuracion;
+
+	os_ColaInit(&adc->bloques_llenos, sizeof(uint32_t*));
+	adc->adc = periferico;
+	adc->bloque_dma = 0;
+	adc->bloques_completos = 0;
+	adc->desbordes = 0;
+
+	for (uint8_t i = 0; i < OS_ADC_BLOQUES; i++)
+		adc->en_uso[i] = false;
+
+	if (!os_DMAReservarCanal(conexion_dma, finBloque, adc, &adc->canal_dma))
+		return false;
+
+	for (uint8_t i = 0; i < OS_ADC_BLOQUES; i++)  {
+		Chip_GPDMA_PrepareDescriptor(LPC_GPDMA, &adc->descriptores[i], conexion_dma,
+				(uintptr_t) adc->bloques[i], OS_ADC_MUESTRAS_BLOQUE,
+				GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA, &adc->descriptores[(i + 1) % OS_ADC_BLOQUES]);
+		adc->descriptores[i].ctrl |= GPDMA_DMACCxControl_I;
+	}
+
+	Chip_ADC_Init(periferico, &configuracion);
+	Chip_ADC_SetSampleRate(periferico, &configuracion, frecuencia);
+	Chip_ADC_EnableChannel(periferico, canal, ENABLE);
+	Chip_ADC_Int_SetChannelCmd(periferico, canal, ENABLE);
+
+	Chip_GPDMA_SGTransfer(LPC_GPDMA, adc->canal_dma, &adc->descriptores[0],
+			GPDMA_TRANSFERTYPE_P2M_CONTROLLER_DMA);
+	Chip_ADC_SetBurstCmd(periferico, ENABLE);
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Espera el proximo bloque completo.
+     *
+	 *  @param 		adc		Servicio de adquisicion
+	 *  @return     Puntero al bloque de OS_ADC_MUESTRAS_BLOQUE muestras, que debe devolverse
+	 *  			con os_AdcLiberarBloque.
+***************************************************************************************************/
+uint32_t* os_AdcObtenerBloque(osAdcDMA* adc)  {
+	uint32_t* bloque;
+
+	os_ColaRead(&adc->bloques_llenos, &bloque);
+
+	return bloque;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve un bloque al DMA.
+     *
+	 *  @param 		adc		Servicio de adquisicion
+	 *  @param 		bloque	Bloque obtenido con os_AdcObtenerBloque
+	 *  @return     None
+***************************************************************************************************/
+void os_AdcLiberarBloque(osAdcDMA* adc, uint32_t* bloque)  {
+	os_enter_critical();
+
+	for (uint8_t i = 0; i < OS_ADC_BLOQUES; i++)  {
+		if (adc->bloques[i] == bloque)
+			adc->en_uso[i] = false;
+	}
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Convierte muestras del ADC a Q15.
+     *
+     *  @details
+     *   Extrae el resultado de 10 bits del formato del registro GDR, le resta el valor medio
+     *   y lo escala a Q15, para procesarlo con los filtros de MSE_OS_Dsp.
+     *
+	 *  @param 		bloque		Muestras en formato GDR
+	 *  @param 		destino		Muestras en Q15
+	 *  @param 		cantidad	Cantidad de muestras
+	 *  @return     None
+***************************************************************************************************/
+void os_AdcAQ15(const uint32_t* bloque, int16_t* destino, uint16_t cantidad)  {
+	for (uint16_t i = 0; i < cantidad; i++)
+		destino[i] = (int16_t) (((int32_t) ADC_DR_RESULT(bloque[i]) - 512) * 64);
+}
@@ -11,16 +11,78 @@
 
 /*==================[definicion de variables globales]=================================*/
 
-static osControl control_OS;
+static osControl control_OS = {
+	.quantum = { [0 ... PRIORITY_COUNT-1] = OS_QUANTUM_DEFAULT }
+};
 static tarea tareaIdle;
 
+#if OS_PERFIL_CRITICAS
+static perfilCritica perfilSitios[OS_PERFIL_CANT_SITIOS];	//tabla hash por direccion, sondeo lineal
+static perfilCritica copiaPerfil[OS_PERFIL_CANT_SITIOS];	//copia para ordenar fuera de la seccion critica
+static uint32_t sitiosDescartados;							//secciones de puntos que no entraron en la tabla
+
+#if (OS_PERFIL_CANT_SITIOS & (OS_PERFIL_CANT_SITIOS - 1)) != 0
+#error "OS_PERFIL_CANT_SITIOS debe ser potencia de 2"
+#endif
+
+/*
+ * La direccion de retorno solo identifica el punto de llamada si os_enter_critical no se
+ * expande en linea en quien la llama
+ */
+#define INLINE_CRITICA		__attribute__((noinline))
+#else
+#define INLINE_CRITICA		inline
+#endif
+
+#if OS_EDF
+#define TIENE_DEADLINE(t)	((t)->deadline_relativo != OS_SIN_DEADLINE)
+#else
+#define TIENE_DEADLINE(t)	false
+#endif
+
 //----------------------------------------------------------------------------------
 
 /*==================[definicion de prototipos static]=================================*/
 static void initTareaIdle(void);
 static void setPendSV(void);
-static void ordenarPrioridades(void);
-static int32_t partition(tarea** arr, int32_t l, int32_t h);
+static bool crearTarea(void *entryPoint, tarea *task, uint8_t prioridad);
+static void insertarEnLista(tarea* task);
+static void quitarDeLista(tarea* task);
+static void quitarDeDemoradas(tarea* task);
+static void insertarEnEspera(listaEspera* lista, tarea* task);
+static void quitarDeEspera(tarea* task);
+static uint16_t asignarId(void);
+static void evaluarDesalojo(void);
+static void cambiarPrioridad(tarea* task, uint8_t prioridad);
+static void agregarListas(tarea* task);
+static void quitarListas(tarea* task);
+static bool hayDesalojo(tarea* actual);
+#if OS_EDF
+static bool antesQue(tarea* a, tarea* b);
+static void heapIntercambiar(uint16_t i, uint16_t j);
+static void heapSubir(uint16_t i);
+static void heapBajar(uint16_t i);
+static void heapInsertar(tarea* task);
+static void heapQuitar(tarea* task);
+#endif
+#if OS_PRESUPUESTOS
+static void actualizarPresupuestos(tarea* actual);
+static void agotarPresupuesto(tarea* task);
+static void reponerPresupuesto(tarea* task);
+static void quitarDeReposiciones(tarea* task);
+#endif
+#if OS_MONITOR_PERIODICAS
+static void actualizarPeriodicas(void);
+static void registrarRespuesta(tarea* task, uint32_t respuesta);
+static void quitarDePeriodicas(tarea* task);
+#endif
+static void pintarStack(tarea* task);
+#if OS_PERFIL_CRITICAS
+static void registrarSitioCritico(void* sitio, uint32_t duracion);
+#endif
+#if OS_STACK_GUARDA_MPU
+static void setGuardaMPU(tarea* task);
+#endif
 
 
 /*==================[definicion de hooks debiles]=================================*/
@@ -120,6 +182,67 @@ void __attribute__((weak)) idleTask(void)  {
 
 
 
+/*************************************************************************************************
+	 *  @brief Aviso al port de una tarea eliminada
+     *
+     *  @details
+     *   Se llama desde os_DeleteTask luego de quitar la tarea de las estructuras del OS y antes
+     *   de que su memoria pueda reutilizarse. En Cortex-M no hay nada que liberar; los ports que
+     *   asocian recursos propios a cada tarea (como el port POSIX) la redefinen.
+     *
+	 *  @param task		Tarea eliminada
+	 *
+	 *  @return none.
+***************************************************************************************************/
+void __attribute__((weak)) os_PortEliminarTarea(tarea* task)  {
+	(void) task;
+}
+
+
+
+#if OS_PRESUPUESTOS
+/*************************************************************************************************
+	 *  @brief Hook de presupuesto agotado
+     *
+     *  @details
+     *   Se llama desde el SysTick cada vez que una tarea agota su presupuesto de CPU, luego de
+     *   suspenderla o degradarla. Puede redefinirse para registrar la tarea que excede su
+     *   presupuesto; al ejecutarse dentro de un handler debe ser breve.
+     *
+	 *  @param task		Tarea que agoto su presupuesto
+	 *
+	 *  @return none.
+***************************************************************************************************/
+void __attribute__((weak)) presupuestoHook(tarea* task)  {
+	(void) task;
+}
+#endif
+
+
+
+#if OS_MONITOR_PERIODICAS
+/*************************************************************************************************
+	 *  @brief Hook de deadline perdido
+     *
+     *  @details
+     *   Se llama una vez por cada trabajo de una tarea periodica que supera su deadline, en el
+     *   primer tick en que esto ocurre (desde el SysTick) o al terminar el trabajo con
+     *   os_EsperarPeriodo si se detecta recien ahi. Puede redefinirse para registrar el
+     *   evento; debe ser breve.
+     *
+	 *  @param task		Tarea que perdio su deadline
+	 *
+	 *  @return none.
+***************************************************************************************************/
+void __attribute__((weak)) deadlineHook(tarea* task)  {
+	(void) task;
+}
+#endif
+
+
+
+
+
 /*==================[definicion de funciones de OS]=================================*/
 
 
@@ -129,74 +252,310 @@ void __attribute__((weak)) idleTask(void)  {
      *  @details
      *   Inicializa una tarea para que pueda correr en el OS implementado.
      *   Es necesario llamar a esta funcion para cada tarea antes que inicie
-     *   el OS.
+     *   el OS. Para crear tareas con el OS en funcionamiento usar os_CreateTask.
      *
 	 *  @param *entryPoint		Puntero a la tarea que se desea inicializar.
 	 *  @param *task			Puntero a la estructura de control que sera utilizada para
 	 *  						la tarea que se esta inicializando.
 	 *  @return     None.
+	 *  @see 		os_CreateTask
 ***************************************************************************************************/
 void os_InitTarea(void *entryPoint, tarea *task, uint8_t prioridad)  {
-	static uint8_t id = 0;				//el id sera correlativo a medida que se generen mas tareas
 
 	/*
 	 * Al principio se efectua un pequeño checkeo para determinar si llegamos a la cantidad maxima de
 	 * tareas que pueden definirse para este OS. En el caso de que se traten de inicializar mas tareas
 	 * que el numero maximo soportado, se guarda un codigo de error en la estructura de control del OS
 	 * y la tarea no se inicializa. La tarea idle debe ser exceptuada del conteo de cantidad maxima
-	 * de tareas
+	 * de tareas. Tampoco se inicializan tareas con una prioridad fuera del rango configurado
 	 */
 
-	if(control_OS.cantidad_Tareas < MAX_TASK_COUNT)  {
-
-		task->stack[STACK_SIZE/4 - XPSR] = INIT_XPSR;					//necesario para bit thumb
-		task->stack[STACK_SIZE/4 - PC_REG] = (uint32_t)entryPoint;		//direccion de la tarea (ENTRY_POINT)
-		task->stack[STACK_SIZE/4 - LR] = (uint32_t)returnHook;			//Retorno de la tarea (no deberia darse)
+	if(prioridad > MIN_PRIORITY)  {
+		os_setError(ERR_OS_PRIORIDAD,os_InitTarea);
+	}
 
+	else if(!crearTarea(entryPoint,task,prioridad))  {
 		/*
-		 * El valor previo de LR (que es EXEC_RETURN en este caso) es necesario dado que
-		 * en esta implementacion, se llama a una funcion desde dentro del handler de PendSV
-		 * con lo que el valor de LR se modifica por la direccion de retorno para cuando
-		 * se termina de ejecutar getContextoSiguiente
+		 * En el caso que se hayan excedido la cantidad de tareas que se pueden definir, se actualiza
+		 * el ultimo error generado en la estructura de control del OS y se llama a errorHook y se
+		 * envia informacion de quien es quien la invoca.
 		 */
-		task->stack[STACK_SIZE/4 - LR_PREV_VALUE] = EXEC_RETURN;
+		os_setError(ERR_OS_CANT_TAREAS,os_InitTarea);
+	}
+}
 
-		task->stack_pointer = (uint32_t) (task->stack + STACK_SIZE/4 - FULL_STACKING_SIZE);
 
-		/*
-		 * En esta seccion se guarda el entry point de la tarea, se le asigna id a la misma y se pone
-		 * la misma en estado READY. Todas las tareas se crean en estado READY.
-		 * Se asigna la prioridad de la misma.
-		 */
-		task->entry_point = entryPoint;
-		task->id = id;
-		task->estado = TAREA_READY;
-		task->prioridad = prioridad;
+/*************************************************************************************************
+	 *  @brief Crea una tarea con el OS en funcionamiento.
+     *
+     *  @details
+     *   Equivalente a os_InitTarea pero puede llamarse desde cualquier tarea luego de os_Init.
+     *   La tarea se inserta en la posicion que le corresponde por prioridad sin reordenar el
+     *   resto, y si tiene mayor prioridad que la tarea que la crea, la desaloja inmediatamente.
+     *   Quedarse sin lugar para tareas no es un error de sistema: se informa con el valor de
+     *   retorno y el warning WARN_OS_CANT_TAREAS, para que la aplicacion pueda reintentar luego
+     *   de eliminar otras tareas.
+     *
+	 *  @param *entryPoint		Puntero a la tarea que se desea crear.
+	 *  @param *task			Estructura de control de la tarea. Puede reutilizarse la de
+	 *  						una tarea eliminada.
+	 *  @param prioridad		Prioridad de la tarea, entre MAX_PRIORITY y MIN_PRIORITY.
+	 *  @return     true si la tarea fue creada.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+bool os_CreateTask(void *entryPoint, tarea *task, uint8_t prioridad)  {
+	bool creada;
 
-		/*
-		 * Actualizacion de la estructura de control del OS, guardando el puntero a la estructura de tarea
-		 * que se acaba de inicializar, y se actualiza la cantidad de tareas definidas en el sistema.
-		 * Luego se incrementa el contador de id, dado que se le otorga un id correlativo a cada tarea
-		 * inicializada, segun el orden en que se inicializan.
-		 */
-		control_OS.listaTareas[id] = task;
-		control_OS.cantidad_Tareas++;
-		control_OS.cantTareas_prioridad[prioridad]++;
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_CreateTask);
+		return false;
+	}
 
-		id++;
+	if(prioridad > MIN_PRIORITY)  {
+		os_setError(ERR_OS_PRIORIDAD,os_CreateTask);
+		return false;
 	}
 
-	else {
-		/*
-		 * En el caso que se hayan excedido la cantidad de tareas que se pueden definir, se actualiza
-		 * el ultimo error generado en la estructura de control del OS y se llama a errorHook y se
-		 * envia informacion de quien es quien la invoca.
-		 */
-		os_setError(ERR_OS_CANT_TAREAS,os_InitTarea);
+	os_enter_critical();
+	creada = crearTarea(entryPoint,task,prioridad);
+	os_exit_critical();
+
+	if(creada)
+		evaluarDesalojo();
+	else
+		os_setWarning(WARN_OS_CANT_TAREAS);
+
+	return creada;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Elimina una tarea.
+     *
+     *  @details
+     *   Quita la tarea de la lista de tareas, de la lista de demoradas y de la lista de espera
+     *   en la que este y libera su id, con lo que su estructura de control puede reutilizarse
+     *   en cuanto la funcion retorna. Si la tarea se elimina a si misma la funcion no retorna,
+     *   y su memoria puede reutilizarse cuando otra tarea ya esta en ejecucion.
+     *
+	 *  @param task		Tarea a eliminar, NULL para la tarea actual
+	 *  @return     None.
+	 *  @warning	La tarea no debe estar esperando en un semaforo ni en una cola, porque estos
+	 *  			guardan un puntero a la tarea que esperan.
+	 *  @warning	La tarea no debe tener ni estar esperando un osMutex o un osRWLock (tampoco
+	 *  			en os_CondicionEsperar). Nada libera lo que la tarea tiene tomado, y a una
+	 *  			tarea en espera se le puede haber entregado el mutex, o se la puede haber
+	 *  			despertado como siguiente escritora, sin que llegue a correr: las demas
+	 *  			tareas quedarian esperando para siempre.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_DeleteTask(tarea* task)  {
+
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_DeleteTask);
+		return;
+	}
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL || task == &tareaIdle)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_DeleteTask);
+		return;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if(task->estado != TAREA_DELETED)  {
+		quitarDeLista(task);
+
+		if(task->ticks_bloqueada > 0)
+			quitarDeDemoradas(task);
+
+		if(task->lista_espera != NULL)
+			quitarDeEspera(task);
+
+#if OS_PRESUPUESTOS
+		if(task->ticks_reposicion > 0)
+			quitarDeReposiciones(task);
+#endif
+
+#if OS_MONITOR_PERIODICAS
+		if(task->periodo > 0)
+			quitarDePeriodicas(task);
+#endif
+
+		control_OS.idsUsados[task->id / 32] &= ~(1UL << (task->id % 32));
+		task->estado = TAREA_DELETED;
+
+		os_PortEliminarTarea(task);
+	}
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+
+	/*
+	 * Si la tarea se elimino a si misma ya no esta RUNNING, por lo que el yield siempre
+	 * cambia de contexto y nunca vuelve aqui
+	 */
+	if(task == control_OS.tarea_actual)
+		os_CpuYield();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Suspende una tarea.
+     *
+     *  @details
+     *   La tarea deja de ser elegible por el scheduler hasta que se llame a os_Resume, sin
+     *   importar los eventos que esperaba. Si estaba bloqueada en un delay, semaforo o cola, la
+     *   espera sigue su curso pero no la despierta; al reanudarse la tarea vuelve a evaluar la
+     *   condicion que esperaba y, si no se cumplio, se bloquea nuevamente. Puede llamarse desde
+     *   un handler.
+     *
+	 *  @param task		Tarea a suspender, NULL para la tarea actual
+	 *  @return     None.
+	 *  @see 		os_Resume
+***************************************************************************************************/
+void os_Suspend(tarea* task)  {
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL || task == &tareaIdle)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_Suspend);
+		return;
+	}
+
+	os_enter_critical();
+
+	os_BloquearTarea(task);
+	if(task->estado == TAREA_BLOCKED || task->estado == TAREA_AGOTADA)
+		task->estado = TAREA_SUSPENDED;
+
+	os_exit_critical();
+
+	evaluarDesalojo();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Reanuda una tarea suspendida.
+     *
+     *  @details
+     *   La tarea vuelve a estado READY y si tiene mayor prioridad que la actual la desaloja
+     *   (al salir del handler, si se llama desde uno). Si la tarea no estaba suspendida no se
+     *   hace nada. Una tarea que tiene su presupuesto agotado sigue esperando la reposicion.
+     *
+	 *  @param task		Tarea a reanudar
+	 *  @return     None.
+	 *  @see 		os_Suspend
+***************************************************************************************************/
+void os_Resume(tarea* task)  {
+
+	os_enter_critical();
+
+	if(task->estado == TAREA_SUSPENDED)  {
+		task->estado = TAREA_BLOCKED;
+#if OS_PRESUPUESTOS
+		if(task->presupuesto != OS_SIN_PRESUPUESTO && task->presupuesto_restante == 0)
+			task->estado = TAREA_AGOTADA;
+#endif
+		os_DesbloquearTarea(task);
+	}
+
+	os_exit_critical();
+
+	evaluarDesalojo();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cambia la prioridad de una tarea.
+     *
+     *  @details
+     *   Mueve la tarea a la subseccion de su nueva prioridad en la lista de tareas, al final de
+     *   las de igual prioridad, y actualiza las estructuras del scheduler. Si como resultado
+     *   existe una tarea lista de mayor prioridad que la actual, se produce el desalojo. Si la
+     *   tarea esta degradada por agotar su presupuesto, la nueva prioridad se aplica recien en
+     *   la reposicion.
+     *
+	 *  @param task			Tarea a modificar, NULL para la tarea actual
+	 *  @param prioridad	Nueva prioridad, entre MAX_PRIORITY y MIN_PRIORITY
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_SetPriority(tarea* task, uint8_t prioridad)  {
+
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_SetPriority);
+		return;
+	}
+
+	if(prioridad > MIN_PRIORITY)  {
+		os_setError(ERR_OS_PRIORIDAD,os_SetPriority);
+		return;
+	}
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL || task == &tareaIdle || task->estado == TAREA_DELETED)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_SetPriority);
+		return;
+	}
+
+	os_enter_critical();
+
+#if OS_PRESUPUESTOS
+	if(task->degradada)
+		task->prioridad_base = prioridad;
+	else
+#endif
+	cambiarPrioridad(task, prioridad);
+
+	os_exit_critical();
+
+	evaluarDesalojo();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Carga el estado inicial del scheduler desde una tabla precalculada.
+     *
+     *  @details
+     *   Reemplaza las llamadas a os_InitTarea cuando las tareas se definen estaticamente con
+     *   OS_TAREA_INICIALIZADOR: sus stacks ya estan armados y la tabla trae la lista de tareas
+     *   ordenada por prioridad y las cantidades por prioridad, por lo que el arranque se
+     *   reduce a copiar la tabla desde flash. Las tareas deben tener los ids 0 a
+     *   cantidad_Tareas - 1. Debe llamarse antes de os_Init y de cualquier otra creacion de
+     *   tareas, que luego pueden agregarse normalmente.
+     *
+	 *  @param 		tabla	Tabla generada para el conjunto de tareas
+	 *  @return     None.
+***************************************************************************************************/
+void os_CargarTablaEstatica(const osTablaEstatica* tabla)  {
+	uint16_t resto = tabla->cantidad_Tareas;
+
+	memcpy(control_OS.listaTareas, tabla->listaTareas, tabla->cantidad_Tareas * sizeof(tarea*));
+	memcpy(control_OS.cantTareas_prioridad, tabla->cantTareas_prioridad, sizeof(control_OS.cantTareas_prioridad));
+	memcpy(control_OS.cantListas_prioridad, tabla->cantTareas_prioridad, sizeof(control_OS.cantListas_prioridad));
+	memcpy(control_OS.inicioPrioridad, tabla->inicioPrioridad, sizeof(control_OS.inicioPrioridad));
+	control_OS.prioridadesListas = tabla->prioridadesListas;
+	control_OS.cantidad_Tareas = tabla->cantidad_Tareas;
+
+	/*
+	 * Todas las tareas de la tabla se crean READY, y sus ids ocupan los primeros bits
+	 */
+	for (uint16_t i = 0; i < (MAX_TASK_COUNT + 31) / 32; i++)  {
+		control_OS.idsUsados[i] = (resto >= 32) ? 0xFFFFFFFF : (1UL << resto) - 1;
+		resto = (resto >= 32) ? resto - 32 : 0;
 	}
 }
 
 
+
 /*************************************************************************************************
 	 *  @brief Inicializa el OS.
      *
@@ -216,6 +575,29 @@ void os_Init(void)  {
 	 */
 	NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS)-1);
 
+#if OS_STACK_GUARDA_MPU
+	/*
+	 * Con la guarda por MPU habilitada, se activa el MPU con el mapa de memoria por defecto
+	 * para modo privilegiado (PRIVDEFENA) y solo se agrega la region de guarda, que se
+	 * reprograma en cada cambio de contexto. Se habilita MemManage para que el desborde
+	 * no escale a HardFault
+	 */
+	MPU->CTRL = MPU_CTRL_ENABLE_Msk | MPU_CTRL_PRIVDEFENA_Msk;
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk;
+	__DSB();
+	__ISB();
+#endif
+
+#if OS_LATENCIA_IRQ || OS_PERFIL_CRITICAS
+	/*
+	 * Contador de ciclos para las mediciones de latencia y de secciones criticas
+	 */
+	OS_CICLOS_INIT();
+#endif
+#if OS_LATENCIA_IRQ
+	control_OS.critico_max = 0;
+#endif
+
 	/*
 	 * Es necesaria la inicializacion de la tarea idle, la cual no es visible al usuario
 	 * El usuario puede eventualmente poblarla de codigo o redefinirla, pero no debe
@@ -235,16 +617,19 @@ void os_Init(void)  {
 
 	/*
 	 * El vector de tareas termina de inicializarse asignando NULL a las posiciones que estan
-	 * luego de la ultima tarea. Esta situacion se da cuando se definen menos de 8 tareas.
-	 * Estrictamente no existe necesidad de esto, solo es por seguridad.
+	 * luego de la ultima tarea. Esta situacion se da cuando se definen menos de MAX_TASK_COUNT
+	 * tareas. Estrictamente no existe necesidad de esto, solo es por seguridad.
 	 */
 
-	for (uint8_t i = 0; i < MAX_TASK_COUNT; i++)  {
+	for (uint16_t i = 0; i < MAX_TASK_COUNT; i++)  {
 		if(i>=control_OS.cantidad_Tareas)
 			control_OS.listaTareas[i] = NULL;
 	}
 
-	ordenarPrioridades();
+	/*
+	 * La lista de tareas ya se encuentra ordenada por prioridad, porque cada tarea se inserta
+	 * en la posicion que le corresponde al inicializarla
+	 */
 }
 
 
@@ -275,28 +660,30 @@ int32_t os_getError(void)  {
      *   debe estar siempre presente y el usuario no la inicializa, los argumentos desaparecen
      *   y se toman estructura y entryPoint fijos. Tampoco se contabiliza entre las tareas
      *   disponibles (no se actualiza el contador de cantidad de tareas). El id de esta tarea
-     *   se establece como 255 (0xFF) para indicar que es una tarea especial.
-     *   La prioridad tambien es 255, esta prioridad no existe, pero segun esta implementacion
-     *   tampoco se utiliza
+     *   se establece como ID_TAREA_IDLE para indicar que es una tarea especial.
+     *   La prioridad es PRIORIDAD_IDLE (255), esta prioridad no existe, pero al ser numericamente
+     *   mayor que cualquier otra, cualquier tarea READY la desaloja
      *
 	 *  @param 		None.
 	 *  @return     None
 	 *  @see os_InitTarea
 ***************************************************************************************************/
 static void initTareaIdle(void)  {
+	pintarStack(&tareaIdle);
+
 	tareaIdle.stack[STACK_SIZE/4 - XPSR] = INIT_XPSR;					//necesario para bit thumb
-	tareaIdle.stack[STACK_SIZE/4 - PC_REG] = (uint32_t)idleTask;		//direccion de la tarea (ENTRY_POINT)
-	tareaIdle.stack[STACK_SIZE/4 - LR] = (uint32_t)returnHook;			//Retorno de la tarea (no deberia darse)
+	tareaIdle.stack[STACK_SIZE/4 - PC_REG] = OS_DIRECCION(idleTask);	//direccion de la tarea (ENTRY_POINT)
+	tareaIdle.stack[STACK_SIZE/4 - LR] = OS_DIRECCION(returnHook);		//Retorno de la tarea (no deberia darse)
 
 
 	tareaIdle.stack[STACK_SIZE/4 - LR_PREV_VALUE] = EXEC_RETURN;
-	tareaIdle.stack_pointer = (uint32_t) (tareaIdle.stack + STACK_SIZE/4 - FULL_STACKING_SIZE);
+	tareaIdle.stack_pointer = OS_DIRECCION(tareaIdle.stack + STACK_SIZE/4 - FULL_STACKING_SIZE);
 
 
 	tareaIdle.entry_point = idleTask;
-	tareaIdle.id = 0xFF;
+	tareaIdle.id = ID_TAREA_IDLE;
 	tareaIdle.estado = TAREA_READY;
-	tareaIdle.prioridad = 0xFF;
+	tareaIdle.prioridad = PRIORIDAD_IDLE;
 }
 
 
@@ -307,19 +694,17 @@ static void initTareaIdle(void)  {
      *  @details
      *   Segun el critero al momento de desarrollo, determina que tarea debe ejecutarse luego, y
      *   por lo tanto provee los punteros correspondientes para el cambio de contexto. Esta
-     *   implementacion de scheduler es muy sencilla, del tipo Round-Robin
+     *   implementacion de scheduler es muy sencilla, del tipo Round-Robin con prioridades
      *
 	 *  @param 		None.
 	 *  @return     None.
 ***************************************************************************************************/
 static void scheduler(void)  {
-	static uint8_t indicePrioridad[PRIORITY_COUNT];		//indice de tareas a ejecutar segun prioridad
-	uint8_t indiceArrayTareas = 0;
-	uint8_t prioridad_actual = MAX_PRIORITY;			//Maxima prioridad al iniciar
-	uint8_t cantBloqueadas_prioActual = 0;
-	bool salir = false;
-	uint8_t cant_bloqueadas = 0;
-	estadoOS estado_anterior;
+	static uint16_t indicePrioridad[PRIORITY_COUNT];		//indice de tareas a ejecutar segun prioridad
+	uint8_t prioridad_actual;
+	uint16_t indice;
+	uint16_t cantidad;
+	tarea* task;
 
 
 	/*
@@ -331,29 +716,10 @@ static void scheduler(void)  {
 	 */
 	if (control_OS.estado_sistema == OS_FROM_RESET)  {
 		control_OS.tarea_actual = (tarea*) &tareaIdle;
-		memset(indicePrioridad,0,sizeof(uint8_t) * PRIORITY_COUNT);
+		memset(indicePrioridad,0,sizeof(uint16_t) * PRIORITY_COUNT);
 		control_OS.estado_sistema = OS_NORMAL_RUN;
 	}
 
-	/*
-	 * Se comienza a iterar sobre el vector de tareas, pero teniendo en cuenta las
-	 * prioridades de las tareas.
-	 * En esta implementacion, durante la ejecucion de os_Init() se aplica la
-	 * tecnica de quicksort sobre el vector que contiene la lista de tareas
-	 * y se ordenan los punteros a tareas segun la prioridad que tengan. Los
-	 * punteros a tareas quedan ordenados de mayor a menor prioridad.
-	 * Gracias a eso, dividiendo el vector de punteros en cuantas prioridades haya
-	 * podemos recorrer estas subsecciones manteniendo indices para cada prioridad
-	 *
-	 * La mecanica de RoundRobin para tareas de igual prioridad se mantiene,
-	 * asimismo la determinacion de cuando la tarea idle debe ser ejecutada. Cuando
-	 * se recorren todas las tareas de una prioridad y todas estan bloqueadas, entonces
-	 * se pasa a la prioridad menor siguiente
-	 *
-	 * Recordar que aunque todas las tareas definidas por el usuario esten bloqueadas
-	 * la tarea Idle solamente puede tomar estados READY y RUNNING.
-	 */
-
 
 	/*
 	 * Puede darse el caso en que se haya invocado la funcion os_CpuYield() la cual hace una
@@ -374,107 +740,75 @@ static void scheduler(void)  {
 	control_OS.estado_sistema = OS_SCHEDULING;
 
 	/*
-	 * Como la determinacion de cuantas funciones estan en READY o BLOCKED es dinamica,
-	 * se hace un bucle con un testigo para salir de el
+	 * En esta implementacion, durante la ejecucion de os_Init() se ordena el vector que
+	 * contiene la lista de tareas segun la prioridad que tengan, de mayor a menor, y se
+	 * guarda en inicioPrioridad donde comienza la subseccion de cada prioridad. Ademas el
+	 * OS mantiene en prioridadesListas un bit por prioridad que indica si existe al menos
+	 * una tarea READY o RUNNING de esa prioridad.
+	 *
+	 * Gracias a eso la prioridad a ejecutar se obtiene en tiempo constante como el bit en 1
+	 * menos significativo del mapa (la prioridad 0 es la maxima), sin importar cuantas
+	 * prioridades ni tareas existan, y solo se recorre la subseccion de esa prioridad.
+	 * La mecanica de RoundRobin para tareas de igual prioridad se mantiene con un indice
+	 * por prioridad. Si ninguna prioridad tiene tareas listas, se ejecuta la tarea idle.
+	 *
+	 * Recordar que aunque todas las tareas definidas por el usuario esten bloqueadas
+	 * la tarea Idle solamente puede tomar estados READY y RUNNING.
+	 *
+	 * En modo EDF, si hay tareas con deadline listas se ejecuta directamente la raiz del
+	 * heap, que es la de deadline absoluto mas proximo. Solo cuando no hay ninguna se
+	 * aplica el criterio de prioridades fijas, que entonces solo encuentra tareas sin
+	 * deadline.
 	 */
-	while(!salir)  {
-
-		/*
-		 * La variable indiceArrayTareas contiene la posicion real dentro del array listaTareas
-		 * de la tarea siguiente a ser ejecutada. Se inicializa en 0
-		 */
-		indiceArrayTareas = 0;
+#if OS_EDF
+	if (control_OS.cantHeap > 0)
+		task = control_OS.heapListas[0];
+	else
+#endif
+	if (control_OS.prioridadesListas == 0)  {
+		task = &tareaIdle;
+	}
+	else  {
+		prioridad_actual = __builtin_ctz(control_OS.prioridadesListas);
+		cantidad = control_OS.cantTareas_prioridad[prioridad_actual];
+		indice = indicePrioridad[prioridad_actual];
 
 		/*
-		 * Puede darse el caso de que se hayan definido tareas de prioridades no contiguas, por
-		 * ejemplo dos tareas de maxima prioridad y una de minima prioridad. Quiere decir que no
-		 * existen tareas con prioridades entre estas dos. Este bloque if determina si existen
-		 * funciones para la prioridad actual. Si no existen, se pasa a la prioridad menor
-		 * siguiente
+		 * El mapa de bits asegura que existe al menos una tarea READY o RUNNING en esta
+		 * subseccion, por lo que el recorrido termina a lo sumo en una vuelta completa
 		 */
-		if(control_OS.cantTareas_prioridad[prioridad_actual] > 0)  {
-
-			/*
-			 * esta linea asegura que el indice siempre este dentro de los limites de la subseccion
-			 * que forman los punteros a las tareas de prioridad actual
-			 */
-			indicePrioridad[prioridad_actual] %= control_OS.cantTareas_prioridad[prioridad_actual];
-
-			/*
-			 * El bucle for hace una conversion de indices de subsecciones al indice real que debe
-			 * usarse sobre el vector de punteros a tareas. Cuando se baja de prioridad debe sumarse
-			 * el total de tareas que existen en la subseccion anterior. Recordar que el vector de
-			 * tareas esta ordenado de mayor a menor
-			 */
-			for (int i=0; i<prioridad_actual;i++) {
-				indiceArrayTareas += control_OS.cantTareas_prioridad[i];
-			}
-			indiceArrayTareas += indicePrioridad[prioridad_actual];
-
-
+		for (uint16_t i = 0; i < cantidad; i++)  {
+			if (indice >= cantidad)
+				indice = 0;
 
+			task = control_OS.listaTareas[control_OS.inicioPrioridad[prioridad_actual] + indice];
+			indice++;
 
-			switch (((tarea*)control_OS.listaTareas[indiceArrayTareas])->estado) {
-
-			case TAREA_READY:
-				control_OS.tarea_siguiente = (tarea*) control_OS.listaTareas[indiceArrayTareas];
-				control_OS.cambioContextoNecesario = true;
-				indicePrioridad[prioridad_actual]++;
-				salir = true;
+			if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)
 				break;
 
-				/*
-				 * Para el caso de las tareas bloqueadas, la variable cantBloqueadas_prioActual se utiliza
-				 * para hacer el seguimiento de si se debe bajar un escalon de prioridad
-				 * El bucle del scheduler se ejecuta completo, pasando por todas las prioridades cada vez
-				 * hasta que encuentra una tarea en READY.
-				 * La determinacion de la necesidad de ejecucion de la tarea idle sigue siendo la misma.
-				 */
-			case TAREA_BLOCKED:
-				cant_bloqueadas++;
-				cantBloqueadas_prioActual++;
-				indicePrioridad[prioridad_actual]++;
-				if (cant_bloqueadas == control_OS.cantidad_Tareas)  {
-					control_OS.tarea_siguiente = &tareaIdle;
-					control_OS.cambioContextoNecesario = true;
-					salir = true;
-				}
-				else {
-					if(cantBloqueadas_prioActual == control_OS.cantTareas_prioridad[prioridad_actual])  {
-						cantBloqueadas_prioActual = 0;
-						indicePrioridad[prioridad_actual] = 0;
-						prioridad_actual++;
-					}
-				}
-				break;
+			task = NULL;
+		}
 
-				/*
-				 * El unico caso que la siguiente tarea este en estado RUNNING es que
-				 * todas las demas tareas excepto la tarea corriendo actualmente esten en
-				 * estado BLOCKED, con lo que un cambio de contexto no es necesario, porque
-				 * se sigue ejecutando la misma tarea
-				 */
-			case TAREA_RUNNING:
-				indicePrioridad[prioridad_actual]++;
-				control_OS.cambioContextoNecesario = false;
-				salir = true;
-				break;
+		indicePrioridad[prioridad_actual] = indice;
 
-				/*
-				 * En el caso que lleguemos al caso default, la tarea tomo un estado
-				 * el cual es invalido, por lo que directamente se levanta un error de
-				 * sistema actualizando la variable de ultimo error
-				 */
-			default:
-				os_setError(ERR_OS_SCHEDULING,scheduler);
-			}
-		}
-		else {
-			indicePrioridad[prioridad_actual] = 0;
-			prioridad_actual++;
+		/*
+		 * En el caso que no se encuentre ninguna tarea, el mapa de bits y los estados de las
+		 * tareas son inconsistentes, por lo que directamente se levanta un error de sistema
+		 */
+		if (task == NULL)  {
+			os_setError(ERR_OS_SCHEDULING,scheduler);
+			task = &tareaIdle;
 		}
 	}
 
+	/*
+	 * El unico caso que la siguiente tarea este en estado RUNNING es que sea la misma que se
+	 * esta ejecutando, con lo que un cambio de contexto no es necesario
+	 */
+	control_OS.tarea_siguiente = task;
+	control_OS.cambioContextoNecesario = (task->estado != TAREA_RUNNING);
+
 	/*
 	 * Antes de salir del scheduler se devuelve el sistema a su estado normal
 	 */
@@ -502,28 +836,82 @@ static void scheduler(void)  {
 	 *  @return     None.
 ***************************************************************************************************/
 void SysTick_Handler(void)  {
-	uint8_t i;
+	uint16_t i;
 	tarea* task;		//variable para legibilidad
+	tarea* actual = control_OS.tarea_actual;
+	bool schedulingNecesario = false;
+
+	control_OS.ticks_sistema++;
+
+#if OS_ESTADISTICAS
+	control_OS.ticks_estadisticas++;
+	if (actual != NULL)
+		actual->ticks_cpu++;
+#endif
+
+#if OS_PRESUPUESTOS
+	/*
+	 * Se descuenta el tick a la tarea que lo consumio y se reponen los presupuestos cuyo
+	 * periodo vencio. Si la tarea actual agota el suyo deja de estar RUNNING o baja de
+	 * prioridad, y la evaluacion de mas abajo produce el scheduling
+	 */
+	actualizarPresupuestos(actual);
+#endif
 
 	/*
-	 * Systick se encarga de actualizar todos los temporizadores por lo que se recorren
-	 * todas las tareas que esten definidas y si tienen un valor de ticks de bloqueo mayor
-	 * a cero, se decrementan en una unidad. Si este contador llega a cero, entonces
-	 * se debe pasar la tarea a READY. Es conveniente hacerlo aqui dado que la condicion
-	 * de que pase a descontar el ultimo tick se da en esta porcion de codigo
+	 * Systick se encarga de actualizar todos los temporizadores, pero solo se recorren las tareas
+	 * que tienen un valor de ticks de bloqueo mayor a cero (listaDemoradas), con lo que el costo
+	 * del tick no crece con la cantidad de tareas definidas. Se decrementan en una unidad y si el
+	 * contador llega a cero la tarea sale de la lista y pasa a READY. Es conveniente hacerlo aqui
+	 * dado que la condicion de que pase a descontar el ultimo tick se da en esta porcion de codigo
 	 */
 	i = 0;
 
-	while (control_OS.listaTareas[i] != NULL)  {
-		task = (tarea*)control_OS.listaTareas[i];
+	while (i < control_OS.cantDemoradas)  {
+		task = control_OS.listaDemoradas[i];
 
-		if( task->ticks_bloqueada > 0 )  {
-			if((--task->ticks_bloqueada == 0) && (task->estado == TAREA_BLOCKED))  {
-				task->estado = TAREA_READY;
-			}
+		if(--task->ticks_bloqueada == 0)  {
+			control_OS.listaDemoradas[i] = control_OS.listaDemoradas[--control_OS.cantDemoradas];
+			os_DesbloquearTarea(task);
 		}
+		else
+			i++;
+	}
 
-		i++;
+#if OS_MONITOR_PERIODICAS
+	/*
+	 * Liberacion de los trabajos de las tareas periodicas y deteccion de deadlines perdidos.
+	 * Se hace antes de evaluar el desalojo para que una tarea liberada en este tick pueda
+	 * ejecutarse inmediatamente
+	 */
+	actualizarPeriodicas();
+#endif
+
+
+	/*
+	 * El scheduler ya no se llama en todos los ticks. Se llama cuando existe una tarea READY de
+	 * mayor prioridad que la actual (despertada por este tick o por una API llamada desde otra
+	 * tarea), lo que se obtiene del mapa de prioridades listas sin recorrer tareas. Tambien
+	 * cuando la tarea actual agoto su time slice (quantum de su prioridad), cuando dejo de estar
+	 * RUNNING, o en el primer tick luego del reset. Con quantum OS_SIN_TIME_SLICING la tarea
+	 * corre hasta bloquearse o ser desalojada. La tarea idle tiene prioridad PRIORIDAD_IDLE, por
+	 * lo que cualquier tarea READY la desaloja. Las tareas con deadline de EDF no tienen time
+	 * slicing
+	 */
+	if (actual == NULL || actual->estado != TAREA_RUNNING)
+		schedulingNecesario = true;
+
+	else if (hayDesalojo(actual))
+		schedulingNecesario = true;
+
+	else if (actual != &tareaIdle && !TIENE_DEADLINE(actual) &&
+			control_OS.quantum[actual->prioridad] != OS_SIN_TIME_SLICING)  {
+		if (control_OS.quantumRestante <= 1)  {
+			control_OS.quantumRestante = control_OS.quantum[actual->prioridad];
+			schedulingNecesario = true;
+		}
+		else
+			control_OS.quantumRestante--;
 	}
 
 
@@ -533,7 +921,8 @@ void SysTick_Handler(void)  {
 	 * estadio de desarrollo del OS. Recordar que scheduler() debe ser lo mas corto posible
 	 */
 
-	scheduler();
+	if (schedulingNecesario)
+		scheduler();
 
 
 	/*
@@ -612,6 +1001,15 @@ uint32_t getContextoSiguiente(uint32_t sp_actual)  {
 
 	control_OS.tarea_actual->stack_pointer = sp_actual;
 
+	/*
+	 * Si el centinela de la base del stack fue pisado, la tarea saliente desbordo su stack
+	 * y seguramente corrompio memoria adyacente. No tiene sentido seguir ejecutando. Con la
+	 * guarda del MPU el chequeo se mantiene: cubre las escrituras que la saltan (un arreglo
+	 * local grande que se escribe de abajo hacia arriba) y las de DMA, que el MPU no ve
+	 */
+	if (control_OS.tarea_actual->stack[STACK_CANARY_POS] != STACK_CANARY)
+		os_setError(ERR_OS_STACK_OVERFLOW,getContextoSiguiente);
+
 	if (control_OS.tarea_actual->estado == TAREA_RUNNING)
 		control_OS.tarea_actual->estado = TAREA_READY;
 
@@ -619,6 +1017,19 @@ uint32_t getContextoSiguiente(uint32_t sp_actual)  {
 
 	control_OS.tarea_actual = control_OS.tarea_siguiente;
 	control_OS.tarea_actual->estado = TAREA_RUNNING;
+#if OS_ESTADISTICAS
+	control_OS.tarea_actual->cambios_contexto++;
+#endif
+
+	/*
+	 * La tarea entrante comienza un time slice completo
+	 */
+	if (control_OS.tarea_actual != &tareaIdle)
+		control_OS.quantumRestante = control_OS.quantum[control_OS.tarea_actual->prioridad];
+
+#if OS_STACK_GUARDA_MPU
+	setGuardaMPU(control_OS.tarea_actual);
+#endif
 
 
 	/*
@@ -633,262 +1044,1754 @@ uint32_t getContextoSiguiente(uint32_t sp_actual)  {
 
 
 /*************************************************************************************************
-	 *  @brief Fuerza una ejecucion del scheduler.
+	 *  @brief Pasa una tarea a estado BLOCKED.
      *
      *  @details
-     *   En los casos que un delay de una tarea comience a ejecutarse instantes luego de que
-     *   ocurriese un scheduling, se despericia mucho tiempo hasta el proximo tick de sistema,
-     *   por lo que se fuerza un scheduling y un cambio de contexto si es necesario.
+     *   Todos los cambios de estado entre READY/RUNNING y BLOCKED deben hacerse con esta funcion
+     *   y con os_DesbloquearTarea, porque ademas del estado actualizan la cantidad de tareas
+     *   listas de cada prioridad y el mapa de bits que utiliza el scheduler. Si la tarea ya
+     *   estaba bloqueada no se hace nada. No produce un scheduling; la tarea que se bloquea a si
+     *   misma debe llamar luego a os_CpuYield.
      *
-	 *  @param 		None
+	 *  @param 		task	Tarea a bloquear
 	 *  @return     None.
+	 *  @see 		os_DesbloquearTarea
 ***************************************************************************************************/
-void os_CpuYield(void)  {
-	scheduler();
+void os_BloquearTarea(tarea* task)  {
+	os_enter_critical();
+
+	if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)  {
+		task->estado = TAREA_BLOCKED;
+		quitarListas(task);
+	}
+
+	os_exit_critical();
 }
 
 
 
 /*************************************************************************************************
-	 *  @brief Devuelve una copia del puntero a estructura tarea actual.
+	 *  @brief Pasa una tarea bloqueada a estado READY.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una copia de la estructura de la tarea actual
+     *   Contraparte de os_BloquearTarea. Si la tarea esta lista o corriendo solo se marca
+     *   despertar_pendiente, para quien necesite saber que hubo un evento antes de bloquearse
+     *   (el ejecutor de corrutinas). Si es llamada desde una interrupcion se indica que es necesario efectuar un scheduling antes de
+     *   salir de la misma, porque la tarea despertada puede tener mayor prioridad que la
+     *   interrumpida. En modo EDF la liberacion comienza un nuevo trabajo de la tarea, por lo
+     *   que aqui se calcula su deadline absoluto.
      *
-	 *  @param 		None
-	 *  @return     puntero a la estructura de la tarea actual.
+	 *  @param 		task	Tarea a desbloquear
+	 *  @return     None.
+	 *  @see 		os_BloquearTarea
 ***************************************************************************************************/
-tarea* os_getTareaActual(void)  {
-	return control_OS.tarea_actual;
-}
+void os_DesbloquearTarea(tarea* task)  {
+	os_enter_critical();
 
+	if (task->estado == TAREA_BLOCKED)  {
+		task->estado = TAREA_READY;
 
+#if OS_EDF
+		task->deadline_absoluto = control_OS.ticks_sistema + task->deadline_relativo;
+#endif
+		agregarListas(task);
 
-/*************************************************************************************************
-	 *  @brief Devuelve una copia del valor del estado de sistema.
-     *
+		if (control_OS.estado_sistema == OS_IRQ_RUN)
+			control_OS.schedulingFromIRQ = true;
+	}
+	else if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)
+		task->despertar_pendiente = true;
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Carga los ticks que una tarea debe permanecer bloqueada.
+     *
+     *  @details
+     *   Asigna el contador de ticks de bloqueo de la tarea y la agrega a la lista de tareas
+     *   demoradas que recorre el SysTick. Si ya estaba en la lista solo se actualiza el contador.
+     *   No bloquea la tarea; eso lo hace quien llama con os_BloquearTarea.
+     *
+	 *  @param 		task	Tarea a demorar
+	 *  @param 		ticks	Cantidad de ticks de sistema, debe ser mayor a cero
+	 *  @return     None.
+***************************************************************************************************/
+void os_DemorarTarea(tarea* task, uint32_t ticks)  {
+	os_enter_critical();
+
+	if (task->ticks_bloqueada == 0)
+		control_OS.listaDemoradas[control_OS.cantDemoradas++] = task;
+
+	task->ticks_bloqueada = ticks;
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Cancela los ticks de bloqueo pendientes de una tarea.
+     *
+     *  @details
+     *   Quita la tarea de la lista de demoradas, para cuando una espera con demora termina
+     *   antes por otro evento. Sin esto el SysTick la desbloquearia mas tarde aunque ya
+     *   estuviera esperando otra cosa. No cambia el estado de la tarea.
+     *
+	 *  @param 		task	Tarea cuya demora se cancela
+	 *  @return     None.
+***************************************************************************************************/
+void os_CancelarDemora(tarea* task)  {
+	os_enter_critical();
+
+	if (task->ticks_bloqueada > 0)
+		quitarDeDemoradas(task);
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa una lista de espera vacia.
+     *
+	 *  @param 		lista	Lista a inicializar
+	 *  @return     None.
+***************************************************************************************************/
+void os_ListaEsperaInit(listaEspera* lista)  {
+	lista->primera = NULL;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Bloquea a la tarea actual en una lista de espera.
+     *
+     *  @details
+     *   Es el paso de bloqueo de las primitivas con varias tareas en espera: la tarea se
+     *   inserta en la lista segun su prioridad, se bloquea y cede el CPU, y al volver ya no
+     *   esta en la lista. Debe llamarse dentro de la seccion critica (de un solo nivel) en
+     *   la que se evaluo la condicion de espera, que se libera durante el yield y esta
+     *   tomada nuevamente al retornar. Como la tarea puede volver sin que la hayan
+     *   despertado (por ejemplo con os_Resume), quien llama debe reevaluar la condicion en
+     *   un ciclo, igual que con os_BloquearTarea.
+     *
+	 *  @param 		lista	Lista donde esperar
+	 *  @return     None.
+	 *  @see 		os_DespertarPrimera, os_DespertarTodas
+***************************************************************************************************/
+void os_EsperarEnLista(listaEspera* lista)  {
+	tarea* task = control_OS.tarea_actual;
+
+	if (task->lista_espera == NULL)
+		insertarEnEspera(lista, task);
+
+	os_BloquearTarea(task);
+
+	os_exit_critical();
+	os_CpuYield();
+	os_enter_critical();
+
+	if (task->lista_espera != NULL)
+		quitarDeEspera(task);
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a la tarea de mayor prioridad de una lista de espera.
+     *
+     *  @details
+     *   La quita de la lista y la pasa a READY con os_DesbloquearTarea, por lo que puede
+     *   llamarse desde un handler. Entre tareas de igual prioridad despierta a la que
+     *   espera hace mas tiempo.
+     *
+	 *  @param 		lista	Lista de espera
+	 *  @return     true si habia una tarea esperando.
+***************************************************************************************************/
+bool os_DespertarPrimera(listaEspera* lista)  {
+	tarea* task;
+
+	os_enter_critical();
+
+	task = lista->primera;
+	if (task != NULL)  {
+		quitarDeEspera(task);
+		os_DesbloquearTarea(task);
+	}
+
+	os_exit_critical();
+
+	return task != NULL;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Despierta a todas las tareas de una lista de espera.
+     *
+	 *  @param 		lista	Lista de espera
+	 *  @return     None.
+***************************************************************************************************/
+void os_DespertarTodas(listaEspera* lista)  {
+	os_enter_critical();
+
+	while (lista->primera != NULL)
+		os_DespertarPrimera(lista);
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Pasa a la tarea de mayor prioridad de una lista de espera a otra.
+     *
+     *  @details
+     *   La tarea sigue bloqueada, ahora esperando el evento de la lista destino. Permite que
+     *   una primitiva entregue sus tareas a otra sin despertarlas, por ejemplo las de una
+     *   variable de condicion al mutex que igual deberian esperar.
+     *
+	 *  @param 		origen		Lista de donde se quita la tarea
+	 *  @param 		destino		Lista donde se inserta segun su prioridad
+	 *  @return     true si habia una tarea en la lista de origen.
+***************************************************************************************************/
+bool os_TrasladarPrimera(listaEspera* origen, listaEspera* destino)  {
+	tarea* task;
+
+	os_enter_critical();
+
+	task = origen->primera;
+	if (task != NULL)  {
+		quitarDeEspera(task);
+		insertarEnEspera(destino, task);
+	}
+
+	os_exit_critical();
+
+	return task != NULL;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve el minimo historico de stack libre de una tarea.
+     *
+     *  @details
+     *   Recorre el stack de la tarea desde la base contando las palabras que aun conservan el
+     *   patron con el que fue pintado en su inicializacion. El resultado es la cantidad de bytes
+     *   que la tarea nunca llego a utilizar (high water mark), util para dimensionar STACK_SIZE.
+     *   El centinela y la guarda del MPU (si esta habilitada) no se cuentan como stack libre.
+     *
+	 *  @param 		task	Puntero a la estructura de la tarea a consultar
+	 *  @return     Cantidad de bytes de stack nunca utilizados por la tarea.
+***************************************************************************************************/
+uint32_t os_getStackLibre(tarea* task)  {
+	uint32_t i;
+
+	i = STACK_CANARY_POS + 1;
+
+	while (i < STACK_SIZE/4 && task->stack[i] == STACK_PATTERN)
+		i++;
+
+	return (i - STACK_CANARY_POS - 1) * 4;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Configura el time slice de una prioridad.
+     *
+     *  @details
+     *   Determina cuantos ticks puede correr una tarea de la prioridad indicada antes de que el
+     *   scheduler le de el CPU a otra tarea READY de su misma prioridad. Niveles con tareas de
+     *   procesamiento pueden usar quantums largos para reducir cambios de contexto, y niveles
+     *   sensibles a la latencia quantums cortos. Con OS_SIN_TIME_SLICING la tarea solo cede el
+     *   CPU al bloquearse o al ser desalojada por una tarea de mayor prioridad. Puede llamarse
+     *   antes o despues de os_Init; por defecto todas las prioridades usan OS_QUANTUM_DEFAULT.
+     *
+	 *  @param 		prioridad	Prioridad a configurar
+	 *  @param 		ticks		Duracion del time slice en ticks de sistema
+	 *  @return     None.
+***************************************************************************************************/
+void os_SetQuantum(uint8_t prioridad, uint16_t ticks)  {
+	if (prioridad < PRIORITY_COUNT)
+		control_OS.quantum[prioridad] = ticks;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve la cantidad de ticks de sistema desde el arranque.
+     *
+     *  @details
+     *   El contador es de 32 bits y da la vuelta; las diferencias entre dos lecturas deben
+     *   calcularse con aritmetica sin signo.
+     *
+	 *  @param 		None
+	 *  @return     Ticks transcurridos.
+***************************************************************************************************/
+uint32_t os_getTicks(void)  {
+	return control_OS.ticks_sistema;
+}
+
+
+
+#if OS_EDF
+/*************************************************************************************************
+	 *  @brief Declara el deadline relativo de una tarea (modo EDF).
+     *
+     *  @details
+     *   Cada vez que la tarea pasa de bloqueada a lista comienza un nuevo trabajo, cuyo
+     *   deadline absoluto es el tick de liberacion mas este deadline relativo. El trabajo en
+     *   curso toma el nuevo deadline a partir del tick actual. Con OS_SIN_DEADLINE la tarea
+     *   vuelve a planificarse por prioridad fija y solo corre cuando no hay tareas con
+     *   deadline listas. Puede llamarse antes de os_Init.
+     *
+	 *  @param 		task	Tarea a configurar, NULL para la tarea actual
+	 *  @param 		ticks	Deadline relativo en ticks de sistema
+	 *  @return     None.
+***************************************************************************************************/
+void os_SetDeadline(tarea* task, uint32_t ticks)  {
+
+	if (task == NULL)
+		task = control_OS.tarea_actual;
+
+	if (task == NULL || task == &tareaIdle || task->estado == TAREA_DELETED)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_SetDeadline);
+		return;
+	}
+
+	os_enter_critical();
+
+	if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)  {
+		quitarListas(task);
+		task->deadline_relativo = ticks;
+		task->deadline_absoluto = control_OS.ticks_sistema + ticks;
+		agregarListas(task);
+	}
+	else  {
+		task->deadline_relativo = ticks;
+		task->deadline_absoluto = control_OS.ticks_sistema + ticks;
+	}
+
+	os_exit_critical();
+
+	evaluarDesalojo();
+}
+#endif
+
+
+
+#if OS_PRESUPUESTOS
+/*************************************************************************************************
+	 *  @brief Asigna un presupuesto de CPU a una tarea.
+     *
+     *  @details
+     *   La tarea puede ejecutarse como maximo ticks ticks de sistema cada periodo ticks. El
+     *   periodo se cuenta desde el primer tick que la tarea consume con el presupuesto
+     *   completo, y al vencer se repone todo lo consumido. Al agotarlo la tarea se suspende o
+     *   se degrada segun accion hasta la reposicion, y se llama a presupuestoHook. La
+     *   configuracion anterior se descarta y el presupuesto arranca completo. Con ticks en
+     *   OS_SIN_PRESUPUESTO la tarea no tiene limite. Puede llamarse antes de os_Init.
+     *
+	 *  @param task		Tarea a configurar, NULL para la tarea actual
+	 *  @param ticks	Ticks de CPU por periodo
+	 *  @param periodo	Periodo de reposicion en ticks, mayor o igual a ticks
+	 *  @param accion	OS_PRESUPUESTO_SUSPENDER u OS_PRESUPUESTO_DEGRADAR
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_SetPresupuesto(tarea* task, uint32_t ticks, uint32_t periodo, accionPresupuesto accion)  {
+
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_SetPresupuesto);
+		return;
+	}
+
+	if(ticks > periodo)  {
+		os_setError(ERR_OS_PRESUPUESTO,os_SetPresupuesto);
+		return;
+	}
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL || task == &tareaIdle || task->estado == TAREA_DELETED)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_SetPresupuesto);
+		return;
+	}
+
+	os_enter_critical();
+
+	if(task->ticks_reposicion > 0)
+		quitarDeReposiciones(task);
+
+	task->presupuesto = ticks;
+	task->periodo_reposicion = periodo;
+	task->accion_presupuesto = accion;
+	reponerPresupuesto(task);
+
+	os_exit_critical();
+
+	evaluarDesalojo();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve cuantas veces una tarea agoto su presupuesto.
+     *
+	 *  @param task		Tarea a consultar, NULL para la tarea actual
+	 *  @return     Cantidad de agotamientos desde que la tarea fue creada, 0 si se pide la
+	 *  			tarea actual antes de os_Init.
+***************************************************************************************************/
+uint32_t os_getAgotamientos(tarea* task)  {
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL)
+		return 0;
+
+	return task->cant_agotamientos;
+}
+#endif
+
+
+
+#if OS_MONITOR_PERIODICAS
+/*************************************************************************************************
+	 *  @brief Declara una tarea como periodica.
+     *
+     *  @details
+     *   A partir de este momento la tarea tiene un trabajo liberado, y el SysTick libera uno
+     *   nuevo cada periodo ticks. La tarea marca el fin de cada trabajo con os_EsperarPeriodo.
+     *   Las estadisticas se reinician. Con periodo 0 la tarea deja de ser periodica. Puede
+     *   llamarse antes de os_Init.
+     *
+	 *  @param task		Tarea a configurar, NULL para la tarea actual
+	 *  @param periodo	Ticks entre liberaciones
+	 *  @param deadline	Ticks desde la liberacion para terminar cada trabajo, 0 = igual al periodo
+	 *  @return     None.
+	 *  @warning	No puede llamarse desde un handler, produce un error de OS
+***************************************************************************************************/
+void os_SetPeriodica(tarea* task, uint32_t periodo, uint32_t deadline)  {
+
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_SetPeriodica);
+		return;
+	}
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	if(task == NULL || task == &tareaIdle || task->estado == TAREA_DELETED)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,os_SetPeriodica);
+		return;
+	}
+
+	os_enter_critical();
+
+	if(task->periodo == 0 && periodo > 0)
+		control_OS.listaPeriodicas[control_OS.cantPeriodicas++] = task;
+	else if(task->periodo > 0 && periodo == 0)
+		quitarDePeriodicas(task);
+
+	task->periodo = periodo;
+	task->deadline = (deadline == 0) ? periodo : deadline;
+	task->ticks_liberacion = periodo;
+	task->liberacion = control_OS.ticks_sistema;
+	task->liberaciones_pendientes = 0;
+	task->trabajo_activo = (periodo > 0);
+	task->deadline_perdido = false;
+
+	os_exit_critical();
+
+	os_ReiniciarEstadisticasPeriodica(task);
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Termina el trabajo actual de una tarea periodica.
+     *
+     *  @details
+     *   Registra el tiempo de respuesta del trabajo y bloquea la tarea hasta la proxima
+     *   liberacion. Si la liberacion ya ocurrio mientras el trabajo estaba en curso, el
+     *   siguiente trabajo comienza inmediatamente y su tiempo de respuesta se mide desde esa
+     *   liberacion.
+     *
+	 *  @param 		None
+	 *  @return     None.
+	 *  @warning	Solo puede llamarla una tarea periodica, produce un error de OS en otro caso
+***************************************************************************************************/
+void os_EsperarPeriodo(void)  {
+	tarea* task = control_OS.tarea_actual;
+	uint32_t respuesta;
+
+	if(control_OS.estado_sistema == OS_IRQ_RUN)  {
+		os_setError(ERR_OS_TAREA_FROM_ISR,os_EsperarPeriodo);
+		return;
+	}
+
+	if(task == NULL || task->periodo == 0)  {
+		os_setError(ERR_OS_PERIODO,os_EsperarPeriodo);
+		return;
+	}
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	if(task->trabajo_activo)  {
+		respuesta = control_OS.ticks_sistema - task->liberacion;
+		registrarRespuesta(task, respuesta);
+
+		if(respuesta > task->deadline && !task->deadline_perdido)  {
+			task->estadisticas.deadlines_perdidos++;
+			deadlineHook(task);
+		}
+
+		task->deadline_perdido = false;
+
+		if(task->liberaciones_pendientes > 0)  {
+			task->liberaciones_pendientes--;
+			task->liberacion += task->periodo;
+		}
+		else
+			task->trabajo_activo = false;
+	}
+
+	/*
+	 * Igual que en os_Delay, la tarea solo continua cuando el SysTick libero su proximo
+	 * trabajo, aunque algo la despierte antes
+	 */
+	while(!task->trabajo_activo)  {
+		os_BloquearTarea(task);
+
+		os_exit_critical();
+		os_CpuYield();
+		os_enter_critical();
+	}
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Copia las estadisticas de una tarea periodica.
+     *
+	 *  @param task		Tarea a consultar, NULL para la tarea actual
+	 *  @param destino	Estructura donde se copian las estadisticas
+	 *  @return     None.
+***************************************************************************************************/
+void os_getEstadisticasPeriodica(tarea* task, estadisticasPeriodica* destino)  {
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	os_enter_critical();
+	*destino = task->estadisticas;
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Reinicia las estadisticas de una tarea periodica.
+     *
+     *  @details
+     *   Util para descartar los primeros trabajos luego del arranque, o para medir por
+     *   intervalos en pruebas de larga duracion.
+     *
+	 *  @param task		Tarea a reiniciar, NULL para la tarea actual
+	 *  @return     None.
+***************************************************************************************************/
+void os_ReiniciarEstadisticasPeriodica(tarea* task)  {
+
+	if(task == NULL)
+		task = control_OS.tarea_actual;
+
+	os_enter_critical();
+	memset(&task->estadisticas, 0, sizeof(estadisticasPeriodica));
+	task->estadisticas.respuesta_min = UINT32_MAX;
+	os_exit_critical();
+}
+#endif
+
+
+
+/*************************************************************************************************
+	 *  @brief Fuerza una ejecucion del scheduler.
+     *
+     *  @details
+     *   En los casos que un delay de una tarea comience a ejecutarse instantes luego de que
+     *   ocurriese un scheduling, se despericia mucho tiempo hasta el proximo tick de sistema,
+     *   por lo que se fuerza un scheduling y un cambio de contexto si es necesario.
+     *   El scheduler se ejecuta en una seccion critica: si una interrupcion lo desalojara a
+     *   mitad de camino, otras tareas podrian bloquearse o cambiar de prioridad y al volver el
+     *   scheduler elegiria con informacion vieja. PendSV queda pendiente y se atiende al salir
+     *   de la seccion critica.
+     *
+	 *  @param 		None
+	 *  @return     None.
+***************************************************************************************************/
+void os_CpuYield(void)  {
+	os_enter_critical();
+	scheduler();
+	os_exit_critical();
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve una copia del puntero a estructura tarea actual.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una copia de la estructura de la tarea actual
+     *
+	 *  @param 		None
+	 *  @return     puntero a la estructura de la tarea actual.
+***************************************************************************************************/
+tarea* os_getTareaActual(void)  {
+	return control_OS.tarea_actual;
+}
+
+
+
+#if OS_ESTADISTICAS
+/*************************************************************************************************
+	 *  @brief Devuelve la cantidad de tareas definidas, sin contar la idle.
+     *
+	 *  @param 		None
+	 *  @return     Cantidad de tareas.
+***************************************************************************************************/
+uint16_t os_getCantidadTareas(void)  {
+	return control_OS.cantidad_Tareas;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve una tarea de la lista del OS.
+     *
+     *  @details
+     *   La lista esta ordenada por prioridad. Pensada para recorrer las tareas desde una
+     *   tarea de diagnostico; si otra tarea crea o elimina tareas mientras tanto, la lista
+     *   puede cambiar entre dos llamadas.
+     *
+	 *  @param 		indice		Posicion en la lista, de 0 a os_getCantidadTareas() - 1
+	 *  @return     La tarea, o NULL si el indice esta fuera de rango.
+***************************************************************************************************/
+tarea* os_getTarea(uint16_t indice)  {
+	if (indice >= control_OS.cantidad_Tareas)
+		return NULL;
+
+	return control_OS.listaTareas[indice];
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve la tarea idle, para leer sus estadisticas.
+     *
+	 *  @param 		None
+	 *  @return     Puntero a la tarea idle.
+***************************************************************************************************/
+tarea* os_getTareaIdle(void)  {
+	return &tareaIdle;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve los ticks transcurridos desde el ultimo reinicio de las estadisticas.
+     *
+     *  @details
+     *   Es la base para calcular el porcentaje de CPU de cada tarea a partir de ticks_cpu.
+     *
+	 *  @param 		None
+	 *  @return     Ticks desde el arranque o desde os_ReiniciarEstadisticas.
+***************************************************************************************************/
+uint32_t os_getTicksEstadisticas(void)  {
+	return control_OS.ticks_estadisticas;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Pone en cero las estadisticas de ejecucion de todas las tareas.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+void os_ReiniciarEstadisticas(void)  {
+	tarea* task;
+
+	os_enter_critical();
+
+	for (uint16_t i = 0; i < control_OS.cantidad_Tareas; i++)  {
+		task = control_OS.listaTareas[i];
+		task->ticks_cpu = 0;
+		task->cambios_contexto = 0;
+	}
+
+	tareaIdle.ticks_cpu = 0;
+	tareaIdle.cambios_contexto = 0;
+	control_OS.ticks_estadisticas = 0;
+
+	os_exit_critical();
+}
+#endif
+
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve una copia del valor del estado de sistema.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una copia del estado de sistema actual
+     *
+	 *  @param 		None
+	 *  @return     estado del OS.
+***************************************************************************************************/
+estadoOS os_getEstadoSistema(void)  {
+	return control_OS.estado_sistema;
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Cambia el estado de sistema al pasado como argumento por esta funcion.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una manera de actualizar el estado del sistema en otros archivos
+     *
+	 *  @param 		None
+	 *  @return     estado del OS.
+***************************************************************************************************/
+void os_setEstadoSistema(estadoOS estado)  {
+	control_OS.estado_sistema = estado;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Setea la bandera de scheduling desde ISR.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una forma de setear la bandera correspondiente a la necesidad
+     *   de ejecutar un scheduling antes de salir de una interrupcion
+     *
+	 *  @param 		value	El valor a escribir en la bandera correspondiente
+	 *  @return     none.
+***************************************************************************************************/
+void os_setScheduleDesdeISR(bool value)  {
+	control_OS.schedulingFromIRQ = value;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve una copia del valor del estado de sistema.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una forma de obtener el valor de la bandera correspondiente a la
+     *   necesidad de ejecutar un scheduling antes de salir de una interrupcion
+     *
+	 *  @param 		None
+	 *  @return     Valor de la bandera correspondiente.
+***************************************************************************************************/
+bool os_getScheduleDesdeISR(void)  {
+	return control_OS.schedulingFromIRQ;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Levanta un error de sistema.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una forma de setear el codigo de error y lanza una ejecucion
+     *   de errorHook
+     *
+	 *  @param 		err		El codigo de error que ha surgido
+	 *  @param		caller	Puntero a la funcion que llama a esta funcion
+	 *  @return     none.
+***************************************************************************************************/
+void os_setError(int32_t err, void* caller)  {
+	control_OS.error = err;
+	errorHook(caller);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Levanta un error de sistema.
+     *
+     *  @details
+     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
+     *   funcion proporciona una forma de setear el codigo de warning. Se almacena en la misma
+     *   variable que error porque en OS sigue funcionando. En el caso de error, el OS deja de
+     *   funcionar, con lo que son dos casos mutuamente excluyentes.
+     *
+	 *  @param 		warn	El codigo de advertencia que ha surgido
+	 *  @return     none.
+***************************************************************************************************/
+void os_setWarning(int32_t warn)  {
+	control_OS.error = warn;
+}
+
+
+
+
+/*************************************************************************************************
+	 *  @brief Marca el inicio de una seccion como seccion critica.
+     *
+     *  @details
+     *   Las secciones criticas son aquellas que deben ejecutar operaciones atomicas, es decir que
+     *   no pueden ser interrumpidas. Con llamar a esta funcion, se otorga soporte en el OS
+     *   para marcar un bloque de codigo como atomico
+     *
+	 *  @param 		None
+	 *  @return     None
+	 *  @see 		os_exit_critical
+***************************************************************************************************/
+INLINE_CRITICA void os_enter_critical()  {
+	__disable_irq();
+#if OS_LATENCIA_IRQ || OS_PERFIL_CRITICAS
+	if (control_OS.contador_critico == 0)  {
+		control_OS.inicio_critico = OS_CICLOS();
+#if OS_PERFIL_CRITICAS
+		control_OS.sitio_critico = __builtin_return_address(0);
+#endif
+	}
+#endif
+	control_OS.contador_critico++;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Marca el final de una seccion como seccion critica.
+     *
+     *  @details
+     *   Las secciones criticas son aquellas que deben ejecutar operaciones atomicas, es decir que
+     *   no pueden ser interrumpidas. Con llamar a esta funcion, se otorga soporte en el OS
+     *   para marcar un bloque de codigo como atomico
+     *
+	 *  @param 		None
+	 *  @return     None
+	 *  @see 		os_enter_critical
+***************************************************************************************************/
+inline void os_exit_critical()  {
+	if (--control_OS.contador_critico <= 0)  {
+		control_OS.contador_critico = 0;
+#if OS_LATENCIA_IRQ || OS_PERFIL_CRITICAS
+		uint32_t duracion = OS_CICLOS() - control_OS.inicio_critico;
+#endif
+#if OS_LATENCIA_IRQ
+		if (duracion > control_OS.critico_max)
+			control_OS.critico_max = duracion;
+#endif
+#if OS_PERFIL_CRITICAS
+		registrarSitioCritico(control_OS.sitio_critico, duracion);
+#endif
+		__enable_irq();
+	}
+}
+
+
+#if OS_LATENCIA_IRQ
+/*************************************************************************************************
+	 *  @brief Devuelve la seccion critica mas larga.
+     *
+     *  @details
+     *   Cuenta desde la entrada a la seccion critica mas externa (os_enter_critical) hasta su
+     *   salida. Es un limite inferior de la latencia de peor caso de cualquier interrupcion
+     *   que el OS enmascara.
+     *
+	 *  @param 		None
+	 *  @return     Ciclos con las interrupciones deshabilitadas.
+	 *  @see 		os_ReiniciarSeccionCriticaMax
+***************************************************************************************************/
+uint32_t os_getSeccionCriticaMax(void)  {
+	return control_OS.critico_max;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Reinicia la medicion de la seccion critica mas larga.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+void os_ReiniciarSeccionCriticaMax(void)  {
+	control_OS.critico_max = 0;
+}
+#endif
+
+
+#if OS_PERFIL_CRITICAS
+/*************************************************************************************************
+	 *  @brief Agrega una seccion critica al perfil de su punto de llamada.
+     *
+     *  @details
+     *   Se llama con las interrupciones todavia deshabilitadas. La tabla es un hash con
+     *   sondeo lineal por la direccion del punto de llamada; los puntos son pocos y fijos,
+     *   por lo que en regimen se encuentran en el primer intento. Si la tabla esta llena la
+     *   seccion solo se cuenta en sitiosDescartados.
+     *
+	 *  @param sitio		Direccion de retorno de os_enter_critical
+	 *  @param duracion		Ciclos con las interrupciones deshabilitadas
+	 *  @return     None.
+***************************************************************************************************/
+static void registrarSitioCritico(void* sitio, uint32_t duracion)  {
+	uint32_t pos = ((uint32_t) (uintptr_t) sitio * 2654435761UL) >> 16;
+	perfilCritica* p;
+
+	for (uint16_t i = 0; i < OS_PERFIL_CANT_SITIOS; i++)  {
+		p = &perfilSitios[(pos + i) & (OS_PERFIL_CANT_SITIOS - 1)];
+
+		if (p->sitio == NULL)
+			p->sitio = sitio;
+
+		if (p->sitio == sitio)  {
+			p->cantidad++;
+			p->ciclos_total += duracion;
+			if (duracion > p->ciclos_max)
+				p->ciclos_max = duracion;
+			return;
+		}
+	}
+
+	sitiosDescartados++;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve los puntos de llamada con las secciones criticas mas largas.
+     *
+     *  @details
+     *   Copia la tabla en una seccion critica (que tambien queda registrada) y la ordena
+     *   fuera de ella por ciclos_max de mayor a menor. Debe llamarse desde una sola tarea a
+     *   la vez, ya que la copia es estatica.
+     *
+	 *  @param destino		Donde copiar los puntos de llamada
+	 *  @param cantidad		Cantidad maxima a copiar
+	 *  @return     Cantidad de puntos de llamada copiados.
+***************************************************************************************************/
+uint16_t os_getPerfilCriticas(perfilCritica* destino, uint16_t cantidad)  {
+	perfilCritica aux;
+	uint16_t usados = 0;
+	uint16_t j;
+
+	os_enter_critical();
+	for (uint16_t i = 0; i < OS_PERFIL_CANT_SITIOS; i++)  {
+		if (perfilSitios[i].sitio != NULL)
+			copiaPerfil[usados++] = perfilSitios[i];
+	}
+	os_exit_critical();
+
+	/*
+	 * Ordenamiento por insercion, la tabla es chica
+	 */
+	for (uint16_t i = 1; i < usados; i++)  {
+		aux = copiaPerfil[i];
+		for (j = i; j > 0 && copiaPerfil[j-1].ciclos_max < aux.ciclos_max; j--)
+			copiaPerfil[j] = copiaPerfil[j-1];
+		copiaPerfil[j] = aux;
+	}
+
+	if (cantidad > usados)
+		cantidad = usados;
+
+	for (uint16_t i = 0; i < cantidad; i++)
+		destino[i] = copiaPerfil[i];
+
+	return cantidad;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de secciones criticas que no entraron en la tabla.
+     *
+	 *  @param 		None
+	 *  @return     Secciones de puntos de llamada que no se pudieron registrar, si es mayor a
+	 *  			cero conviene aumentar OS_PERFIL_CANT_SITIOS.
+***************************************************************************************************/
+uint32_t os_getSitiosDescartados(void)  {
+	return sitiosDescartados;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Reinicia el perfil de secciones criticas.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+void os_ReiniciarPerfilCriticas(void)  {
+	os_enter_critical();
+
+	for (uint16_t i = 0; i < OS_PERFIL_CANT_SITIOS; i++)  {
+		perfilSitios[i].sitio = NULL;
+		perfilSitios[i].cantidad = 0;
+		perfilSitios[i].ciclos_max = 0;
+		perfilSitios[i].ciclos_total = 0;
+	}
+	sitiosDescartados = 0;
+
+	os_exit_critical();
+}
+#endif
+
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa la estructura de una tarea y la agrega al OS.
+     *
+     *  @details
+     *   Arma el stack frame inicial, le asigna el menor id libre y la inserta en la lista de
+     *   tareas. Comun a os_InitTarea y os_CreateTask, que validan la prioridad y en el caso de
+     *   os_CreateTask la llaman dentro de una seccion critica.
+     *
+	 *  @param *entryPoint		Puntero a la tarea que se desea inicializar.
+	 *  @param *task			Estructura de control de la tarea.
+	 *  @param prioridad		Prioridad de la tarea, ya validada.
+	 *  @return     false si se alcanzo MAX_TASK_COUNT.
+***************************************************************************************************/
+static bool crearTarea(void *entryPoint, tarea *task, uint8_t prioridad)  {
+
+	if(control_OS.cantidad_Tareas >= MAX_TASK_COUNT)
+		return false;
+
+	/*
+	 * Antes de armar el stack frame inicial se pinta todo el stack con un patron conocido,
+	 * lo que permite luego medir cuanto stack llego a utilizar la tarea
+	 */
+	pintarStack(task);
+
+	task->stack[STACK_SIZE/4 - XPSR] = INIT_XPSR;					//necesario para bit thumb
+	task->stack[STACK_SIZE/4 - PC_REG] = OS_DIRECCION(entryPoint);	//direccion de la tarea (ENTRY_POINT)
+	task->stack[STACK_SIZE/4 - LR] = OS_DIRECCION(returnHook);		//Retorno de la tarea (no deberia darse)
+
+	/*
+	 * El valor previo de LR (que es EXEC_RETURN en este caso) es necesario dado que
+	 * en esta implementacion, se llama a una funcion desde dentro del handler de PendSV
+	 * con lo que el valor de LR se modifica por la direccion de retorno para cuando
+	 * se termina de ejecutar getContextoSiguiente
+	 */
+	task->stack[STACK_SIZE/4 - LR_PREV_VALUE] = EXEC_RETURN;
+
+	task->stack_pointer = OS_DIRECCION(task->stack + STACK_SIZE/4 - FULL_STACKING_SIZE);
+
+	/*
+	 * En esta seccion se guarda el entry point de la tarea, se le asigna id a la misma y se pone
+	 * la misma en estado READY. Todas las tareas se crean en estado READY.
+	 * Se asigna la prioridad de la misma. La estructura puede venir de una tarea eliminada,
+	 * por lo que tambien se limpia la cuenta de ticks de bloqueo.
+	 */
+	task->entry_point = entryPoint;
+	task->id = asignarId();
+	task->estado = TAREA_READY;
+	task->prioridad = prioridad;
+	task->ticks_bloqueada = 0;
+	task->lista_espera = NULL;
+	task->siguiente_espera = NULL;
+	task->despertar_pendiente = false;
+#if OS_EDF
+	task->deadline_relativo = OS_SIN_DEADLINE;
+	task->deadline_absoluto = 0;
+#endif
+#if OS_PRESUPUESTOS
+	task->presupuesto = OS_SIN_PRESUPUESTO;
+	task->ticks_reposicion = 0;
+	task->cant_agotamientos = 0;
+	task->degradada = false;
+#endif
+#if OS_MONITOR_PERIODICAS
+	task->periodo = 0;
+	task->trabajo_activo = false;
+#endif
+#if OS_ESTADISTICAS
+	task->ticks_cpu = 0;
+	task->cambios_contexto = 0;
+#endif
+
+	/*
+	 * Actualizacion de la estructura de control del OS, insertando el puntero a la estructura
+	 * de tarea en la lista ordenada por prioridad
+	 */
+	insertarEnLista(task);
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inserta una tarea en la lista de tareas.
+     *
+     *  @details
+     *   La lista de tareas se mantiene ordenada por prioridad, de mayor a menor, y en
+     *   inicioPrioridad se guarda la posicion de la primer tarea de cada prioridad. La tarea
+     *   se inserta al final de las de su prioridad, con lo que las tareas de igual prioridad
+     *   conservan el orden en que fueron creadas y el round-robin es deterministico. Solo se
+     *   desplazan las tareas de menor prioridad, sin reordenar la lista. Si la tarea esta
+     *   READY se contabiliza en el mapa de prioridades listas. Debe llamarse en seccion critica.
+     *
+	 *  @param task		Tarea a insertar
+	 *  @return     None.
+***************************************************************************************************/
+static void insertarEnLista(tarea* task)  {
+	uint8_t prioridad = task->prioridad;
+	uint16_t posicion;
+
+	posicion = control_OS.inicioPrioridad[prioridad] + control_OS.cantTareas_prioridad[prioridad];
+
+	memmove(&control_OS.listaTareas[posicion + 1], &control_OS.listaTareas[posicion],
+			sizeof(tarea*) * (control_OS.cantidad_Tareas - posicion));
+	control_OS.listaTareas[posicion] = task;
+
+	for (uint8_t prio = prioridad + 1; prio < PRIORITY_COUNT; prio++)
+		control_OS.inicioPrioridad[prio]++;
+
+	control_OS.cantidad_Tareas++;
+	control_OS.cantTareas_prioridad[prioridad]++;
+
+	if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)
+		agregarListas(task);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Quita una tarea de la lista de tareas.
+     *
+     *  @details
+     *   Contraparte de insertarEnLista. Se busca la tarea solo dentro de la subseccion de su
+     *   prioridad y se desplazan las tareas siguientes. Debe llamarse en seccion critica.
+     *
+	 *  @param task		Tarea a quitar
+	 *  @return     None.
+***************************************************************************************************/
+static void quitarDeLista(tarea* task)  {
+	uint8_t prioridad = task->prioridad;
+	uint16_t posicion = control_OS.inicioPrioridad[prioridad];
+	uint16_t fin = posicion + control_OS.cantTareas_prioridad[prioridad];
+
+	while (posicion < fin && control_OS.listaTareas[posicion] != task)
+		posicion++;
+
+	if (posicion == fin)  {
+		os_setError(ERR_OS_TAREA_INVALIDA,quitarDeLista);
+		return;
+	}
+
+	memmove(&control_OS.listaTareas[posicion], &control_OS.listaTareas[posicion + 1],
+			sizeof(tarea*) * (control_OS.cantidad_Tareas - posicion - 1));
+	control_OS.listaTareas[control_OS.cantidad_Tareas - 1] = NULL;
+
+	for (uint8_t prio = prioridad + 1; prio < PRIORITY_COUNT; prio++)
+		control_OS.inicioPrioridad[prio]--;
+
+	control_OS.cantidad_Tareas--;
+	control_OS.cantTareas_prioridad[prioridad]--;
+
+	if (task->estado == TAREA_READY || task->estado == TAREA_RUNNING)
+		quitarListas(task);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Quita una tarea de la lista de tareas demoradas.
+     *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una copia del estado de sistema actual
+     *   La lista no tiene orden, por lo que el lugar de la tarea lo ocupa la ultima. Debe
+     *   llamarse en seccion critica.
      *
-	 *  @param 		None
-	 *  @return     estado del OS.
+	 *  @param task		Tarea a quitar
+	 *  @return     None.
 ***************************************************************************************************/
-estadoOS os_getEstadoSistema(void)  {
-	return control_OS.estado_sistema;
+static void quitarDeDemoradas(tarea* task)  {
+	for (uint16_t i = 0; i < control_OS.cantDemoradas; i++)  {
+		if (control_OS.listaDemoradas[i] == task)  {
+			control_OS.listaDemoradas[i] = control_OS.listaDemoradas[--control_OS.cantDemoradas];
+			break;
+		}
+	}
+
+	task->ticks_bloqueada = 0;
 }
 
 
+/*************************************************************************************************
+	 *  @brief Inserta una tarea en una lista de espera.
+     *
+     *  @details
+     *   La lista se recorre desde la primera tarea hasta la primera de menor prioridad, con
+     *   lo que la tarea queda detras de las de su misma prioridad. Debe llamarse en seccion
+     *   critica.
+     *
+	 *  @param lista	Lista de espera
+	 *  @param task		Tarea a insertar, que no debe estar en ninguna lista
+	 *  @return     None.
+***************************************************************************************************/
+static void insertarEnEspera(listaEspera* lista, tarea* task)  {
+	tarea** enlace = &lista->primera;
+
+	while (*enlace != NULL && (*enlace)->prioridad <= task->prioridad)
+		enlace = &(*enlace)->siguiente_espera;
+
+	task->siguiente_espera = *enlace;
+	task->lista_espera = lista;
+	*enlace = task;
+}
+
 
 /*************************************************************************************************
-	 *  @brief Cambia el estado de sistema al pasado como argumento por esta funcion.
+	 *  @brief Quita una tarea de la lista de espera en la que esta.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una manera de actualizar el estado del sistema en otros archivos
+     *   Debe llamarse en seccion critica.
      *
-	 *  @param 		None
-	 *  @return     estado del OS.
+	 *  @param task		Tarea a quitar, que debe estar en una lista
+	 *  @return     None.
 ***************************************************************************************************/
-void os_setEstadoSistema(estadoOS estado)  {
-	control_OS.estado_sistema = estado;
+static void quitarDeEspera(tarea* task)  {
+	tarea** enlace = &task->lista_espera->primera;
+
+	while (*enlace != task)
+		enlace = &(*enlace)->siguiente_espera;
+
+	*enlace = task->siguiente_espera;
+	task->siguiente_espera = NULL;
+	task->lista_espera = NULL;
 }
 
 
 /*************************************************************************************************
-	 *  @brief Setea la bandera de scheduling desde ISR.
+	 *  @brief Asigna el menor id libre.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una forma de setear la bandera correspondiente a la necesidad
-     *   de ejecutar un scheduling antes de salir de una interrupcion
+     *   Los ids de las tareas eliminadas se liberan en idsUsados, por lo que crear y eliminar
+     *   tareas indefinidamente nunca agota los ids. Solo debe llamarse si la cantidad de
+     *   tareas es menor a MAX_TASK_COUNT, lo que asegura que existe un id libre.
      *
-	 *  @param 		value	El valor a escribir en la bandera correspondiente
-	 *  @return     none.
+	 *  @param 		None
+	 *  @return     Id asignado.
 ***************************************************************************************************/
-void os_setScheduleDesdeISR(bool value)  {
-	control_OS.schedulingFromIRQ = value;
+static uint16_t asignarId(void)  {
+	uint16_t palabra = 0;
+	uint16_t id;
+
+	while (control_OS.idsUsados[palabra] == 0xFFFFFFFF)
+		palabra++;
+
+	id = palabra * 32 + __builtin_ctz(~control_OS.idsUsados[palabra]);
+	control_OS.idsUsados[palabra] |= (1UL << (id % 32));
+
+	return id;
 }
 
 
 /*************************************************************************************************
-	 *  @brief Devuelve una copia del valor del estado de sistema.
+	 *  @brief Aplica el desalojo luego de modificar las tareas listas.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una forma de obtener el valor de la bandera correspondiente a la
-     *   necesidad de ejecutar un scheduling antes de salir de una interrupcion
+     *   Luego de crear, reanudar o cambiar la prioridad de una tarea puede existir una tarea
+     *   lista de mayor prioridad que la actual, y luego de suspender o eliminar la tarea actual
+     *   esta ya no puede seguir corriendo. En ambos casos se fuerza un scheduling. Desde un
+     *   handler se deja indicado para que se haga al salir del mismo. Antes del primer
+     *   scheduling no hay tarea actual y no se hace nada.
      *
 	 *  @param 		None
-	 *  @return     Valor de la bandera correspondiente.
+	 *  @return     None.
 ***************************************************************************************************/
-bool os_getScheduleDesdeISR(void)  {
-	return control_OS.schedulingFromIRQ;
+static void evaluarDesalojo(void)  {
+	tarea* actual = control_OS.tarea_actual;
+
+	if (control_OS.estado_sistema == OS_IRQ_RUN)  {
+		control_OS.schedulingFromIRQ = true;
+		return;
+	}
+
+	if (actual == NULL)
+		return;
+
+	if (actual->estado != TAREA_RUNNING || hayDesalojo(actual))
+		os_CpuYield();
 }
 
 
 /*************************************************************************************************
-	 *  @brief Levanta un error de sistema.
+	 *  @brief Mueve una tarea a otra prioridad.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una forma de setear el codigo de error y lanza una ejecucion
-     *   de errorHook
+     *   Quita la tarea de la subseccion de su prioridad y la agrega al final de la nueva. No
+     *   evalua el desalojo. Debe llamarse en seccion critica.
      *
-	 *  @param 		err		El codigo de error que ha surgido
-	 *  @param		caller	Puntero a la funcion que llama a esta funcion
-	 *  @return     none.
+	 *  @param task			Tarea a mover
+	 *  @param prioridad	Nueva prioridad
+	 *  @return     None.
 ***************************************************************************************************/
-void os_setError(int32_t err, void* caller)  {
-	control_OS.error = err;
-	errorHook(caller);
+static void cambiarPrioridad(tarea* task, uint8_t prioridad)  {
+	listaEspera* lista = task->lista_espera;
+
+	if (task->prioridad != prioridad)  {
+		quitarDeLista(task);
+		task->prioridad = prioridad;
+		insertarEnLista(task);
+
+		if (lista != NULL)  {
+			quitarDeEspera(task);
+			insertarEnEspera(lista, task);
+		}
+	}
 }
 
 
 /*************************************************************************************************
-	 *  @brief Levanta un error de sistema.
+	 *  @brief Agrega una tarea al conjunto de tareas listas.
      *
      *  @details
-     *   En aras de mantener la estructura de control aislada solo en el archivo de core esta
-     *   funcion proporciona una forma de setear el codigo de warning. Se almacena en la misma
-     *   variable que error porque en OS sigue funcionando. En el caso de error, el OS deja de
-     *   funcionar, con lo que son dos casos mutuamente excluyentes.
+     *   Unico punto donde una tarea pasa a contar como READY o RUNNING para el scheduler:
+     *   actualiza la cantidad de tareas listas de su prioridad y el mapa de bits, y en modo
+     *   EDF, si la tarea tiene deadline, la inserta en el heap. Debe llamarse en seccion
+     *   critica.
      *
-	 *  @param 		warn	El codigo de advertencia que ha surgido
-	 *  @return     none.
+	 *  @param task		Tarea que paso a READY
+	 *  @return     None.
 ***************************************************************************************************/
-void os_setWarning(int32_t warn)  {
-	control_OS.error = warn;
+static void agregarListas(tarea* task)  {
+	control_OS.cantListas_prioridad[task->prioridad]++;
+	control_OS.prioridadesListas |= (1UL << task->prioridad);
+
+#if OS_EDF
+	if (TIENE_DEADLINE(task))
+		heapInsertar(task);
+#endif
 }
 
 
+/*************************************************************************************************
+	 *  @brief Quita una tarea del conjunto de tareas listas.
+     *
+     *  @details
+     *   Contraparte de agregarListas. Debe llamarse en seccion critica.
+     *
+	 *  @param task		Tarea que dejo de estar READY o RUNNING
+	 *  @return     None.
+***************************************************************************************************/
+static void quitarListas(tarea* task)  {
+	if (--control_OS.cantListas_prioridad[task->prioridad] == 0)
+		control_OS.prioridadesListas &= ~(1UL << task->prioridad);
+
+#if OS_EDF
+	if (TIENE_DEADLINE(task))
+		heapQuitar(task);
+#endif
+}
 
 
 /*************************************************************************************************
-	 *  @brief Marca el inicio de una seccion como seccion critica.
+	 *  @brief Determina si existe una tarea lista que debe desalojar a la actual.
      *
      *  @details
-     *   Las secciones criticas son aquellas que deben ejecutar operaciones atomicas, es decir que
-     *   no pueden ser interrumpidas. Con llamar a esta funcion, se otorga soporte en el OS
-     *   para marcar un bloque de codigo como atomico
+     *   Con prioridades fijas, si la prioridad lista mas alta del mapa de bits es mayor que la
+     *   de la tarea actual. En modo EDF una tarea con deadline lista desaloja a cualquier tarea
+     *   sin deadline, y a una con deadline solo si vence estrictamente antes; sin tareas con
+     *   deadline listas se aplica el criterio de prioridades. En ambos casos es de tiempo
+     *   constante.
      *
-	 *  @param 		None
-	 *  @return     None
-	 *  @see 		os_exit_critical
+	 *  @param actual	Tarea en ejecucion, en estado RUNNING
+	 *  @return     true si es necesario un scheduling.
 ***************************************************************************************************/
-inline void os_enter_critical()  {
-	__disable_irq();
-	control_OS.contador_critico++;
+static bool hayDesalojo(tarea* actual)  {
+#if OS_EDF
+	if (control_OS.cantHeap > 0)
+		return !TIENE_DEADLINE(actual) || antesQue(control_OS.heapListas[0], actual);
+#endif
+
+	return control_OS.prioridadesListas != 0 &&
+			__builtin_ctz(control_OS.prioridadesListas) < actual->prioridad;
 }
 
 
+
+#if OS_EDF
 /*************************************************************************************************
-	 *  @brief Marca el final de una seccion como seccion critica.
+	 *  @brief Criterio de orden del heap de tareas listas.
      *
      *  @details
-     *   Las secciones criticas son aquellas que deben ejecutar operaciones atomicas, es decir que
-     *   no pueden ser interrumpidas. Con llamar a esta funcion, se otorga soporte en el OS
-     *   para marcar un bloque de codigo como atomico
+     *   Las tareas se ordenan por deadline absoluto. La resta en 32 bits con signo hace que
+     *   la comparacion siga siendo correcta cuando el contador de ticks da la vuelta,
+     *   mientras los deadlines relativos sean menores a 2^31 ticks.
      *
-	 *  @param 		None
-	 *  @return     None
-	 *  @see 		os_enter_critical
+	 *  @param a	Tarea a comparar
+	 *  @param b	Tarea a comparar
+	 *  @return     true si el trabajo de a vence antes que el de b.
 ***************************************************************************************************/
-inline void os_exit_critical()  {
-	if (--control_OS.contador_critico <= 0)  {
-		control_OS.contador_critico = 0;
-		__enable_irq();
+static bool antesQue(tarea* a, tarea* b)  {
+	return (int32_t) (a->deadline_absoluto - b->deadline_absoluto) < 0;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Operaciones del heap de minimo de tareas listas.
+     *
+     *  @details
+     *   heapListas es un heap binario implicito con las tareas READY o RUNNING que tienen
+     *   deadline: los hijos de la posicion i estan en 2i+1 y 2i+2. Cada tarea guarda su
+     *   posicion en indice_heap, con lo que quitar una tarea cualquiera (al bloquearse) es
+     *   O(log n) sin buscarla. Insertar y quitar tambien son O(log n) y obtener la proxima
+     *   tarea es O(1). Deben llamarse en seccion critica.
+***************************************************************************************************/
+static void heapIntercambiar(uint16_t i, uint16_t j)  {
+	tarea* aux = control_OS.heapListas[i];
+
+	control_OS.heapListas[i] = control_OS.heapListas[j];
+	control_OS.heapListas[j] = aux;
+
+	control_OS.heapListas[i]->indice_heap = i;
+	control_OS.heapListas[j]->indice_heap = j;
+}
+
+
+static void heapSubir(uint16_t i)  {
+	while (i > 0 && antesQue(control_OS.heapListas[i], control_OS.heapListas[(i - 1) / 2]))  {
+		heapIntercambiar(i, (i - 1) / 2);
+		i = (i - 1) / 2;
+	}
+}
+
+
+static void heapBajar(uint16_t i)  {
+	uint16_t menor, hijo;
+
+	while (1)  {
+		menor = i;
+		hijo = 2 * i + 1;
+
+		if (hijo < control_OS.cantHeap &&
+				antesQue(control_OS.heapListas[hijo], control_OS.heapListas[menor]))
+			menor = hijo;
+
+		if (hijo + 1 < control_OS.cantHeap &&
+				antesQue(control_OS.heapListas[hijo + 1], control_OS.heapListas[menor]))
+			menor = hijo + 1;
+
+		if (menor == i)
+			break;
+
+		heapIntercambiar(i, menor);
+		i = menor;
+	}
+}
+
+
+static void heapInsertar(tarea* task)  {
+	task->indice_heap = control_OS.cantHeap;
+	control_OS.heapListas[control_OS.cantHeap++] = task;
+	heapSubir(task->indice_heap);
+}
+
+
+/*
+ * El lugar de la tarea quitada lo ocupa la ultima hoja, que puede tener que subir o bajar.
+ * Si sube, la posicion i queda ocupada por su antiguo padre y heapBajar no la mueve
+ */
+static void heapQuitar(tarea* task)  {
+	uint16_t i = task->indice_heap;
+
+	control_OS.cantHeap--;
+
+	if (i != control_OS.cantHeap)  {
+		control_OS.heapListas[i] = control_OS.heapListas[control_OS.cantHeap];
+		control_OS.heapListas[i]->indice_heap = i;
+		heapSubir(i);
+		heapBajar(i);
 	}
 }
+#endif
 
 
 
 /*************************************************************************************************
-	 *  @brief Ordena tareas de mayor a menor prioridad.
+	 *  @brief Pinta el stack de una tarea.
      *
      *  @details
-     *   Ordena los punteros a las estructuras del tipo tarea que estan almacenados en la variable
-     *   de control de OS en el array listadoTareas por prioridad, de mayor a menor. Para esto
-     *   utiliza un algoritmo de quicksort. Esto da la posibilidad de cambiar la prioridad
-     *   de cualquier tarea en tiempo de ejecucion.
+     *   Llena el stack completo con STACK_PATTERN y coloca el centinela STACK_CANARY en la
+     *   posicion mas baja fuera de la guarda del MPU (el stack crece hacia direcciones menores). Debe llamarse antes de
+     *   armar el stack frame inicial porque lo sobreescribe.
      *
-	 *  @param 		None
+	 *  @param 		task	Puntero a la estructura de la tarea cuyo stack se pinta
+	 *  @return     None.
+***************************************************************************************************/
+static void pintarStack(tarea* task)  {
+	for (uint32_t i = 0; i < STACK_SIZE/4; i++)
+		task->stack[i] = STACK_PATTERN;
+
+	task->stack[STACK_CANARY_POS] = STACK_CANARY;
+}
+
+
+#if OS_STACK_GUARDA_MPU
+/*************************************************************************************************
+	 *  @brief Programa la region de guarda del MPU para la tarea entrante.
+     *
+     *  @details
+     *   Marca los primeros STACK_GUARDA_SIZE bytes del stack de la tarea como region sin acceso.
+     *   Cualquier escritura por debajo de ese limite produce un MemManage fault en el mismo
+     *   momento del desborde, antes de que se corrompa memoria ajena.
+     *
+	 *  @param 		task	Tarea que pasa a estado RUNNING
+	 *  @return     None.
+***************************************************************************************************/
+static void setGuardaMPU(tarea* task)  {
+	MPU->RNR = OS_MPU_REGION_GUARDA;
+	MPU->RBAR = (uint32_t) task->stack;
+	MPU->RASR = MPU_RASR_XN_Msk | (4 << MPU_RASR_SIZE_Pos) | MPU_RASR_ENABLE_Msk;	//AP = 000, 2^(4+1) = 32 bytes
+	__DSB();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Handler de MemManage.
+     *
+     *  @details
+     *   Con la guarda habilitada, la unica region que el OS protege es la base de los stacks,
+     *   por lo que un fault de este tipo se reporta como desborde de stack.
+     *
+	 *  @param 		None.
 	 *  @return     None.
 ***************************************************************************************************/
-static void ordenarPrioridades(void)  {
-	// Create an auxiliary stack
-	int32_t stack[MAX_TASK_COUNT];
+void MemManage_Handler(void)  {
+	os_setError(ERR_OS_STACK_OVERFLOW,MemManage_Handler);
+}
+#endif
 
-	// initialize top of stack
-	int32_t top = -1;
-	int32_t l = 0;
-	int32_t h = control_OS.cantidad_Tareas - 1;
 
-	// push initial values of l and h to stack (indices a estructuras de tareas)
-	stack[++top] = l;
-	stack[++top] = h;
 
-	// Keep popping from stack while is not empty
-	while (top >= 0) {
-		// Pop h and l
-		h = stack[top--];
-		l = stack[top--];
+#if OS_PRESUPUESTOS
+/*************************************************************************************************
+	 *  @brief Contabiliza el consumo de CPU y repone presupuestos.
+     *
+     *  @details
+     *   Se llama en cada tick. Primero descuenta el periodo de reposicion de las tareas de
+     *   listaReposiciones, con el mismo esquema que listaDemoradas, y repone las que llegan a
+     *   cero. Luego cobra el tick a la tarea actual si tiene presupuesto: el primer tick que
+     *   consume con el presupuesto completo agenda la reposicion un periodo mas tarde, como en
+     *   un servidor esporadico con una unica reposicion pendiente. Una tarea degradada no
+     *   consume presupuesto.
+     *
+	 *  @param actual	Tarea que estaba en ejecucion durante el tick
+	 *  @return     None.
+***************************************************************************************************/
+static void actualizarPresupuestos(tarea* actual)  {
+	uint16_t i = 0;
+	tarea* task;
 
-		// Set pivot element at its correct position
-		// in sorted array
-		int32_t p = partition(control_OS.listaTareas, l, h);
+	while (i < control_OS.cantReposiciones)  {
+		task = control_OS.listaReposiciones[i];
 
-		// If there are elements on left side of pivot,
-		// then push left side to stack
-		if (p - 1 > l) {
-			stack[++top] = l;
-			stack[++top] = p - 1;
+		if (--task->ticks_reposicion == 0)  {
+			control_OS.listaReposiciones[i] = control_OS.listaReposiciones[--control_OS.cantReposiciones];
+			reponerPresupuesto(task);
 		}
+		else
+			i++;
+	}
+
+	if (actual == NULL || actual == &tareaIdle || actual->estado != TAREA_RUNNING ||
+			actual->presupuesto == OS_SIN_PRESUPUESTO || actual->degradada)
+		return;
+
+	if (actual->ticks_reposicion == 0)  {
+		actual->ticks_reposicion = actual->periodo_reposicion;
+		control_OS.listaReposiciones[control_OS.cantReposiciones++] = actual;
+	}
+
+	if (actual->presupuesto_restante <= 1)  {
+		actual->presupuesto_restante = 0;
+		agotarPresupuesto(actual);
+	}
+	else
+		actual->presupuesto_restante--;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Aplica la accion configurada a una tarea que agoto su presupuesto.
+     *
+     *  @details
+     *   Con OS_PRESUPUESTO_SUSPENDER la tarea pasa a TAREA_AGOTADA, estado del que solo sale
+     *   en la reposicion. Con OS_PRESUPUESTO_DEGRADAR se guarda su prioridad y pasa a
+     *   OS_PRIORIDAD_DEGRADADA (si la suya no es menor), donde sigue compitiendo solo con las
+     *   tareas de segundo plano. Debe llamarse en seccion critica o desde el SysTick.
+     *
+	 *  @param task		Tarea que agoto su presupuesto
+	 *  @return     None.
+***************************************************************************************************/
+static void agotarPresupuesto(tarea* task)  {
+	task->cant_agotamientos++;
+
+	if (task->accion_presupuesto == OS_PRESUPUESTO_DEGRADAR)  {
+		task->degradada = true;
+		task->prioridad_base = task->prioridad;
+
+		if (task->prioridad < OS_PRIORIDAD_DEGRADADA)
+			cambiarPrioridad(task, OS_PRIORIDAD_DEGRADADA);
+	}
+	else  {
+		os_BloquearTarea(task);
+		task->estado = TAREA_AGOTADA;
+	}
+
+	presupuestoHook(task);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Repone el presupuesto completo de una tarea.
+     *
+     *  @details
+     *   Devuelve a la tarea su prioridad si estaba degradada, o la pasa a READY si estaba
+     *   detenida por presupuesto agotado. Una tarea suspendida con os_Suspend sigue suspendida.
+     *   Debe llamarse en seccion critica o desde el SysTick.
+     *
+	 *  @param task		Tarea a reponer
+	 *  @return     None.
+***************************************************************************************************/
+static void reponerPresupuesto(tarea* task)  {
+	task->presupuesto_restante = task->presupuesto;
+
+	if (task->degradada)  {
+		task->degradada = false;
+		cambiarPrioridad(task, task->prioridad_base);
+	}
+
+	if (task->estado == TAREA_AGOTADA)  {
+		task->estado = TAREA_BLOCKED;
+		os_DesbloquearTarea(task);
+	}
+}
+
 
-		// If there are elements on right side of pivot,
-		// then push right side to stack
-		if (p + 1 < h) {
-			stack[++top] = p + 1;
-			stack[++top] = h;
+/*************************************************************************************************
+	 *  @brief Quita una tarea de la lista de reposiciones pendientes.
+     *
+     *  @details
+     *   Contraparte de quitarDeDemoradas para listaReposiciones. Debe llamarse en seccion
+     *   critica.
+     *
+	 *  @param task		Tarea a quitar
+	 *  @return     None.
+***************************************************************************************************/
+static void quitarDeReposiciones(tarea* task)  {
+	for (uint16_t i = 0; i < control_OS.cantReposiciones; i++)  {
+		if (control_OS.listaReposiciones[i] == task)  {
+			control_OS.listaReposiciones[i] = control_OS.listaReposiciones[--control_OS.cantReposiciones];
+			break;
 		}
 	}
+
+	task->ticks_reposicion = 0;
 }
+#endif
+
 
 
+#if OS_MONITOR_PERIODICAS
 /*************************************************************************************************
-	 *  @brief Ordena tareas de mayor a menor prioridad.
+	 *  @brief Libera trabajos de tareas periodicas y detecta deadlines perdidos.
      *
      *  @details
-     *   Funcion de soporte para ordenarPrioridades. No debe llamarse fuera de mencionada
-     *   funcion.
+     *   Se llama en cada tick y recorre solo las tareas periodicas. Si al liberar un trabajo
+     *   el anterior no termino, la liberacion queda pendiente y se cuenta como solapada. Un
+     *   trabajo que sigue en curso cuando su tiempo desde la liberacion supera el deadline se
+     *   cuenta como perdido una sola vez, sin esperar a que termine.
      *
-	 *  @param 	arr		Puntero a la lista de punteros de estructuras de tareas a ordenar
-	 *  @param	l		Inicio del vector a ordenar (puede ser un subvector)
-	 *  @param	h		Fin del vector a ordenar (puede ser un subvector)
-	 *  @return     	Retorna la posicion del pivot necesario para el algoritmo
+	 *  @param 		None
+	 *  @return     None.
 ***************************************************************************************************/
-static int32_t partition(tarea** arr, int32_t l, int32_t h)  {
-	tarea* x = arr[h];
-	tarea* aux;
-	int32_t i = (l - 1);
+static void actualizarPeriodicas(void)  {
+	tarea* task;
 
-	for (int j = l; j <= h - 1; j++) {
-		if (arr[j]->prioridad <= x->prioridad) {
-			i++;
-			//swap(&arr[i], &arr[j]);
-			aux = arr[i];
-			arr[i] = arr[j];
-			arr[j] = aux;
+	for (uint16_t i = 0; i < control_OS.cantPeriodicas; i++)  {
+		task = control_OS.listaPeriodicas[i];
+
+		if (task->trabajo_activo && !task->deadline_perdido &&
+				control_OS.ticks_sistema - task->liberacion > task->deadline)  {
+			task->deadline_perdido = true;
+			task->estadisticas.deadlines_perdidos++;
+			deadlineHook(task);
+		}
+
+		if (--task->ticks_liberacion == 0)  {
+			task->ticks_liberacion = task->periodo;
+
+			if (task->trabajo_activo)  {
+				task->liberaciones_pendientes++;
+				task->estadisticas.liberaciones_solapadas++;
+			}
+			else  {
+				task->trabajo_activo = true;
+				task->liberacion = control_OS.ticks_sistema;
+				os_DesbloquearTarea(task);
+			}
 		}
 	}
-	//swap(&arr[i + 1], &arr[h]);
-	aux = arr[i+1];
-	arr[i+1] = arr[h];
-	arr[h] = aux;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega un tiempo de respuesta a las estadisticas de una tarea.
+     *
+     *  @details
+     *   La posicion del histograma es la cantidad de bits significativos de la respuesta, con
+     *   lo que se calcula con una sola instruccion CLZ.
+     *
+	 *  @param task			Tarea periodica
+	 *  @param respuesta	Ticks desde la liberacion hasta el fin del trabajo
+	 *  @return     None.
+***************************************************************************************************/
+static void registrarRespuesta(tarea* task, uint32_t respuesta)  {
+	estadisticasPeriodica* est = &task->estadisticas;
+	uint32_t pos = (respuesta == 0) ? 0 : 32 - __builtin_clz(respuesta);
 
-	return (i + 1);
+	if (pos >= OS_CANT_HIST_RESPUESTA)
+		pos = OS_CANT_HIST_RESPUESTA - 1;
+
+	est->trabajos++;
+	est->histograma[pos]++;
+
+	if (respuesta < est->respuesta_min)
+		est->respuesta_min = respuesta;
+
+	if (respuesta > est->respuesta_max)
+		est->respuesta_max = respuesta;
 }
 
 
+/*************************************************************************************************
+	 *  @brief Quita una tarea de la lista de tareas periodicas.
+     *
+     *  @details
+     *   Contraparte de quitarDeDemoradas para listaPeriodicas. Debe llamarse en seccion
+     *   critica.
+     *
+	 *  @param task		Tarea a quitar
+	 *  @return     None.
+***************************************************************************************************/
+static void quitarDePeriodicas(tarea* task)  {
+	for (uint16_t i = 0; i < control_OS.cantPeriodicas; i++)  {
+		if (control_OS.listaPeriodicas[i] == task)  {
+			control_OS.listaPeriodicas[i] = control_OS.listaPeriodicas[--control_OS.cantPeriodicas];
+			break;
+		}
+	}
 
+	task->periodo = 0;
+}
+#endif
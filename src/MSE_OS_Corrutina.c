@@ -0,0 +1,271 @@
+/*
+ * MSE_OS_Corrutina.c
+ *
+ *  Ejecutor de corrutinas sin stack, ver MSE_OS_Corrutina.h
+ */
+
+
+#include "MSE_OS_Corrutina.h"
+
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa un ejecutor sin corrutinas.
+     *
+	 *  @param 		ejecutor	Ejecutor a inicializar
+	 *  @return     None
+***************************************************************************************************/
+void os_EjecutorInit(osEjecutor* ejecutor)  {
+	ejecutor->primera = NULL;
+	ejecutor->tarea_ejecutor = NULL;
+	ejecutor->cantidad = 0;
+	ejecutor->aviso = false;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega una corrutina a un ejecutor.
+     *
+     *  @details
+     *   La corrutina empieza desde el principio de su cuerpo en la proxima pasada del
+     *   ejecutor. Puede llamarse antes de os_Init, desde cualquier tarea o desde una
+     *   corrutina del mismo ejecutor, pero no desde un handler. La corrutina no debe estar
+     *   en ningun ejecutor.
+     *
+	 *  @param 		ejecutor	Ejecutor
+	 *  @param 		co			Corrutina, memoria provista por el usuario
+	 *  @param 		cuerpo		Funcion de la corrutina
+	 *  @param 		datos		Datos de la sesion, disponibles en co->datos
+	 *  @return     None
+***************************************************************************************************/
+void os_EjecutorAgregar(osEjecutor* ejecutor, osCorrutina* co, cuerpoCorrutina cuerpo, void* datos)  {
+	co->cuerpo = cuerpo;
+	co->datos = datos;
+	co->objeto = NULL;
+	co->punto = 0;
+	co->espera = CO_ESPERA_NINGUNA;
+
+	os_enter_critical();
+
+	co->siguiente = ejecutor->primera;
+	ejecutor->primera = co;
+	ejecutor->cantidad++;
+
+	os_exit_critical();
+
+	os_EjecutorAvisar(ejecutor);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Despierta al ejecutor.
+     *
+     *  @details
+     *   Hace que el ejecutor haga una pasada mas antes de volver a bloquearse, aunque este
+     *   recorriendo la lista. Sirve para las corrutinas que esperan con OS_CO_ESPERAR_HASTA
+     *   una condicion que cambia otra tarea o un handler, que de otro modo se evalua cada
+     *   OS_EJECUTOR_SONDEO ticks. Puede llamarse desde un handler.
+     *
+	 *  @param 		ejecutor	Ejecutor
+	 *  @return     None
+***************************************************************************************************/
+void os_EjecutorAvisar(osEjecutor* ejecutor)  {
+	os_enter_critical();
+
+	ejecutor->aviso = true;
+
+	if (ejecutor->tarea_ejecutor != NULL)
+		os_DesbloquearTarea(ejecutor->tarea_ejecutor);
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Indica si una corrutina puede avanzar, sin correrla.
+     *
+     *  @details
+     *   Las colas y los semaforos se consultan sin tomarlos: la corrutina los toma al correr,
+     *   y si otra tarea se adelanto vuelve a esperar. Las condiciones solo se pueden evaluar
+     *   corriendo la corrutina.
+     *
+	 *  @param 		co			Corrutina
+	 *  @param 		ahora		Tick actual
+	 *  @return     true si hay que correrla.
+***************************************************************************************************/
+static bool puedeAvanzar(osCorrutina* co, uint32_t ahora)  {
+	osCola* cola;
+
+	switch (co->espera)  {
+	case CO_ESPERA_DEMORA:
+		return (int32_t) (ahora - co->vencimiento) >= 0;
+
+	case CO_ESPERA_COLA:
+		cola = co->objeto;
+		return cola->indice_head != cola->indice_tail;
+
+	case CO_ESPERA_SEMAFORO:
+		return !((osSemaforo*) co->objeto)->tomado;
+
+	default:
+		return true;
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Quita una corrutina terminada de la lista.
+     *
+     *  @details
+     *   Se hace en seccion critica porque otra tarea puede estar agregando al principio de
+     *   la lista. Como solo se agrega al principio, la corrutina esta en el enlace recibido
+     *   o mas adelante.
+     *
+	 *  @param 		ejecutor	Ejecutor
+	 *  @param 		enlace		Enlace que apuntaba a la corrutina al correrla
+	 *  @param 		co			Corrutina terminada
+	 *  @return     None
+***************************************************************************************************/
+static void quitarCorrutina(osEjecutor* ejecutor, osCorrutina** enlace, osCorrutina* co)  {
+	os_enter_critical();
+
+	while (*enlace != co)
+		enlace = &(*enlace)->siguiente;
+
+	*enlace = co->siguiente;
+	ejecutor->cantidad--;
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Bloquea al ejecutor hasta que alguna corrutina pueda avanzar.
+     *
+     *  @details
+     *   La espera termina con cualquier desbloqueo de la tarea: la demora, un give o una
+     *   escritura en un objeto que una corrutina consulto sin exito (los *SinEspera dejan
+     *   al ejecutor como tarea asociada) u os_EjecutorAvisar. No hace falta distinguir cual:
+     *   la pasada siguiente reevalua todas las esperas. Un evento que llega mientras el
+     *   ejecutor recorre la lista encuentra a la tarea corriendo y solo marca
+     *   despertar_pendiente, que aqui evita el bloqueo. El vencimiento es un tick absoluto,
+     *   por lo que un tick que paso durante el recorrido no atrasa a la corrutina.
+     *
+	 *  @param 		ejecutor	Ejecutor
+	 *  @param 		demorado	true si hay un vencimiento, false para esperar solo un evento
+	 *  @param 		vencimiento	Tick en que debe despertar
+	 *  @return     None
+***************************************************************************************************/
+static void dormir(osEjecutor* ejecutor, bool demorado, uint32_t vencimiento)  {
+	tarea* task = ejecutor->tarea_ejecutor;
+	uint32_t resto;
+
+	os_enter_critical();
+
+	//!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+	resto = vencimiento - os_getTicks();
+
+	if (!ejecutor->aviso && !task->despertar_pendiente && !(demorado && (int32_t) resto <= 0))  {
+		if (demorado)
+			os_DemorarTarea(task, resto);
+
+		os_BloquearTarea(task);
+
+		os_exit_critical();
+		os_CpuYield();
+		os_enter_critical();
+
+		os_CancelarDemora(task);
+	}
+
+	ejecutor->aviso = false;
+	task->despertar_pendiente = false;
+	//---------------------------------------------------------------------------
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Corre las corrutinas de un ejecutor.
+     *
+     *  @details
+     *   Entry point (o final) de la tarea del ejecutor, no retorna. Cada pasada recorre la
+     *   lista y corre las corrutinas que pueden avanzar, que retornan al llegar a una espera
+     *   o al terminar; las terminadas salen de la lista. Si alguna quedo lista (por ejemplo
+     *   con OS_CO_CEDER) hace otra pasada; si no, bloquea a la tarea hasta la demora mas
+     *   proxima o un evento. La prioridad del ejecutor es la de todas sus corrutinas.
+     *
+	 *  @param 		ejecutor	Ejecutor inicializado con os_EjecutorInit
+	 *  @return     None
+***************************************************************************************************/
+void os_EjecutorCorrer(osEjecutor* ejecutor)  {
+	osCorrutina** enlace;
+	osCorrutina* co;
+	uint32_t vencimiento;
+	uint32_t candidato;
+	bool demorado;
+	bool lista;
+
+	ejecutor->tarea_ejecutor = os_getTareaActual();
+
+	while (1)  {
+		demorado = false;
+		vencimiento = 0;
+		lista = false;
+		enlace = &ejecutor->primera;
+
+		/*
+		 * Los eventos anteriores a la pasada se ven al recorrer la lista; solo cuentan los
+		 * que lleguen durante el recorrido
+		 */
+		ejecutor->tarea_ejecutor->despertar_pendiente = false;
+
+		while ((co = *enlace) != NULL)  {
+			if (puedeAvanzar(co, os_getTicks()) && co->cuerpo(co) == CORRUTINA_TERMINADA)  {
+				quitarCorrutina(ejecutor, enlace, co);
+				continue;
+			}
+
+			/*
+			 * Vencimiento del ejecutor: la demora mas proxima, limitada a OS_EJECUTOR_SONDEO
+			 * si alguna espera una condicion. Las colas y semaforos despiertan al ejecutor
+			 */
+			switch (co->espera)  {
+			case CO_ESPERA_NINGUNA:
+				lista = true;
+				break;
+
+			case CO_ESPERA_DEMORA:
+			case CO_ESPERA_CONDICION:
+				candidato = (co->espera == CO_ESPERA_DEMORA) ? co->vencimiento :
+						os_getTicks() + OS_EJECUTOR_SONDEO;
+
+				if (!demorado || (int32_t) (candidato - vencimiento) < 0)
+					vencimiento = candidato;
+
+				demorado = true;
+				break;
+
+			default:
+				break;
+			}
+
+			enlace = &co->siguiente;
+		}
+
+		if (!lista)
+			dormir(ejecutor, demorado, vencimiento);
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de corrutinas de un ejecutor.
+     *
+	 *  @param 		ejecutor	Ejecutor
+	 *  @return     Corrutinas agregadas que todavia no terminaron.
+***************************************************************************************************/
+uint16_t os_EjecutorCantidad(osEjecutor* ejecutor)  {
+	return ejecutor->cantidad;
+}
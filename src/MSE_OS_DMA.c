@@ -0,0 +1,102 @@
+/*
+ * MSE_OS_DMA.c
+ *
+ *  Despachador de las interrupciones del GPDMA, ver MSE_OS_DMA.h
+ */
+
+
+#include "MSE_OS_DMA.h"
+
+
+struct _canalDMA  {
+	void (*callback)(void*);
+	void* contexto;
+};
+
+typedef struct _canalDMA canalDMA;
+
+
+static canalDMA canales[OS_DMA_CANALES];
+static bool dmaIniciado;
+
+
+/*************************************************************************************************
+	 *  @brief Handler de la interrupcion del GPDMA.
+     *
+     *  @details
+     *   Se instala con os_InstalarIRQ, por lo que corre con el OS en OS_IRQ_RUN. Para cada
+     *   canal reservado, Chip_GPDMA_Interrupt limpia el pedido de interrupcion y devuelve
+     *   SUCCESS si termino la transferencia, en cuyo caso se llama al callback del canal.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+static void dma_ISR(void)  {
+	for (uint8_t i = 0; i < OS_DMA_CANALES; i++)  {
+		if (canales[i].callback != NULL && Chip_GPDMA_Interrupt(LPC_GPDMA, i) == SUCCESS)
+			canales[i].callback(canales[i].contexto);
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Reserva un canal del GPDMA.
+     *
+     *  @details
+     *   La primera reserva inicializa el GPDMA e instala el handler de DMA_IRQn. El callback
+     *   se llama desde el handler al terminar cada transferencia del canal.
+     *
+	 *  @param 		conexion	Periferico asociado (GPDMA_CONN_...)
+	 *  @param 		callback	Funcion a llamar al terminar cada transferencia
+	 *  @param 		contexto	Parametro del callback
+	 *  @param 		canal		Donde devolver el numero de canal reservado
+	 *  @return     true si se reservo un canal, false si no hay canales libres.
+***************************************************************************************************/
+bool os_DMAReservarCanal(uint32_t conexion, void (*callback)(void*), void* contexto, uint8_t* canal)  {
+	uint8_t libre;
+	bool reservado = false;
+
+	os_enter_critical();
+
+	if (!dmaIniciado)  {
+		Chip_GPDMA_Init(LPC_GPDMA);
+		os_InstalarIRQ(DMA_IRQn,dma_ISR);
+		dmaIniciado = true;
+	}
+
+	/*
+	 * Chip_GPDMA_GetFreeChannel devuelve 0 tambien cuando no hay canales libres, por
+	 * lo que se verifica que el canal no este ya reservado
+	 */
+	libre = Chip_GPDMA_GetFreeChannel(LPC_GPDMA, conexion);
+	if (libre < OS_DMA_CANALES && canales[libre].callback == NULL)  {
+		canales[libre].callback = callback;
+		canales[libre].contexto = contexto;
+		*canal = libre;
+		reservado = true;
+	}
+
+	os_exit_critical();
+
+	return reservado;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Detiene y libera un canal del GPDMA.
+     *
+	 *  @param 		canal	Canal devuelto por os_DMAReservarCanal
+	 *  @return     None
+***************************************************************************************************/
+void os_DMALiberarCanal(uint8_t canal)  {
+	if (canal >= OS_DMA_CANALES)
+		return;
+
+	os_enter_critical();
+
+	Chip_GPDMA_Stop(LPC_GPDMA, canal);
+	canales[canal].callback = NULL;
+	canales[canal].contexto = NULL;
+
+	os_exit_critical();
+}
@@ -0,0 +1,84 @@
+/*
+ * MSE_OS_Dsp.c
+ *
+ *  Filtros con instrucciones SIMD del Cortex-M4, ver MSE_OS_Dsp.h
+ */
+
+
+#include <string.h>
+#include "MSE_OS_Dsp.h"
+
+
+/*
+ * Lee dos muestras consecutivas como una palabra de 32 bits. El Cortex-M4 admite
+ * lecturas de 32 bits no alineadas, y memcpy se compila como un solo LDR
+ */
+static inline uint32_t leerPar(const int16_t* p)  {
+	uint32_t par;
+
+	memcpy(&par, p, sizeof(par));
+	return par;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa un filtro FIR en Q15.
+     *
+	 *  @param 		fir					Filtro a inicializar
+	 *  @param 		coeficientes		Coeficientes en Q15, en orden inverso
+	 *  @param 		cant_coeficientes	Cantidad de coeficientes, par
+	 *  @param 		estado				Memoria para cant_coeficientes - 1 + tam_bloque muestras
+	 *  @param 		tam_bloque			Maxima cantidad de muestras por llamada a os_FirQ15
+	 *  @return     None
+***************************************************************************************************/
+void os_FirQ15Init(osFirQ15* fir, const int16_t* coeficientes, uint16_t cant_coeficientes,
+		int16_t* estado, uint16_t tam_bloque)  {
+	fir->coeficientes = coeficientes;
+	fir->cant_coeficientes = cant_coeficientes;
+	fir->estado = estado;
+	fir->tam_bloque = tam_bloque;
+
+	memset(estado, 0, (cant_coeficientes - 1 + tam_bloque) * sizeof(int16_t));
+}
+
+
+/*************************************************************************************************
+	 *  @brief Filtra un bloque de muestras.
+     *
+     *  @details
+     *   El bloque se copia a continuacion de las ultimas cant_coeficientes - 1 muestras del
+     *   bloque anterior, con lo que cada salida es el producto escalar de una ventana
+     *   contigua por los coeficientes, que se recorre de a pares con __SMLALD. Igual que
+     *   arm_fir_q15, el resultado se acumula en 64 bits (Q30), con lo que la suma no
+     *   desborda, y se satura a Q15 al final.
+     *
+	 *  @param 		fir			Filtro
+	 *  @param 		entrada		Muestras en Q15
+	 *  @param 		salida		Muestras filtradas en Q15 (puede ser el mismo buffer que entrada)
+	 *  @param 		cantidad	Cantidad de muestras, como maximo tam_bloque
+	 *  @return     None
+***************************************************************************************************/
+void os_FirQ15(osFirQ15* fir, const int16_t* entrada, int16_t* salida, uint16_t cantidad)  {
+	const int16_t* coeficientes = fir->coeficientes;
+	uint16_t historia = fir->cant_coeficientes - 1;
+	const int16_t* ventana;
+	int64_t acumulador;
+
+	if (cantidad > fir->tam_bloque)
+		cantidad = fir->tam_bloque;
+
+	memcpy(fir->estado + historia, entrada, cantidad * sizeof(int16_t));
+
+	for (uint16_t n = 0; n < cantidad; n++)  {
+		ventana = fir->estado + n;
+		acumulador = 0;
+
+		for (uint16_t k = 0; k < fir->cant_coeficientes; k += 2)
+			acumulador = (int64_t) __SMLALD(leerPar(ventana + k), leerPar(coeficientes + k),
+					(uint64_t) acumulador);
+
+		salida[n] = (int16_t) __SSAT((int32_t) (acumulador >> 15), 16);
+	}
+
+	memmove(fir->estado, fir->estado + cantidad, historia * sizeof(int16_t));
+}
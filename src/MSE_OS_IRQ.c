@@ -11,6 +11,22 @@
 
 static void* isr_vector_usuario[CANT_IRQ];				//vector de punteros a funciones para nuestras interrupciones
 
+#if OS_LATENCIA_IRQ
+/*
+ * Las mediciones ocupan una de OS_LATENCIA_CANT_IRQ posiciones, asignada por
+ * os_SetReferenciaIRQ. medicionIRQ guarda la posicion + 1 de cada IRQ (0 = sin medir)
+ */
+struct _medicionIRQ  {
+	osReferenciaIRQ referencia;
+	estadisticasIRQ estadisticas;
+};
+typedef struct _medicionIRQ medicionIRQ;
+
+static uint8_t posicionMedicion[CANT_IRQ];
+static medicionIRQ mediciones[OS_LATENCIA_CANT_IRQ];
+static uint8_t cantMediciones;
+#endif
+
 
 /********************************************************************************
  * Install interrupt. Debemos pasarle el tipo de interrupcion y la funcion del
@@ -56,6 +72,143 @@ bool os_RemoverIRQ(LPC43XX_IRQn_Type irq)  {
 
 
 
+#if OS_LATENCIA_IRQ
+/*************************************************************************************************
+	 *  @brief Reinicia las estadisticas de una medicion.
+     *
+	 *  @param est		Estadisticas a reiniciar
+	 *  @return     None
+***************************************************************************************************/
+static void reiniciarEstadisticas(estadisticasIRQ* est)  {
+	est->atenciones = 0;
+	est->latencia_min = UINT32_MAX;
+	est->latencia_max = 0;
+	est->latencia_suma = 0;
+	est->duracion_max = 0;
+
+	for (uint8_t i = 0; i < OS_CANT_HIST_LATENCIA; i++)
+		est->histograma[i] = 0;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Mide la latencia de una IRQ.
+     *
+     *  @details
+     *   A partir de la proxima atencion, os_IRQHandler llama a referencia justo antes de la
+     *   funcion del usuario para obtener los ciclos desde el evento, y mide la duracion de la
+     *   funcion del usuario. Con referencia en NULL solo se mide la duracion. Puede llamarse
+     *   de nuevo para cambiar la referencia, lo que reinicia las estadisticas.
+     *
+	 *  @param irq			Interrupcion a medir
+	 *  @param referencia	Funcion que devuelve los ciclos desde el evento, o NULL
+	 *  @return     false si ya se estan midiendo OS_LATENCIA_CANT_IRQ interrupciones.
+***************************************************************************************************/
+bool os_SetReferenciaIRQ(LPC43XX_IRQn_Type irq, osReferenciaIRQ referencia)  {
+	medicionIRQ* medicion;
+	bool ret = true;
+
+	os_enter_critical();
+
+	if (posicionMedicion[irq] == 0)  {
+		if (cantMediciones < OS_LATENCIA_CANT_IRQ)
+			posicionMedicion[irq] = ++cantMediciones;
+		else
+			ret = false;
+	}
+
+	if (ret)  {
+		medicion = &mediciones[posicionMedicion[irq] - 1];
+		medicion->referencia = referencia;
+		reiniciarEstadisticas(&medicion->estadisticas);
+	}
+
+	os_exit_critical();
+
+	return ret;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Copia las estadisticas de latencia de una IRQ.
+     *
+     *  @details
+     *   La copia se hace en una seccion critica para que sea consistente aunque la
+     *   interrupcion se atienda mientras tanto.
+     *
+	 *  @param irq			Interrupcion medida
+	 *  @param destino		Donde copiar las estadisticas
+	 *  @return     false si la IRQ no se esta midiendo.
+***************************************************************************************************/
+bool os_getEstadisticasIRQ(LPC43XX_IRQn_Type irq, estadisticasIRQ* destino)  {
+	if (posicionMedicion[irq] == 0)
+		return false;
+
+	os_enter_critical();
+	*destino = mediciones[posicionMedicion[irq] - 1].estadisticas;
+	os_exit_critical();
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Reinicia las estadisticas de latencia de una IRQ.
+     *
+	 *  @param irq			Interrupcion medida
+	 *  @return     None
+***************************************************************************************************/
+void os_ReiniciarEstadisticasIRQ(LPC43XX_IRQn_Type irq)  {
+	if (posicionMedicion[irq] == 0)
+		return;
+
+	os_enter_critical();
+	reiniciarEstadisticas(&mediciones[posicionMedicion[irq] - 1].estadisticas);
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Agrega una atencion a las estadisticas.
+     *
+     *  @details
+     *   La posicion del histograma es la cantidad de bits significativos de la latencia, con
+     *   lo que se calcula con una sola instruccion CLZ.
+     *
+	 *  @param medicion		Medicion de la IRQ
+	 *  @param latencia		Ciclos desde el evento hasta la funcion del usuario
+	 *  @param duracion		Ciclos de la funcion del usuario
+	 *  @return     None
+***************************************************************************************************/
+static void registrarAtencion(medicionIRQ* medicion, uint32_t latencia, uint32_t duracion)  {
+	estadisticasIRQ* est = &medicion->estadisticas;
+	uint32_t pos;
+
+	est->atenciones++;
+
+	if (duracion > est->duracion_max)
+		est->duracion_max = duracion;
+
+	if (medicion->referencia == NULL)
+		return;
+
+	pos = (latencia == 0) ? 0 : 32 - __builtin_clz(latencia);
+	if (pos >= OS_CANT_HIST_LATENCIA)
+		pos = OS_CANT_HIST_LATENCIA - 1;
+
+	est->histograma[pos]++;
+	est->latencia_suma += latencia;
+
+	if (latencia < est->latencia_min)
+		est->latencia_min = latencia;
+
+	if (latencia > est->latencia_max)
+		est->latencia_max = latencia;
+}
+#endif
+
+
+
 /********************************************************************************
  * Esta funcion es la que todas las interrupciones llaman. Se encarga de llamar
  * a la funcion de usuario que haya sido cargada. LAS FUNCIONES DE USUARIO
@@ -65,6 +218,11 @@ bool os_RemoverIRQ(LPC43XX_IRQn_Type irq)  {
 static void os_IRQHandler(LPC43XX_IRQn_Type IRQn)  {
 	estadoOS estadoPrevio_OS;
 	void (*funcion_usuario)(void);
+#if OS_LATENCIA_IRQ
+	medicionIRQ* medicion = NULL;
+	uint32_t latencia = 0;
+	uint32_t inicio = 0;
+#endif
 
 	/*
 	 * Guardamos el estado del sistema para restablecerlo al salir de
@@ -83,8 +241,27 @@ static void os_IRQHandler(LPC43XX_IRQn_Type IRQn)  {
 	 * Llamamos a la funcion definida por el usuario
 	 */
 	funcion_usuario = isr_vector_usuario[IRQn];
+
+#if OS_LATENCIA_IRQ
+	/*
+	 * La latencia se lee lo mas cerca posible de la funcion del usuario, para que incluya
+	 * todo el camino del OS desde el evento
+	 */
+	if (posicionMedicion[IRQn] != 0)  {
+		medicion = &mediciones[posicionMedicion[IRQn] - 1];
+		if (medicion->referencia != NULL)
+			latencia = medicion->referencia();
+		inicio = OS_CICLOS();
+	}
+#endif
+
 	funcion_usuario();
 
+#if OS_LATENCIA_IRQ
+	if (medicion != NULL)
+		registrarAtencion(medicion, latencia, OS_CICLOS() - inicio);
+#endif
+
 	/*
 	 * Retomamos el estado anterior de sistema operativo
 	 */
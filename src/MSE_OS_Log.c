@@ -0,0 +1,226 @@
+/*
+ * MSE_OS_Log.c
+ *
+ *  Log binario diferido, ver MSE_OS_Log.h
+ */
+
+
+#include "MSE_OS_Log.h"
+#include "MSE_OS_API.h"
+
+#if !OS_LOG_CRUDO
+#include <stdio.h>
+#endif
+
+
+#define MASCARA_LOG			(OS_LOG_PALABRAS - 1)
+#define MAX_PALABRAS_REG	(OS_LOG_PALABRAS_CABECERA + OS_LOG_MAX_ARGS)
+
+
+/*
+ * Los indices avanzan sin limite y se enmascaran al acceder al buffer. Las palabras
+ * libres valen 0, por lo que una cabecera en 0 indica un registro reservado que todavia
+ * no se termino de escribir
+ */
+static uint32_t bufferLog[OS_LOG_PALABRAS];
+static uint32_t indice_reserva;				//proxima palabra a reservar (productores)
+static uint32_t indice_lectura;				//proxima palabra a vaciar (solo os_LogVaciar)
+static uint32_t perdidos;					//pendientes de informar
+static uint32_t perdidos_total;
+static osLogSalida salidaLog;
+
+#if !OS_LOG_CRUDO
+static const char* const formatos[OS_LOG_CANT_MENSAJES] = {
+	OS_LOG_FORMATO_PERDIDOS,
+#define OS_LOG_MENSAJE(nombre, formato)		formato,
+#include "mensajes_log.def"
+};
+#endif
+
+
+
+/*************************************************************************************************
+	 *  @brief Configura la salida del log.
+     *
+	 *  @param 		salida		Funcion que recibe las lineas (o los registros con OS_LOG_CRUDO)
+	 *  @return     None
+***************************************************************************************************/
+void os_LogInit(osLogSalida salida)  {
+	salidaLog = salida;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Registra un mensaje en el log.
+     *
+     *  @details
+     *   Se llama a traves de os_Log0 ... os_Log4, desde tareas o handlers. Reserva el lugar
+     *   del registro avanzando indice_reserva con un compare and swap, que en Cortex-M4 se
+     *   traduce a LDREX/STREX: si otro registro (por ejemplo el de un handler) reservo en
+     *   el medio, se reintenta. Luego escribe el tick y los argumentos y por ultimo la
+     *   cabecera, que publica el registro. Si no hay lugar el registro se descarta y se
+     *   cuenta, sin bloquear.
+     *
+	 *  @param 		cabecera	Cabecera armada con OS_LOG_CABECERA
+	 *  @param 		arg0		Argumentos, se usan los primeros OS_LOG_CANT_ARGS(cabecera)
+	 *  @return     None
+***************************************************************************************************/
+void os_LogRegistrar(uint32_t cabecera, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3)  {
+	uint32_t argumentos[OS_LOG_MAX_ARGS] = { arg0, arg1, arg2, arg3 };
+	uint32_t cant = OS_LOG_CANT_ARGS(cabecera);
+	uint32_t palabras = OS_LOG_PALABRAS_CABECERA + cant;
+	uint32_t reserva;
+
+	reserva = __atomic_load_n(&indice_reserva, __ATOMIC_RELAXED);
+
+	do  {
+		if (reserva + palabras - __atomic_load_n(&indice_lectura, __ATOMIC_ACQUIRE) > OS_LOG_PALABRAS)  {
+			__atomic_fetch_add(&perdidos, 1, __ATOMIC_RELAXED);
+			return;
+		}
+	} while (!__atomic_compare_exchange_n(&indice_reserva, &reserva, reserva + palabras, true,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+	bufferLog[(reserva + 1) & MASCARA_LOG] = os_getTicks();
+
+	for (uint32_t i = 0; i < cant; i++)
+		bufferLog[(reserva + OS_LOG_PALABRAS_CABECERA + i) & MASCARA_LOG] = argumentos[i];
+
+	__atomic_store_n(&bufferLog[reserva & MASCARA_LOG], cabecera, __ATOMIC_RELEASE);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Entrega un registro a la salida.
+     *
+     *  @details
+     *   Con OS_LOG_CRUDO entrega las palabras del registro tal como estan. Si no, arma la
+     *   linea "tick: mensaje" con el formato del id. Los ids desconocidos (un firmware con
+     *   otra mensajes_log.def) se imprimen con sus argumentos en hexadecimal. La linea es
+     *   estatica para no sumarla al stack de snprintf: solo la usa la tarea que vacia el log.
+     *
+	 *  @param 		registro	Cabecera, tick y argumentos
+	 *  @return     None
+***************************************************************************************************/
+static void emitir(const uint32_t* registro)  {
+	uint32_t cant = OS_LOG_CANT_ARGS(registro[0]);
+#if OS_LOG_CRUDO
+	salidaLog(registro, (OS_LOG_PALABRAS_CABECERA + cant) * sizeof(uint32_t));
+#else
+	static char linea[OS_LOG_TAM_LINEA];
+	uint32_t a[OS_LOG_MAX_ARGS] = { 0 };
+	uint32_t id = OS_LOG_ID(registro[0]);
+	int n;
+
+	for (uint32_t i = 0; i < cant; i++)
+		a[i] = registro[OS_LOG_PALABRAS_CABECERA + i];
+
+	n = snprintf(linea, sizeof(linea), "%lu: ", (unsigned long) registro[1]);
+
+	if (id < OS_LOG_CANT_MENSAJES)
+		n += snprintf(linea + n, sizeof(linea) - n, formatos[id], a[0], a[1], a[2], a[3]);
+	else  {
+		n += snprintf(linea + n, sizeof(linea) - n, "mensaje %lu", (unsigned long) id);
+		for (uint32_t i = 0; i < cant && n < (int) sizeof(linea); i++)
+			n += snprintf(linea + n, sizeof(linea) - n, " 0x%08lx", (unsigned long) a[i]);
+	}
+
+	if (n > (int) sizeof(linea) - 3)
+		n = sizeof(linea) - 3;
+
+	linea[n++] = '\n';
+	linea[n++] = '\r';
+	salidaLog(linea, n);
+#endif
+}
+
+
+/*************************************************************************************************
+	 *  @brief Vacia el log.
+     *
+     *  @details
+     *   Entrega a la salida los registros publicados, en el orden en que se reservaron, y
+     *   se detiene en el primero que todavia se esta escribiendo. Cada registro se copia y
+     *   sus palabras se ponen en 0 antes de liberarlas, de modo que la salida puede
+     *   bloquearse sin demorar a quienes registran. Por ultimo informa los registros
+     *   descartados desde el vaciado anterior con un registro LOG_PERDIDOS. Debe llamarse
+     *   siempre desde la misma tarea, que es la unica que usa la copia estatica del registro.
+     *
+	 *  @param 		None
+	 *  @return     Cantidad de registros entregados.
+***************************************************************************************************/
+uint16_t os_LogVaciar(void)  {
+	static uint32_t registro[MAX_PALABRAS_REG];
+	uint32_t lectura = indice_lectura;
+	uint32_t palabras;
+	uint32_t descartados;
+	uint16_t entregados = 0;
+
+	if (salidaLog == NULL)
+		return 0;
+
+	while (1)  {
+		registro[0] = __atomic_load_n(&bufferLog[lectura & MASCARA_LOG], __ATOMIC_ACQUIRE);
+
+		if (!(registro[0] & OS_LOG_VALIDO))
+			break;
+
+		palabras = OS_LOG_PALABRAS_CABECERA + OS_LOG_CANT_ARGS(registro[0]);
+
+		for (uint32_t i = 0; i < palabras; i++)  {
+			registro[i] = bufferLog[(lectura + i) & MASCARA_LOG];
+			bufferLog[(lectura + i) & MASCARA_LOG] = 0;
+		}
+
+		lectura += palabras;
+		__atomic_store_n(&indice_lectura, lectura, __ATOMIC_RELEASE);
+
+		emitir(registro);
+		entregados++;
+	}
+
+	descartados = __atomic_exchange_n(&perdidos, 0, __ATOMIC_RELAXED);
+
+	if (descartados > 0)  {
+		perdidos_total += descartados;
+		registro[0] = OS_LOG_CABECERA(LOG_PERDIDOS, 1);
+		registro[1] = os_getTicks();
+		registro[2] = descartados;
+		emitir(registro);
+		entregados++;
+	}
+
+	return entregados;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de registros descartados por buffer lleno.
+     *
+	 *  @param 		None
+	 *  @return     Registros descartados desde el arranque (informados o no).
+***************************************************************************************************/
+uint32_t os_LogPerdidos(void)  {
+	return perdidos_total + __atomic_load_n(&perdidos, __ATOMIC_RELAXED);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Tarea que vacia el log.
+     *
+     *  @details
+     *   Entry point para una tarea de la menor prioridad. La tarea idle no puede usar la
+     *   API del OS (ni bloquearse en la salida), por lo que el formato y la salida se hacen
+     *   en esta tarea, que solo corre cuando no hay otra lista. Vacia el log cada
+     *   OS_LOG_PERIODO_VACIADO ticks. Sin OS_LOG_CRUDO la tarea necesita el stack de
+     *   snprintf, ver OS_LOG_STACK_MINIMO.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+void os_LogTarea(void)  {
+	while (1)  {
+		os_LogVaciar();
+		os_Delay(OS_LOG_PERIODO_VACIADO);
+	}
+}
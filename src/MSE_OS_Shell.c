@@ -0,0 +1,298 @@
+/*
+ * MSE_OS_Shell.c
+ *
+ *  Shell de diagnostico por UART, ver MSE_OS_Shell.h
+ */
+
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "MSE_OS_Shell.h"
+#include "MSE_OS_Tabla.h"
+
+
+#if OS_ESTADISTICAS
+
+
+struct _comandoShell  {
+	const char* nombre;
+	void (*funcion)(void);
+	const char* ayuda;
+};
+
+typedef struct _comandoShell comandoShell;
+
+
+static osUartRx* entrada;
+static osUartTx* salida;
+static char linea[OS_SHELL_TAM_LINEA];
+
+static const char* const nombresEstado[] = {
+	[TAREA_READY] = "lista",
+	[TAREA_RUNNING] = "corriendo",
+	[TAREA_BLOCKED] = "bloqueada",
+	[TAREA_SUSPENDED] = "suspendida",
+	[TAREA_DELETED] = "eliminada",
+	[TAREA_AGOTADA] = "agotada"
+};
+
+
+static void comandoTareas(void);
+static void comandoObjetos(void);
+static void comandoReset(void);
+static void comandoAyuda(void);
+
+static const comandoShell comandos[] = {
+	{ "tareas",		comandoTareas,	"estado, prioridad, CPU, stack libre y cambios de contexto" },
+	{ "objetos",	comandoObjetos,	"semaforos, colas y stream buffers de tareas.def" },
+	{ "reset",		comandoReset,	"reinicia las estadisticas de las tareas" },
+	{ "ayuda",		comandoAyuda,	"lista los comandos" }
+};
+
+#define CANT_COMANDOS	(sizeof(comandos) / sizeof(comandos[0]))
+
+
+
+/*************************************************************************************************
+	 *  @brief Escribe una linea de respuesta.
+     *
+     *  @details
+     *   Arma la linea en un buffer fijo de OS_SHELL_TAM_SALIDA bytes (las lineas mas largas
+     *   se truncan) y la entrega al driver de transmision, que puede bloquear al shell si su
+     *   buffer esta lleno. El buffer es estatico para no sumarlo al stack de vsnprintf; solo
+     *   lo usa la tarea del shell.
+     *
+	 *  @param 		formato		Formato printf de la linea, sin el fin de linea
+	 *  @return     None
+***************************************************************************************************/
+static void responder(const char* formato, ...)  {
+	static char texto[OS_SHELL_TAM_SALIDA];
+	va_list argumentos;
+	int n;
+
+	va_start(argumentos, formato);
+	n = vsnprintf(texto, sizeof(texto) - 2, formato, argumentos);
+	va_end(argumentos);
+
+	if (n < 0)
+		return;
+
+	if (n > (int) sizeof(texto) - 3)
+		n = sizeof(texto) - 3;
+
+	texto[n++] = '\n';
+	texto[n++] = '\r';
+	os_UartTxWrite(salida, texto, n);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Devuelve el nombre de una tarea segun tareas.def.
+     *
+	 *  @param 		task	Tarea
+	 *  @return     Nombre de la tarea, o NULL si no esta en la tabla.
+***************************************************************************************************/
+static const char* nombreTarea(tarea* task)  {
+	if (task == os_getTareaIdle())
+		return "idle";
+
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	\
+	if (task == &g_s##nombre)													\
+		return #nombre;
+#include "tareas.def"
+
+	return NULL;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Muestra una tarea.
+     *
+     *  @details
+     *   El porcentaje de CPU se calcula en decimas sobre los ticks desde el ultimo reinicio,
+     *   con aritmetica entera.
+     *
+	 *  @param 		task		Tarea
+	 *  @param 		total		Ticks desde el ultimo reinicio de estadisticas
+	 *  @return     None
+***************************************************************************************************/
+static void mostrarTarea(tarea* task, uint32_t total)  {
+	const char* nombre = nombreTarea(task);
+	uint32_t decimas = total ? (uint32_t) (((uint64_t) task->ticks_cpu * 1000) / total) : 0;
+	static char id[8];
+
+	if (nombre == NULL)  {
+		snprintf(id, sizeof(id), "#%u", (unsigned) task->id);
+		nombre = id;
+	}
+
+	responder("%-12s %-10s %4u %3lu.%lu %6lu %8lu", nombre, nombresEstado[task->estado],
+			(unsigned) task->prioridad, (unsigned long) (decimas / 10), (unsigned long) (decimas % 10),
+			(unsigned long) os_getStackLibre(task), (unsigned long) task->cambios_contexto);
+}
+
+
+static void comandoTareas(void)  {
+	uint32_t total = os_getTicksEstadisticas();
+	uint16_t cantidad = os_getCantidadTareas();
+	tarea* task;
+
+	responder("%-12s %-10s %4s %5s %6s %8s", "tarea", "estado", "prio", "%cpu", "stack", "cambios");
+
+	for (uint16_t i = 0; i < cantidad; i++)  {
+		task = os_getTarea(i);
+		if (task != NULL)
+			mostrarTarea(task, total);
+	}
+
+	mostrarTarea(os_getTareaIdle(), total);
+	responder("%lu ticks", (unsigned long) total);
+}
+
+
+/*
+ * Una tabla puede no declarar objetos de algun tipo, por lo que las funciones que muestran
+ * cada tipo pueden quedar sin uso
+ */
+static void __attribute__((unused)) mostrarSemaforo(const char* nombre, osSemaforo* sem)  {
+	tarea* espera = sem->tarea_asociada;
+
+	if (espera != NULL)
+		responder("sem    %-16s %-7s espera %s", nombre, sem->tomado ? "tomado" : "libre",
+				nombreTarea(espera) ? nombreTarea(espera) : "?");
+	else
+		responder("sem    %-16s %s", nombre, sem->tomado ? "tomado" : "libre");
+}
+
+
+static void __attribute__((unused)) mostrarCola(const char* nombre, osCola* cola)  {
+	uint16_t total = QUEUE_HEAP_SIZE / cola->size_elemento;
+	uint16_t elementos = (cola->indice_head + total - cola->indice_tail) % total;
+
+	responder("cola   %-16s %u/%u", nombre, (unsigned) elementos, (unsigned) (total - 1));
+}
+
+
+static void __attribute__((unused)) mostrarStream(const char* nombre, osStreamBuffer* sb)  {
+	responder("stream %-16s %u/%u", nombre, (unsigned) sb->cantidad, (unsigned) sb->tamanio);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Muestra los objetos de tareas.def.
+     *
+     *  @details
+     *   Los semaforos se muestran tomados o libres y con la tarea que los espera, las colas
+     *   con sus elementos sobre su capacidad y los stream buffers con sus bytes sobre su
+     *   tamaño. Los valores se leen sin seccion critica, son solo informativos.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+static void comandoObjetos(void)  {
+#define OS_SEMAFORO(nombre)									mostrarSemaforo(#nombre, &sem##nombre);
+#define OS_COLA(nombre, tam_elemento)						mostrarCola(#nombre, &cola##nombre);
+#define OS_STREAM_BUFFER(nombre, tamanio, nivel_disparo)	mostrarStream(#nombre, &stream##nombre);
+#include "tareas.def"
+}
+
+
+static void comandoReset(void)  {
+	os_ReiniciarEstadisticas();
+	responder("estadisticas reiniciadas");
+}
+
+
+static void comandoAyuda(void)  {
+	for (uint16_t i = 0; i < CANT_COMANDOS; i++)
+		responder("%-8s %s", comandos[i].nombre, comandos[i].ayuda);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Ejecuta un comando.
+     *
+	 *  @param 		comando		Linea recibida, sin el fin de linea
+	 *  @return     None
+***************************************************************************************************/
+static void ejecutar(const char* comando)  {
+	if (comando[0] == '\0')
+		return;
+
+	for (uint16_t i = 0; i < CANT_COMANDOS; i++)  {
+		if (strcmp(comando, comandos[i].nombre) == 0)  {
+			comandos[i].funcion();
+			return;
+		}
+	}
+
+	responder("comando desconocido: %s (ayuda)", comando);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Configura los drivers del shell.
+     *
+     *  @details
+     *   Configura el delimitador del receptor en '\n' para que la tarea del shell despierte
+     *   una vez por comando. Debe llamarse antes de os_Init.
+     *
+	 *  @param 		rx		Driver de recepcion ya inicializado
+	 *  @param 		tx		Driver de transmision ya inicializado
+	 *  @return     None
+***************************************************************************************************/
+void os_ShellInit(osUartRx* rx, osUartTx* tx)  {
+	entrada = rx;
+	salida = tx;
+	os_UartRxSetDelimitador(rx, '\n');
+}
+
+
+/*************************************************************************************************
+	 *  @brief Tarea del shell.
+     *
+     *  @details
+     *   Entry point para una tarea de la menor prioridad. Lee directamente sobre el buffer
+     *   de linea y ejecuta cada linea completa, terminada en '\n' o '\r'. Una linea mas larga
+     *   que OS_SHELL_TAM_LINEA se descarta completa.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+void os_ShellTarea(void)  {
+	uint16_t largo = 0;
+	uint16_t inicio;
+	bool descartando = false;
+
+	while (1)  {
+		largo += os_UartRxRead(entrada, linea + largo, OS_SHELL_TAM_LINEA - largo);
+		inicio = 0;
+
+		for (uint16_t i = 0; i < largo; i++)  {
+			if (linea[i] != '\n' && linea[i] != '\r')
+				continue;
+
+			linea[i] = '\0';
+			if (!descartando)
+				ejecutar(linea + inicio);
+
+			descartando = false;
+			inicio = i + 1;
+		}
+
+		/*
+		 * Lo que queda es el principio de la proxima linea. Si ocupa todo el buffer la linea
+		 * es demasiado larga y se descarta hasta su fin
+		 */
+		largo -= inicio;
+		memmove(linea, linea + inicio, largo);
+
+		if (largo == OS_SHELL_TAM_LINEA)  {
+			responder("linea demasiado larga");
+			descartando = true;
+			largo = 0;
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,142 @@
+/*
+ * MSE_OS_Tabla.c
+ *
+ *  Definicion en tiempo de compilacion de las tareas, semaforos, colas y stream buffers
+ *  declarados en tareas.def, y verificacion en el arranque de que la tabla compilada es la misma que
+ *  se analizo con tools/rta.
+ *
+ *  Las tareas se definen con el stack frame inicial ya armado y la lista ordenada por
+ *  prioridad la genera tools/rta en tareas_rta.h, por lo que en el arranque solo se
+ *  copia la tabla con os_CargarTablaEstatica. Los errores de configuracion que pueden
+ *  detectarse al compilar (prioridades, cantidad de tareas, tamaño de elementos de
+ *  colas, tabla sin regenerar) detienen la compilacion.
+ */
+
+#include "MSE_OS_Core.h"
+#include "MSE_OS_API.h"
+#include "MSE_OS_Tabla.h"
+#include "tareas_rta.h"
+
+
+/*==================[verificaciones en tiempo de compilacion]=================================*/
+
+_Static_assert(sizeof(void*) == sizeof(uint32_t),
+		"los stack frames de OS_TAREA_INICIALIZADOR guardan direcciones de 32 bits");
+
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)				\
+	_Static_assert((prioridad) >= MAX_PRIORITY && (prioridad) <= MIN_PRIORITY,				\
+			"tarea " #nombre ": prioridad fuera de rango");
+#define OS_COLA(nombre, tam_elemento)														\
+	_Static_assert((tam_elemento) > 0 && (tam_elemento) <= QUEUE_HEAP_SIZE,					\
+			"cola " #nombre ": tamaño de elemento invalido");
+#define OS_STREAM_BUFFER(nombre, tamanio, nivel_disparo)									\
+	_Static_assert((tamanio) > 0 && (tamanio) <= UINT16_MAX,								\
+			"stream buffer " #nombre ": tamaño invalido");									\
+	_Static_assert((nivel_disparo) > 0 && (nivel_disparo) <= (tamanio),						\
+			"stream buffer " #nombre ": nivel de disparo fuera de rango");
+#include "tareas.def"
+
+/*
+ * Los ids de las tareas son su posicion en la tabla
+ */
+enum _idTablaTareas  {
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	OS_ID_##nombre,
+#include "tareas.def"
+	CANT_TAREAS_TABLA
+};
+
+_Static_assert(CANT_TAREAS_TABLA <= MAX_TASK_COUNT, "tareas.def tiene mas de MAX_TASK_COUNT tareas");
+_Static_assert(CANT_TAREAS_TABLA == OS_TABLA_CANT_TAREAS, "tareas_rta.h no corresponde a tareas.def, correr tools/rta");
+_Static_assert(OS_TABLA_PRIORIDAD_MAX <= MIN_PRIORITY, "tareas_rta.h no corresponde a tareas.def, correr tools/rta");
+
+#if !OS_TABLA_PLANIFICABLE
+#warning "El analisis de tiempo de respuesta de tareas.def indica que no es planificable"
+#endif
+
+//----------------------------------------------------------------------------------
+
+
+
+/*==================[definicion de tareas y objetos de la tabla]=================================*/
+
+/*
+ * OS_TAREA_INICIALIZADOR pinta todo el stack y luego sobreescribe el centinela y el
+ * stack frame inicial, lo que es intencional
+ */
+#pragma GCC diagnostic ignored "-Woverride-init"
+
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	\
+	void entry(void);															\
+	tarea g_s##nombre = OS_TAREA_INICIALIZADOR(g_s##nombre, entry, OS_ID_##nombre, prioridad);
+#define OS_SEMAFORO(nombre)		osSemaforo sem##nombre = OS_SEMAFORO_INICIALIZADOR;
+#define OS_COLA(nombre, tam_elemento)	osCola cola##nombre = OS_COLA_INICIALIZADOR(tam_elemento);
+#define OS_STREAM_BUFFER(nombre, tamanio, nivel_disparo)							\
+	static uint8_t memoriaStream##nombre[tamanio];									\
+	osStreamBuffer stream##nombre =													\
+		OS_STREAM_BUFFER_INICIALIZADOR(memoriaStream##nombre, tamanio, nivel_disparo);
+#include "tareas.def"
+
+
+static tarea * const listaOrdenada[] = OS_TABLA_LISTA;
+
+static const osTablaEstatica tablaArranque = {
+	.listaTareas = listaOrdenada,
+	.cantidad_Tareas = CANT_TAREAS_TABLA,
+	.cantTareas_prioridad = OS_TABLA_CANT_PRIORIDAD,
+	.inicioPrioridad = OS_TABLA_INICIO_PRIORIDAD,
+	.prioridadesListas = OS_TABLA_PRIORIDADES
+};
+
+
+struct _entradaTabla  {
+	uint8_t prioridad;
+	uint32_t periodo_us;
+	uint32_t wcet_us;
+	uint32_t deadline_us;
+};
+typedef struct _entradaTabla entradaTabla;
+
+static const entradaTabla tablaTareas[] = {
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	\
+	{ prioridad, periodo_us, wcet_us, deadline_us },
+#include "tareas.def"
+};
+
+//----------------------------------------------------------------------------------
+
+
+
+/*************************************************************************************************
+	 *  @brief Carga las tareas de la tabla estatica.
+     *
+     *  @details
+     *   Verifica que el hash de la tabla compilada coincida con OS_TABLA_HASH, generado por
+     *   tools/rta junto con la lista ordenada. Si no coincide la tabla fue modificada (o se
+     *   compilo con otro OS_US_POR_TICK) sin volver a analizarla, y se produce el error
+     *   ERR_OS_TABLA antes de cargar datos que pueden estar desactualizados. Si coincide se
+     *   copia el estado inicial del scheduler. Reemplaza las llamadas a os_InitTarea antes de
+     *   os_Init.
+     *
+	 *  @param 		None
+	 *  @return     None.
+***************************************************************************************************/
+void os_InitTablaTareas(void)  {
+	uint32_t hash = OS_TABLA_HASH_INICIAL;
+
+	hash = os_TablaHash(hash, OS_US_POR_TICK);
+	hash = os_TablaHash(hash, CANT_TAREAS_TABLA);
+
+	for (uint16_t i = 0; i < CANT_TAREAS_TABLA; i++)  {
+		hash = os_TablaHash(hash, tablaTareas[i].prioridad);
+		hash = os_TablaHash(hash, tablaTareas[i].periodo_us);
+		hash = os_TablaHash(hash, tablaTareas[i].wcet_us);
+		hash = os_TablaHash(hash, tablaTareas[i].deadline_us);
+	}
+
+	if (hash != OS_TABLA_HASH)  {
+		os_setError(ERR_OS_TABLA,os_InitTablaTareas);
+		return;
+	}
+
+	os_CargarTablaEstatica(&tablaArranque);
+}
@@ -0,0 +1,324 @@
+/*
+ * MSE_OS_Uart.c
+ *
+ *  Drivers de transmision y recepcion por UART, ver MSE_OS_Uart.h
+ */
+
+
+#include "MSE_OS_Uart.h"
+
+
+#define UART_LSR_ERRORES		(UART_LSR_OE | UART_LSR_PE | UART_LSR_FE | UART_LSR_BI)
+
+
+static osUartRx* receptores[OS_UART_RX_CANT];		//drivers de recepcion atendidos por uartRx_ISR
+
+
+/*************************************************************************************************
+	 *  @brief Lanza una transferencia con el bloque pendiente del buffer.
+     *
+     *  @details
+     *   Si el DMA esta detenido y hay datos, transmite el bloque contiguo desde el indice de
+     *   lectura del stream. Los datos no se liberan hasta que termina la transferencia, con
+     *   lo que las escrituras siguientes no pueden pisarlos. Se llama desde las tareas que
+     *   escriben y desde el fin de cada transferencia, por lo que siempre que el buffer
+     *   tiene datos hay una transferencia en curso.
+     *
+	 *  @param 		tx		Driver de transmision
+	 *  @return     None
+***************************************************************************************************/
+static void iniciarTransferencia(osUartTx* tx)  {
+	uint8_t* bloque;
+	uint16_t cantidad;
+
+	os_enter_critical();
+
+	if (tx->bytes_en_curso == 0 && os_StreamBufferDisponible(&tx->stream) > 0)  {
+		cantidad = os_StreamBufferLeerBloque(&tx->stream, &bloque);
+		if (cantidad > OS_UART_DMA_MAX)
+			cantidad = OS_UART_DMA_MAX;
+
+		tx->bytes_en_curso = cantidad;
+		tx->transferencias++;
+
+		Chip_GPDMA_Transfer(LPC_GPDMA, tx->canal_dma, (uintptr_t) bloque, tx->conexion_dma,
+				GPDMA_TRANSFERTYPE_M2P_CONTROLLER_DMA, cantidad);
+	}
+
+	os_exit_critical();
+}
+
+
+/*************************************************************************************************
+	 *  @brief Fin de una transferencia, llamado desde el handler de DMA_IRQn.
+     *
+     *  @details
+     *   Libera los bytes transmitidos, lo que despierta a la tarea que espera lugar en el
+     *   buffer, y lanza la transferencia siguiente.
+     *
+	 *  @param 		contexto	Driver de transmision
+	 *  @return     None
+***************************************************************************************************/
+static void finTransferencia(void* contexto)  {
+	osUartTx* tx = contexto;
+
+	os_StreamBufferLiberar(&tx->stream, tx->bytes_en_curso);
+	tx->bytes_enviados += tx->bytes_en_curso;
+	tx->bytes_en_curso = 0;
+
+	iniciarTransferencia(tx);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa el driver de transmision de una UART.
+     *
+     *  @details
+     *   La UART debe estar configurada (baudrate, formato) antes de llamar a esta funcion.
+     *   Habilita el pedido de DMA de la FIFO de transmision y reserva un canal del GPDMA.
+     *
+	 *  @param 		tx				Driver a inicializar
+	 *  @param 		uart			UART a utilizar (LPC_USARTn)
+	 *  @param 		conexion_dma	Conexion del GPDMA de la UART (GPDMA_CONN_UARTn_Tx)
+	 *  @param 		memoria			Memoria para el buffer de transmision
+	 *  @param 		tamanio			Tamaño del buffer en bytes
+	 *  @return     true si se pudo reservar un canal del GPDMA.
+***************************************************************************************************/
+bool os_UartTxInit(osUartTx* tx, LPC_USART_T* uart, uint32_t conexion_dma, uint8_t* memoria, uint16_t tamanio)  {
+	os_StreamBufferInit(&tx->stream, memoria, tamanio, 1);
+	tx->uart = uart;
+	tx->conexion_dma = conexion_dma;
+	tx->bytes_en_curso = 0;
+	tx->bytes_enviados = 0;
+	tx->transferencias = 0;
+
+	Chip_UART_SetupFIFOS(uart, OS_UART_FCR);
+
+	return os_DMAReservarCanal(conexion_dma, finTransferencia, tx, &tx->canal_dma);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Escribe datos para transmitir por la UART.
+     *
+     *  @details
+     *   Copia los datos al buffer del driver y vuelve sin esperar la transmision. Se escribe
+     *   de a partes, lo que entra en cada momento, lanzando el DMA despues de cada una, con
+     *   lo que la tarea solo se bloquea si el buffer esta lleno. Desde un handler se escribe
+     *   lo que entra en el buffer.
+     *
+	 *  @param 		tx			Driver de transmision
+	 *  @param 		datos		Datos a transmitir
+	 *  @param 		cantidad	Cantidad de bytes
+	 *  @return     Bytes escritos en el buffer.
+	 *  @warning	Igual que en el stream buffer, solo una tarea puede estar bloqueada
+	 *  			esperando lugar a la vez
+***************************************************************************************************/
+uint16_t os_UartTxWrite(osUartTx* tx, const void* datos, uint16_t cantidad)  {
+	const uint8_t* origen = datos;
+	uint16_t escritos = 0;
+	uint16_t parte, libre, n;
+
+	while (escritos < cantidad)  {
+		os_enter_critical();
+		libre = tx->stream.tamanio - os_StreamBufferDisponible(&tx->stream);
+		parte = (libre > 0) ? libre : tx->bytes_en_curso;
+		os_exit_critical();
+
+		/*
+		 * Se escribe solo lo que entra, para no esperar lugar para toda la parte mientras
+		 * el buffer tiene lugar libre. Con el buffer lleno la parte es la transferencia en
+		 * curso, que es la que libera lugar: la tarea se bloquea hasta que termine
+		 */
+		if (parte == 0 || parte > cantidad - escritos)
+			parte = cantidad - escritos;
+
+		n = os_StreamBufferWrite(&tx->stream, origen + escritos, parte);
+		escritos += n;
+		iniciarTransferencia(tx);
+
+		if (n < parte)
+			break;		//escritura desde un handler con el buffer lleno
+	}
+
+	return escritos;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Cantidad de bytes en el buffer que todavia no terminaron de transmitirse.
+     *
+	 *  @param 		tx		Driver de transmision
+	 *  @return     Bytes pendientes, incluyendo los de la transferencia en curso.
+***************************************************************************************************/
+uint16_t os_UartTxPendientes(osUartTx* tx)  {
+	return os_StreamBufferDisponible(&tx->stream);
+}
+
+
+
+/*************************************************************************************************
+	 *  @brief Vacia la FIFO de recepcion de una UART en el buffer del driver.
+     *
+     *  @details
+     *   Los bytes se leen directamente en el bloque libre del stream, sin buffer intermedio,
+     *   y se publican con una sola confirmacion por bloque, con lo que la tarea lectora se
+     *   evalua una vez por interrupcion. Si el buffer esta lleno los bytes se descartan y se
+     *   cuentan como perdidos. Si llego el delimitador o la linea quedo inactiva se fuerza la
+     *   lectura, aunque no se haya alcanzado el umbral.
+     *
+	 *  @param 		rx			Driver de recepcion
+	 *  @param 		inactiva	La interrupcion fue por timeout de caracter
+	 *  @return     None
+***************************************************************************************************/
+static void recibir(osUartRx* rx, bool inactiva)  {
+	uint8_t* bloque = NULL;
+	uint16_t libre = 0;
+	uint16_t cantidad = 0;
+	uint32_t lsr;
+	uint8_t dato;
+	bool fin_mensaje = inactiva;
+
+	while ((lsr = Chip_UART_ReadLineStatus(rx->uart)) & UART_LSR_RDR)  {
+		if (lsr & UART_LSR_ERRORES)
+			rx->errores_linea++;
+
+		/*
+		 * Bloque lleno: se publica y se pide el siguiente, que es el principio del buffer
+		 * si el anterior llegaba al final
+		 */
+		if (cantidad == libre)  {
+			if (cantidad > 0)
+				os_StreamBufferConfirmar(&rx->stream, cantidad);
+
+			libre = os_StreamBufferReservarBloque(&rx->stream, &bloque);
+			cantidad = 0;
+		}
+
+		dato = Chip_UART_ReadByte(rx->uart);
+
+		if (libre == 0)  {
+			rx->bytes_perdidos++;
+			continue;
+		}
+
+		bloque[cantidad++] = dato;
+		rx->bytes_recibidos++;
+
+		if (dato == rx->delimitador)
+			fin_mensaje = true;
+	}
+
+	if (lsr & UART_LSR_ERRORES)
+		rx->errores_linea++;		//error sin datos (por ejemplo un break)
+
+	if (cantidad > 0)
+		os_StreamBufferConfirmar(&rx->stream, cantidad);
+
+	if (fin_mensaje)
+		os_StreamBufferForzarLectura(&rx->stream);
+}
+
+
+/*************************************************************************************************
+	 *  @brief Handler de las interrupciones de las UARTs con driver de recepcion.
+     *
+     *  @details
+     *   Se instala con os_InstalarIRQ en la interrupcion de cada UART inicializada con
+     *   os_UartRxInit. Atiende las interrupciones por nivel de FIFO, por timeout de caracter
+     *   y por errores de linea.
+     *
+	 *  @param 		None
+	 *  @return     None
+***************************************************************************************************/
+static void uartRx_ISR(void)  {
+	uint32_t iir;
+
+	for (uint8_t i = 0; i < OS_UART_RX_CANT; i++)  {
+		if (receptores[i] == NULL)
+			continue;
+
+		iir = Chip_UART_ReadIntIDReg(receptores[i]->uart);
+		if (iir & UART_IIR_INTSTAT_PEND)
+			continue;		//esta UART no tiene interrupciones pendientes
+
+		receptores[i]->interrupciones++;
+		recibir(receptores[i], (iir & UART_IIR_INTID_MASK) == UART_IIR_INTID_CTI);
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Inicializa el driver de recepcion de una UART.
+     *
+     *  @details
+     *   La UART debe estar configurada (baudrate, formato) antes de llamar a esta funcion.
+     *   Configura la FIFO de recepcion, habilita sus interrupciones y las instala en la
+     *   capa de interrupciones del OS, por lo que no pueden estar instaladas por el usuario.
+     *
+	 *  @param 		rx			Driver a inicializar
+	 *  @param 		uart		UART a utilizar (LPC_USARTn)
+	 *  @param 		irq			Interrupcion de la UART (USARTn_IRQn)
+	 *  @param 		memoria		Memoria para el buffer de recepcion
+	 *  @param 		tamanio		Tamaño del buffer en bytes
+	 *  @param 		umbral		Bytes recibidos que despiertan a la tarea lectora
+	 *  @return     true si el driver quedo instalado.
+***************************************************************************************************/
+bool os_UartRxInit(osUartRx* rx, LPC_USART_T* uart, LPC43XX_IRQn_Type irq, uint8_t* memoria,
+		uint16_t tamanio, uint16_t umbral)  {
+	uint8_t libre = OS_UART_RX_CANT;
+
+	os_StreamBufferInit(&rx->stream, memoria, tamanio, umbral);
+	rx->uart = uart;
+	rx->delimitador = OS_UART_SIN_DELIMITADOR;
+	rx->bytes_recibidos = 0;
+	rx->bytes_perdidos = 0;
+	rx->errores_linea = 0;
+	rx->interrupciones = 0;
+
+	for (uint8_t i = 0; i < OS_UART_RX_CANT; i++)  {
+		if (receptores[i] == NULL && libre == OS_UART_RX_CANT)
+			libre = i;
+	}
+
+	if (libre == OS_UART_RX_CANT || !os_InstalarIRQ(irq, uartRx_ISR))
+		return false;
+
+	receptores[libre] = rx;
+
+	Chip_UART_SetupFIFOS(uart, OS_UART_FCR | UART_FCR_RX_RS);
+	Chip_UART_IntEnable(uart, UART_IER_RBRINT | UART_IER_RLSINT);
+
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Configura el delimitador de mensajes de la recepcion.
+     *
+	 *  @param 		rx				Driver de recepcion
+	 *  @param 		delimitador		Byte que despierta a la lectora al recibirse (por ejemplo
+	 *  							'\n'), u OS_UART_SIN_DELIMITADOR
+	 *  @return     None
+***************************************************************************************************/
+void os_UartRxSetDelimitador(osUartRx* rx, int16_t delimitador)  {
+	rx->delimitador = delimitador;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Lee los datos recibidos por la UART.
+     *
+     *  @details
+     *   Bloquea a la tarea hasta que haya umbral bytes (o maximo, si es menor), llegue el
+     *   delimitador o la linea quede inactiva, y devuelve todos los bytes disponibles hasta
+     *   maximo.
+     *
+	 *  @param 		rx			Driver de recepcion
+	 *  @param 		destino		Donde copiar los datos
+	 *  @param 		maximo		Cantidad maxima de bytes a leer
+	 *  @return     Bytes leidos.
+***************************************************************************************************/
+uint16_t os_UartRxRead(osUartRx* rx, void* destino, uint16_t maximo)  {
+	return os_StreamBufferRead(&rx->stream, destino, maximo);
+}
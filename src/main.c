@@ -5,6 +5,8 @@
 #include "board.h"
 #include "MSE_OS_Core.h"
 #include "MSE_OS_API.h"
+#include "MSE_OS_Tabla.h"
+#include "MSE_OS_Uart.h"
 #include "sapi.h"
 
 
@@ -12,24 +14,22 @@
 
 #define MILISEC		1000
 
-#define PRIORIDAD_0		0
-#define PRIORIDAD_1		1
-#define PRIORIDAD_3		3
-
 #define TEC1_PORT_NUM   0
 #define TEC1_BIT_VAL    4
 
 #define TEC2_PORT_NUM   0
 #define TEC2_BIT_VAL    8
 
-/*==================[Global data declaration]==============================*/
+#define TAM_BUFFER_UART	128
 
-tarea g_sEncenderLed, g_sApagarLed;	//prioridad 0
-tarea g_sUart;	//prioridad 3
+/*==================[Global data declaration]==============================*/
 
-osCola colaUart;
+/*
+ * Las tareas g_sEncenderLed y g_sApagarLed y los semaforos semTecla1_descendente y
+ * semTecla1_ascendente se declaran en tareas.def
+ */
 
-osSemaforo semTecla1_descendente, semTecla1_ascendente;
+osUartTx uartUsb;
 
 typedef struct _mydata my_data;
 
@@ -40,6 +40,8 @@ void tecla1_up_ISR(void);
 
 /*==================[internal data definition]===============================*/
 
+static uint8_t bufferUartUsb[TAM_BUFFER_UART];
+
 /*==================[external data definition]===============================*/
 
 /*==================[internal functions definition]==========================*/
@@ -68,15 +70,15 @@ static void initHardware(void)  {
 	Chip_PININT_SetPinModeEdge( LPC_GPIO_PIN_INT, PININTCH( 1 ) );
 	Chip_PININT_EnableIntHigh( LPC_GPIO_PIN_INT, PININTCH( 1 ) );
 
-	/* Inicializar UART_USB a 115200 baudios */
+	/* Inicializar UART_USB a 115200 baudios, con transmision por DMA */
 	uartConfig( UART_USB, 115200 );
+	os_UartTxInit( &uartUsb, LPC_USART2, GPDMA_CONN_UART2_Tx, bufferUartUsb, TAM_BUFFER_UART );
 }
 
 
 /*==================[Definicion de tareas para el OS]==========================*/
 void encenderLed(void)  {
 	char msg[25];
-	uint8_t i;
 
 	strcpy(msg,"Se presiono la tecla 1\n\r");
 
@@ -85,17 +87,12 @@ void encenderLed(void)  {
 		os_SemaforoTake(&semTecla1_descendente);
 		gpioWrite(LED1,true);
 
-		i = 0;
-		while(msg[i] != NULL)  {
-			os_ColaWrite(&colaUart,(msg + i));
-			i++;
-		}
+		os_UartTxWrite(&uartUsb,msg,strlen(msg));
 	}
 }
 
 void apagarLed(void)  {
 	char msg[25];
-	uint8_t i;
 
 	strcpy(msg,"Se solto la tecla 1\n\r");
 
@@ -104,21 +101,7 @@ void apagarLed(void)  {
 		os_SemaforoTake(&semTecla1_ascendente);
 		gpioWrite(LED1,false);
 
-		i = 0;
-		while(msg[i] != NULL)  {
-			os_ColaWrite(&colaUart,(msg + i));
-			i++;
-		}
-	}
-}
-
-
-void uart(void)  {
-	char aux;
-
-	while(1)  {
-		os_ColaRead(&colaUart,&aux);
-		uartWriteByte(UART_USB,aux);
+		os_UartTxWrite(&uartUsb,msg,strlen(msg));
 	}
 }
 
@@ -131,13 +114,7 @@ int main(void)  {
 
 	initHardware();
 
-	os_InitTarea(encenderLed, &g_sEncenderLed,PRIORIDAD_0);
-	os_InitTarea(apagarLed, &g_sApagarLed,PRIORIDAD_0);
-	os_InitTarea(uart, &g_sUart,PRIORIDAD_3);
-
-	os_ColaInit(&colaUart,sizeof(char));
-	os_SemaforoInit(&semTecla1_ascendente);
-	os_SemaforoInit(&semTecla1_descendente);
+	os_InitTablaTareas();
 
 	os_InstalarIRQ(PIN_INT0_IRQn,tecla1_down_ISR);
 	os_InstalarIRQ(PIN_INT1_IRQn,tecla1_up_ISR);
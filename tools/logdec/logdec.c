@@ -0,0 +1,140 @@
+/*
+ * logdec.c (herramienta de host)
+ *
+ *  Decodificador del log binario diferido (MSE_OS_Log.h) para firmwares compilados con
+ *  OS_LOG_CRUDO en 1. Lee los registros crudos, palabras de 32 bits little endian tal
+ *  como las entrega la salida del log (por ejemplo capturadas de la UART), y los imprime
+ *  con los formatos de mensajes_log.def, que debe ser la misma tabla con la que se
+ *  compilo el firmware.
+ *
+ *  Compilacion y uso, desde la raiz del repositorio:
+ *
+ *    gcc -std=gnu99 -O2 -Iinc -o logdec tools/logdec/logdec.c
+ *    ./logdec captura.bin
+ *    cat /dev/ttyUSB1 | ./logdec
+ *
+ *  Si la captura empieza en medio de un registro, o se perdieron bytes, descarta
+ *  bytes de a uno hasta encontrar una cabecera valida.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define OS_LOG_HOST
+#include "MSE_OS_Log.h"
+
+
+static const char* const formatos[OS_LOG_CANT_MENSAJES] = {
+	OS_LOG_FORMATO_PERDIDOS,
+#define OS_LOG_MENSAJE(nombre, formato)		formato,
+#include "mensajes_log.def"
+};
+
+
+
+/*************************************************************************************************
+	 *  @brief Lee una palabra little endian.
+     *
+	 *  @param entrada	Archivo de entrada
+	 *  @param palabra	Destino
+	 *  @return     false al terminar la entrada.
+***************************************************************************************************/
+static bool leerPalabra(FILE *entrada, uint32_t *palabra)  {
+	uint8_t bytes[4];
+
+	if (fread(bytes, 1, sizeof(bytes), entrada) != sizeof(bytes))
+		return false;
+
+	*palabra = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Desplaza la palabra un byte, para resincronizar.
+     *
+	 *  @param entrada	Archivo de entrada
+	 *  @param palabra	Palabra a desplazar, recibe el proximo byte como el mas significativo
+	 *  @return     false al terminar la entrada.
+***************************************************************************************************/
+static bool desplazarByte(FILE *entrada, uint32_t *palabra)  {
+	int byte = fgetc(entrada);
+
+	if (byte == EOF)
+		return false;
+
+	*palabra = (*palabra >> 8) | ((uint32_t) byte << 24);
+	return true;
+}
+
+
+/*************************************************************************************************
+	 *  @brief Indica si una palabra puede ser la cabecera de un registro.
+     *
+	 *  @param cabecera		Palabra leida
+	 *  @return     true si tiene el bit de registro valido, los bits reservados en 0, una
+	 *  			cantidad de argumentos admitida y un id de mensajes_log.def.
+***************************************************************************************************/
+static bool esCabecera(uint32_t cabecera)  {
+	return (cabecera & OS_LOG_VALIDO) && OS_LOG_RESERVADO(cabecera) == 0 &&
+			OS_LOG_CANT_ARGS(cabecera) <= OS_LOG_MAX_ARGS &&
+			OS_LOG_ID(cabecera) < OS_LOG_CANT_MENSAJES;
+}
+
+
+int main(int argc, char *argv[])  {
+	FILE *entrada = stdin;
+	uint32_t registro[OS_LOG_PALABRAS_CABECERA + OS_LOG_MAX_ARGS] = { 0 };
+	uint32_t *a = &registro[OS_LOG_PALABRAS_CABECERA];
+	unsigned long registros = 0;
+	unsigned long descartados = 0;
+	bool hay_datos;
+
+	if (argc > 2)  {
+		fprintf(stderr, "uso: %s [captura]\n", argv[0]);
+		return 2;
+	}
+
+	if (argc == 2)  {
+		entrada = fopen(argv[1], "rb");
+		if (entrada == NULL)  {
+			perror(argv[1]);
+			return 2;
+		}
+	}
+
+	hay_datos = leerPalabra(entrada, &registro[0]);
+
+	while (hay_datos)  {
+		uint32_t cant = OS_LOG_CANT_ARGS(registro[0]);
+		bool completo = true;
+
+		if (!esCabecera(registro[0]))  {
+			descartados++;
+			hay_datos = desplazarByte(entrada, &registro[0]);
+			continue;
+		}
+
+		for (uint32_t i = 1; i < OS_LOG_PALABRAS_CABECERA + cant && completo; i++)
+			completo = leerPalabra(entrada, &registro[i]);
+
+		if (!completo)
+			break;
+
+		for (uint32_t i = cant; i < OS_LOG_MAX_ARGS; i++)
+			a[i] = 0;
+
+		printf("%u: ", registro[1]);
+		printf(formatos[OS_LOG_ID(registro[0])], a[0], a[1], a[2], a[3]);
+		printf("\n");
+		registros++;
+
+		hay_datos = leerPalabra(entrada, &registro[0]);
+	}
+
+	if (descartados > 0)
+		fprintf(stderr, "%lu registros, %lu bytes descartados\n", registros, descartados);
+
+	return 0;
+}
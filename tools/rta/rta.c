@@ -0,0 +1,209 @@
+/*
+ * rta.c (herramienta de host)
+ *
+ *  Analisis de tiempo de respuesta (RTA) de la tabla de tareas de tareas.def para el
+ *  scheduler de prioridades fijas del OS. Para cada tarea i se itera
+ *
+ *    R = C_i + sum_j ceil(R / T_j) * C_j
+ *
+ *  sobre las tareas j de mayor prioridad y las de igual prioridad, ya que el round-robin
+ *  puede hacer que cualquiera de ellas corra antes que i. La tarea cumple si R converge
+ *  a un valor menor o igual a su deadline. El costo del SysTick y de los cambios de
+ *  contexto se debe incluir en los WCET.
+ *
+ *  Compilacion y uso, desde la raiz del repositorio:
+ *
+ *    gcc -std=gnu99 -O2 -Iinc -o rta tools/rta/rta.c
+ *    ./rta inc/tareas_rta.h
+ *
+ *  Imprime el analisis y escribe el header que usa MSE_OS_Tabla.c: la lista de tareas
+ *  ordenada por prioridad y las estructuras del scheduler precalculadas para el
+ *  arranque, y el hash de la tabla con el que el firmware verifica que la configuracion
+ *  es la analizada. Termina con codigo 1 si el conjunto no es planificable.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#define OS_TABLA_HOST
+#include "MSE_OS_Tabla.h"
+
+
+struct _entradaRTA  {
+	const char *nombre;
+	uint8_t prioridad;
+	uint32_t periodo_us;
+	uint32_t wcet_us;
+	uint32_t deadline_us;
+	uint64_t respuesta_us;
+	bool cumple;
+};
+typedef struct _entradaRTA entradaRTA;
+
+static entradaRTA tabla[] = {
+#define OS_TAREA(nombre, entry, prioridad, periodo_us, wcet_us, deadline_us)	\
+	{ #nombre, prioridad, periodo_us, wcet_us, deadline_us, 0, false },
+#include "tareas.def"
+};
+
+#define CANT_TAREAS		(sizeof(tabla) / sizeof(tabla[0]))
+
+
+
+/*************************************************************************************************
+	 *  @brief Calcula el tiempo de respuesta de peor caso de una tarea.
+     *
+	 *  @param i	Indice de la tarea en la tabla
+	 *  @return     true si la iteracion converge antes de superar el deadline.
+***************************************************************************************************/
+static bool analizarTarea(uint32_t i)  {
+	entradaRTA *t = &tabla[i];
+	uint64_t r = t->wcet_us;
+	uint64_t siguiente;
+
+	while (1)  {
+		siguiente = t->wcet_us;
+
+		for (uint32_t j = 0; j < CANT_TAREAS; j++)  {
+			if (j != i && tabla[j].prioridad <= t->prioridad)
+				siguiente += ((r + tabla[j].periodo_us - 1) / tabla[j].periodo_us) * tabla[j].wcet_us;
+		}
+
+		if (siguiente > t->deadline_us)  {
+			t->respuesta_us = siguiente;
+			return false;
+		}
+
+		if (siguiente == r)  {
+			t->respuesta_us = r;
+			return true;
+		}
+
+		r = siguiente;
+	}
+}
+
+
+/*************************************************************************************************
+	 *  @brief Escribe las estructuras del scheduler precalculadas.
+     *
+     *  @details
+     *   Equivalen a crear las tareas en el orden de la tabla con os_InitTarea: la lista
+     *   queda ordenada por prioridad y, dentro de cada prioridad, en el orden de la tabla.
+     *
+	 *  @param salida	Archivo de salida
+	 *  @return     None.
+***************************************************************************************************/
+static void escribirArranque(FILE *salida)  {
+	uint16_t cantidad[OS_MAX_PRIORIDADES] = { 0 };
+	uint16_t inicio = 0;
+	uint32_t prioridades = 0;
+	uint8_t prioridadMax = 0;
+	const char *separador = "";
+
+	for (uint32_t i = 0; i < CANT_TAREAS; i++)  {
+		cantidad[tabla[i].prioridad]++;
+		prioridades |= 1UL << tabla[i].prioridad;
+
+		if (tabla[i].prioridad > prioridadMax)
+			prioridadMax = tabla[i].prioridad;
+	}
+
+	fprintf(salida, "#define OS_TABLA_CANT_TAREAS\t%u\n", (unsigned) CANT_TAREAS);
+	fprintf(salida, "#define OS_TABLA_PRIORIDAD_MAX\t%u\n", prioridadMax);
+	fprintf(salida, "#define OS_TABLA_PRIORIDADES\t0x%08XUL\n\n", prioridades);
+
+	fprintf(salida, "#define OS_TABLA_LISTA\t{");
+	for (uint32_t p = 0; p < OS_MAX_PRIORIDADES; p++)  {
+		for (uint32_t i = 0; i < CANT_TAREAS; i++)  {
+			if (tabla[i].prioridad == p)  {
+				fprintf(salida, "%s &g_s%s", separador, tabla[i].nombre);
+				separador = ",";
+			}
+		}
+	}
+	fprintf(salida, " }\n");
+
+	fprintf(salida, "#define OS_TABLA_CANT_PRIORIDAD\t{");
+	for (uint32_t p = 0; p < OS_MAX_PRIORIDADES; p++)
+		fprintf(salida, "%s %u", p ? "," : "", cantidad[p]);
+	fprintf(salida, " }\n");
+
+	fprintf(salida, "#define OS_TABLA_INICIO_PRIORIDAD\t{");
+	for (uint32_t p = 0; p < OS_MAX_PRIORIDADES; p++)  {
+		fprintf(salida, "%s %u", p ? "," : "", inicio);
+		inicio += cantidad[p];
+	}
+	fprintf(salida, " }\n\n");
+}
+
+
+int main(int argc, char *argv[])  {
+	uint32_t hash = OS_TABLA_HASH_INICIAL;
+	bool planificable = true;
+	double utilizacion = 0;
+	FILE *salida;
+
+	if (argc != 2)  {
+		fprintf(stderr, "uso: %s <tareas_rta.h>\n", argv[0]);
+		return 2;
+	}
+
+	hash = os_TablaHash(hash, OS_US_POR_TICK);
+	hash = os_TablaHash(hash, CANT_TAREAS);
+
+	printf("%-16s %4s %10s %10s %10s %10s  %s\n",
+			"tarea", "prio", "T(us)", "C(us)", "D(us)", "R(us)", "");
+
+	for (uint32_t i = 0; i < CANT_TAREAS; i++)  {
+		entradaRTA *t = &tabla[i];
+
+		if (t->periodo_us == 0 || t->wcet_us == 0 || t->deadline_us == 0)  {
+			fprintf(stderr, "%s: periodo, wcet y deadline deben ser mayores a cero\n", t->nombre);
+			return 2;
+		}
+
+		if (t->prioridad >= OS_MAX_PRIORIDADES)  {
+			fprintf(stderr, "%s: prioridad fuera de rango\n", t->nombre);
+			return 2;
+		}
+
+		t->cumple = analizarTarea(i);
+		planificable = planificable && t->cumple;
+		utilizacion += (double) t->wcet_us / t->periodo_us;
+
+		hash = os_TablaHash(hash, t->prioridad);
+		hash = os_TablaHash(hash, t->periodo_us);
+		hash = os_TablaHash(hash, t->wcet_us);
+		hash = os_TablaHash(hash, t->deadline_us);
+
+		printf("%-16s %4u %10u %10u %10u %10llu  %s\n", t->nombre, t->prioridad, t->periodo_us,
+				t->wcet_us, t->deadline_us, (unsigned long long) t->respuesta_us,
+				t->cumple ? "ok" : "NO CUMPLE");
+	}
+
+	printf("utilizacion: %.3f\n%s\n", utilizacion,
+			planificable ? "planificable" : "NO planificable");
+
+	salida = fopen(argv[1], "w");
+	if (salida == NULL)  {
+		perror(argv[1]);
+		return 2;
+	}
+
+	fprintf(salida, "/*\n * tareas_rta.h\n *\n *  Generado por tools/rta a partir de tareas.def."
+			" No editar.\n *\n");
+	for (uint32_t i = 0; i < CANT_TAREAS; i++)
+		fprintf(salida, " *  %-16s R = %llu us%s\n", tabla[i].nombre,
+				(unsigned long long) tabla[i].respuesta_us,
+				tabla[i].cumple ? "" : " (supera el deadline)");
+	fprintf(salida, " */\n\n#ifndef MSE_OS_INC_TAREAS_RTA_H_\n#define MSE_OS_INC_TAREAS_RTA_H_\n\n");
+	fprintf(salida, "#define OS_TABLA_HASH\t\t\t0x%08XUL\n", hash);
+	fprintf(salida, "#define OS_TABLA_PLANIFICABLE\t%d\n\n", planificable ? 1 : 0);
+	escribirArranque(salida);
+	fprintf(salida, "#endif /* MSE_OS_INC_TAREAS_RTA_H_ */\n");
+	fclose(salida);
+
+	return planificable ? 0 : 1;
+}